@@ -0,0 +1,234 @@
+/* compilebench.c - compile throughput over synthetic scaled programs
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=compilebench [dimension [maxsize]]
+ *
+ * For every dimension a program is generated at doubling sizes while the
+ * other dimensions stay small. Each size is measured in its own process
+ * so that the peak RSS belongs to that size only. The growth column is
+ * the time ratio to the previous size divided by the token ratio: about
+ * 1.0 is linear, 2.0 means the cost is quadratic in that dimension.
+ *
+ * gram.y generates code in its semantic actions, so parsing and code
+ * generation are one pass and are reported together as 'parse+gen', at
+ * -O0. The optimizer is timed on its own, on a copy of that code, as
+ * 'opt ms', and the code size is given before and after it. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "myl.h"
+#include "element.h"
+#include "arena.h"
+#include "memio.h"
+#include "vmachine.h"
+#include "ir.h"
+#include "genprog.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+#define UNROLL 4			/* the default of myl */
+
+typedef struct Result {
+	int lines;
+	long tokens;
+	int codesize;
+	int optsize;
+	double lextime;			/* seconds per pass */
+	double compiletime;
+	double opttime;
+	long maxrss;			/* KB */
+} Result;
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long LexOnce(const Buffer *buf)
+{
+	InputStream *stream = CreateMemStream(buf->data, buf->len);
+	Arena *arena = CreateArena(65536);
+	ElementParser *parser = CreateElementParser(stream, arena);
+	Element elem;
+	long tokens = 0;
+
+	while (GetElement(parser, &elem) != EOF) {
+		tokens++;
+	}
+	CloseElementParser(parser);
+	CloseArena(arena);
+	CloseMemStream(stream);
+	return tokens;
+}
+
+static Instruction Code[CODESIZE];
+
+/* At -O0, the code the parser generated */
+static int CompileOnce(const Buffer *buf)
+{
+	InputStream *stream = CreateMemStream(buf->data, buf->len);
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetOptLevel(parser, 0);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+/* Optimize a copy of the code as Compile does at -O1 */
+static int OptimizeOnce(int size)
+{
+	Arena *arena = CreateArena(65536);
+
+	memcpy(VMCode, Code, size * sizeof(Instruction));
+	size = OptimizeCode(arena, VMCode, size, 1, UNROLL, NULL);
+	CloseArena(arena);
+	return size;
+}
+
+static void Measure(const Dimension *dim, int size, Result *res)
+{
+	Buffer buf;
+	struct rusage usage;
+	double start;
+	int passes;
+
+	InitBuffer(&buf);
+	dim->gen(&buf, size);
+	res->lines = buf.lines;
+
+	start = Now();
+	passes = 0;
+	do {
+		res->tokens = LexOnce(&buf);
+		passes++;
+	} while (Now() - start < MINTIME);
+	res->lextime = (Now() - start) / passes;
+
+	start = Now();
+	passes = 0;
+	do {
+		res->codesize = CompileOnce(&buf);
+		passes++;
+	} while (Now() - start < MINTIME);
+	res->compiletime = (Now() - start) / passes;
+
+	memcpy(Code, VMCode, res->codesize * sizeof(Instruction));
+	start = Now();
+	passes = 0;
+	do {
+		res->optsize = OptimizeOnce(res->codesize);
+		passes++;
+	} while (Now() - start < MINTIME);
+	res->opttime = (Now() - start) / passes;
+
+	getrusage(RUSAGE_SELF, &usage);
+	res->maxrss = usage.ru_maxrss;
+	FreeBuffer(&buf);
+}
+
+static int MeasureInChild(const Dimension *dim, int size, Result *res)
+{
+	int fds[2], status;
+	pid_t pid;
+
+	if (pipe(fds)) return 0;
+	fflush(stdout);
+	pid = fork();
+	if (pid < 0) return 0;
+	if (pid == 0) {
+		close(fds[0]);
+		/* Compile errors and VM errors print on stdout */
+		Measure(dim, size, res);
+		if (write(fds[1], res, sizeof(*res)) != sizeof(*res)) _exit(1);
+		_exit(0);
+	}
+	close(fds[1]);
+	status = read(fds[0], res, sizeof(*res)) == sizeof(*res);
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+	return status;
+}
+
+static void RunDimension(const Dimension *dim, int max)
+{
+	Result res, prev;
+	int size, first = 1;
+
+	printf("\n[%s]\n", dim->name);
+	printf("%7s %7s %8s %8s %10s %8s %9s %9s %7s %7s %9s %6s\n",
+		"size", "lines", "tokens", "lex ms", "parse+gen", "opt ms", "Mtok/s",
+		"Klines/s", "code", "opt", "peak KB", "growth");
+	for (size = dim->start; size <= max; size *= 2) {
+		double total, growth = 0;
+
+		if (!MeasureInChild(dim, size, &res)) {
+			printf("%7d failed\n", size);
+			break;
+		}
+		total = res.lextime + res.compiletime;
+		if (!first) {
+			double prevtotal = prev.lextime + prev.compiletime;
+			growth = (total / prevtotal) / ((double)res.tokens / prev.tokens);
+		}
+		printf("%7d %7d %8ld %8.2f %10.2f %8.2f %9.2f %9.1f %7d %7d %9ld ",
+			size, res.lines, res.tokens, res.lextime * 1e3,
+			(res.compiletime - res.lextime) * 1e3, res.opttime * 1e3,
+			res.tokens / res.compiletime / 1e6,
+			res.lines / res.compiletime / 1e3,
+			res.codesize, res.optsize, res.maxrss);
+		if (first) printf("%6s\n", "-");
+		else printf("%6.2f%s\n", growth, growth > 1.5 ? " superlinear" : "");
+		prev = res;
+		first = 0;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int i, found = 0;
+
+	for (i = 0; i < DimensionCount; i++) {
+		const Dimension *dim = &Dimensions[i];
+
+		if (argc > 1 && strcmp(argv[1], dim->name)) continue;
+		RunDimension(dim, argc > 2 ? atoi(argv[2]) : dim->max);
+		found = 1;
+	}
+	if (!found) {
+		printf("usage::=compilebench [vars|literals|depth|cases|labels|lines [maxsize]]\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+/* csvbench.cpp - A column of a CSV file summed by csvagg, MYL and awk
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=csvbench [megabytes]
+ *
+ * A CSV file of 1024 MB if no size is given is written to a temporary
+ * file, with a header and the columns id, time, host, latency and bytes.
+ * The latency is summed by csvagg, then its min, max, mean and count are
+ * taken from the same scan, and the bytes are summed by another scan.
+ * The same sum is run as a MYL loop on readline, split and number, and
+ * by awk. The time of each and the MB scanned per second are printed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+static FILE *out;
+static double MBytes;
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void WriteCSV(const char *path, long size)
+{
+	FILE *fp = fopen(path, "w");
+	long written;
+	int i;
+
+	if (!fp) {
+		fprintf(stderr, "Can't write %s.\n", path);
+		exit(1);
+	}
+	written = fprintf(fp, "id,time,host,latency,bytes\n");
+	for (i = 0; written < size; i++) {
+		written += fprintf(fp, "%d,%d,host%d,%d.%03d,%d\n", i, 1569900000 + i / 10,
+			i % 16, i % 250, i * 7 % 1000, i * 37 % 65536);
+	}
+	fclose(fp);
+}
+
+static void Report(const char *name, double t, double mbytes)
+{
+	fprintf(out, "%-22s %10.3f %10.1f\n", name, t, mbytes / t);
+}
+
+/* Runs the program once, returns its time */
+static double RunProgram(const char *text)
+{
+	InputStream *stream = CreateMemStream(text, strlen(text));
+	MYLParser *parser = CreateMYLParser(stream);
+	double start;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	start = Now();
+	Run(0);
+	return Now() - start;
+}
+
+static void BenchMYL(const char *name, const char *format, const char *path, double mbytes)
+{
+	char text[1024];
+
+	snprintf(text, sizeof(text), format, path);
+	Report(name, RunProgram(text), mbytes);
+}
+
+int main(int argc, char *argv[])
+{
+	char path[] = "/tmp/csvbenchXXXXXX", command[256], result[64];
+	int megabytes = argc > 1 ? atoi(argv[1]) : 1024;
+	double start;
+	int fd;
+
+	if (megabytes <= 0) {
+		fprintf(stderr, "usage::=csvbench [megabytes]\n");
+		return 1;
+	}
+	if ((fd = mkstemp(path)) < 0) {
+		fprintf(stderr, "Can't create %s.\n", path);
+		return 1;
+	}
+	close(fd);
+	WriteCSV(path, megabytes * 1048576L);
+	MBytes = megabytes;
+	/* The programs print to stdout, the results go to a copy of it */
+	out = fdopen(dup(1), "w");
+	if (!out || !freopen("/dev/null", "w", stdout)) {
+		fprintf(stderr, "Can't redirect the output.\n");
+		return 1;
+	}
+	fprintf(out, "%-22s %10s %10s\n", "sum of a column", "s", "MB/s");
+	BenchMYL("csvagg latency", "print(csvagg(\"%s\", 3, \"sum\"));\n", path, MBytes);
+	BenchMYL("min max mean count", "string p;\np = \"%s\";\n"
+		"print(csvagg(p, 3, \"min\"), csvagg(p, 3, \"max\"), csvagg(p, 3, \"mean\"),"
+		" csvcount(p, 3));\n", path, MBytes);
+	BenchMYL("csvagg bytes", "print(csvagg(\"%s\", 4, \"sum\"));\n", path, MBytes);
+	BenchMYL("myl loop latency",
+		"integer f;\n"
+		"float sum;\n"
+		"f = open(\"%s\", \"r\");\n"
+		"readline(f);\n"
+		"sum = 0;\n"
+		"while (eof(f) == 0) sum = sum + number(split(readline(f), \",\", 3));\n"
+		"close(f);\n"
+		"print(sum);\n", path, MBytes);
+	snprintf(result, sizeof(result), "%s.sum", path);
+	snprintf(command, sizeof(command), "awk -F, '{ s += $4 } END { print s }' %s > %s",
+		path, result);
+	start = Now();
+	if (system(command)) fprintf(out, "%-22s %10s\n", "awk latency", "failed");
+	else Report("awk latency", Now() - start, MBytes);
+	unlink(path);
+	unlink(result);
+	fclose(out);
+	return 0;
+}
@@ -0,0 +1,136 @@
+/* extbench.cpp - Builtins of an extension against dos and MYL code
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=extbench [extension]
+ *
+ * The extension, ./bench/extsample.so if none is given, is loaded and
+ * its mix() is called in a loop, against the same step as a MYL function,
+ * inline, and against dos() running true, which forks a shell for each
+ * call. The instructions dispatched and the time of a call are printed.
+ * The programs end with srandom() of their result, which keeps the work
+ * from being removed without printing anything. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+
+typedef struct Program {
+	const char *name;
+	const char *text;
+	long calls;
+} Program;
+
+static const Program Programs[] = {
+	{"native",
+		"integer i, s;\n"
+		"s = 0;\n"
+		"for (i = 0; i < 100000; i++) s = mix(s, i);\n"
+		"srandom(s);\n",
+		100000},
+	{"function",
+		"integer mixf(integer s, integer i) return (s * 31 + i) % 1000003;\n"
+		"integer i, s;\n"
+		"s = 0;\n"
+		"for (i = 0; i < 100000; i++) s = mixf(s, i);\n"
+		"srandom(s);\n",
+		100000},
+	{"inline",
+		"integer i, s;\n"
+		"s = 0;\n"
+		"for (i = 0; i < 100000; i++) s = (s * 31 + i) % 1000003;\n"
+		"srandom(s);\n",
+		100000},
+	{"dos",
+		"integer i, s;\n"
+		"s = 0;\n"
+		"for (i = 0; i < 20; i++) s = s + dos(\"true\");\n"
+		"srandom(s);\n",
+		20},
+};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileProgram(const Program *prog)
+{
+	InputStream *stream = CreateMemStream(prog->text, strlen(prog->text));
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main(int argc, char *argv[])
+{
+	int i;
+
+	if (!LoadExtension(argc > 1 ? argv[1] : "./bench/extsample.so")) return 1;
+	printf("%-8s %6s %10s %12s\n", "program", "code", "dispatches", "ns/call");
+	for (i = 0; i < (int)(sizeof(Programs) / sizeof(Program)); i++) {
+		int size = CompileProgram(&Programs[i]);
+		long n = Dispatches();
+		double t = TimeRun();
+
+		printf("%-8s %6d %10ld %12.1f\n", Programs[i].name, size, n,
+			t * 1e9 / Programs[i].calls);
+	}
+	return 0;
+}
@@ -0,0 +1,83 @@
+/* extsample.c - A native extension, loaded by extbench and myl --load
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Build with
+ *	gcc -shared -fPIC -I./src -o extsample.so extsample.c
+ * and run a program calling its builtins with myl --load=./extsample.so */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mylext.h"
+
+/* mix(s, i): a step of a hash, (s*31+i)%1000003 */
+static const char *Mix(const MYLExtValue *params, int paramcnt, MYLExtValue *ret)
+{
+	if (params[0].type != MYLEXT_INTEGER || params[1].type != MYLEXT_INTEGER)
+		return "mix takes integers";
+	ret->u.i = (int)(((long long)params[0].u.i * 31 + params[1].u.i) % 1000003);
+	return 0;
+}
+
+/* reverse(s): the string reversed, in a buffer kept until the next call */
+static const char *Reverse(const MYLExtValue *params, int paramcnt, MYLExtValue *ret)
+{
+	static char *buf;
+	static size_t size;
+	size_t n, k;
+
+	if (params[0].type != MYLEXT_STRING) return "reverse takes a string";
+	n = strlen(params[0].u.s);
+	if (n + 1 > size) {
+		free(buf);
+		if (!(buf = (char *)malloc(n + 1))) {
+			size = 0;
+			return "Out of memory";
+		}
+		size = n + 1;
+	}
+	for (k = 0; k < n; k++) buf[k] = params[0].u.s[n - 1 - k];
+	buf[n] = 0;
+	ret->u.s = buf;
+	return 0;
+}
+
+/* fsum(...): the sum of any number of numbers */
+static const char *Fsum(const MYLExtValue *params, int paramcnt, MYLExtValue *ret)
+{
+	float sum = 0;
+	int k;
+
+	for (k = 0; k < paramcnt; k++) {
+		if (params[k].type == MYLEXT_INTEGER) sum += params[k].u.i;
+		else if (params[k].type == MYLEXT_FLOAT) sum += params[k].u.f;
+		else return "fsum takes numbers";
+	}
+	ret->u.f = sum;
+	return 0;
+}
+
+int myl_ext_init(MYLExtRegister reg)
+{
+	return reg("mix", 2, MYLEXT_INTEGER, Mix)
+		&& reg("reverse", 1, MYLEXT_STRING, Reverse)
+		&& reg("fsum", -1, MYLEXT_FLOAT, Fsum);
+}
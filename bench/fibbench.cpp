@@ -0,0 +1,141 @@
+/* fibbench.cpp - Calls of user functions against the same work inline
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=fibbench
+ *
+ * The recursive fib of 24 is compiled against a loop computing it, and a
+ * sum by a self-recursive tail call against the same loop, at -O0 and
+ * -O1. Each is run once to count the instructions dispatched and again
+ * for the time. The programs end with srandom() of their result, which
+ * keeps the work from being removed without printing anything. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+
+typedef struct Program {
+	const char *name;
+	const char *text;
+} Program;
+
+static const Program Programs[] = {
+	{"fib",
+		"integer fib(integer n)\n"
+		"{\n"
+		"	if (n < 2) return n;\n"
+		"	return fib(n - 1) + fib(n - 2);\n"
+		"}\n"
+		"srandom(fib(24));\n"},
+	{"fibloop",
+		"integer a, b, t, i;\n"
+		"a = 0;\n"
+		"b = 1;\n"
+		"for (i = 0; i < 24; i++) {\n"
+		"	t = a + b;\n"
+		"	a = b;\n"
+		"	b = t;\n"
+		"}\n"
+		"srandom(a);\n"},
+	{"sumtail",
+		"integer sum(integer n, integer s)\n"
+		"{\n"
+		"	if (n == 0) return s;\n"
+		"	return sum(n - 1, s + n);\n"
+		"}\n"
+		"srandom(sum(100000, 0));\n"},
+	{"sumloop",
+		"integer n, s;\n"
+		"s = 0;\n"
+		"for (n = 100000; n != 0; n--) s = s + n;\n"
+		"srandom(s);\n"},
+};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileProgram(const Program *prog, int optlevel)
+{
+	InputStream *stream = CreateMemStream(prog->text, strlen(prog->text));
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetOptLevel(parser, optlevel);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main()
+{
+	int i, level;
+
+	printf("%-8s %-8s %6s %10s %10s\n", "program", "options", "code",
+		"dispatches", "us/run");
+	for (i = 0; i < (int)(sizeof(Programs) / sizeof(Program)); i++) {
+		for (level = 0; level <= 1; level++) {
+			int size = CompileProgram(&Programs[i], level);
+			long n = Dispatches();
+			double t = TimeRun();
+
+			printf("%-8s -O%-6d %6d %10ld %10.2f\n", Programs[i].name,
+				level, size, n, t * 1e6);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,164 @@
+/* filebench.cpp - Lines of a file read by MYL against wc and grep
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=filebench [megabytes]
+ *
+ * A log of 64 MB if no size is given is written to a temporary file, in
+ * which a line in 97 is "ERROR disk full". The lines are counted by a
+ * MYL loop on readline against wc -l, and the error lines by comparing
+ * each line against grep -cx. The time of each and the MB read per
+ * second are printed, with the file in the page cache. The commands
+ * write to a file, grep stops at the first match when it writes to
+ * /dev/null. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.5			/* seconds spent on each measurement */
+#define ERRORLINE "ERROR disk full"
+
+static FILE *out;
+static double MBytes;
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void WriteLog(const char *path, long size)
+{
+	FILE *fp = fopen(path, "w");
+	long written = 0;
+	int i;
+
+	if (!fp) {
+		fprintf(stderr, "Can't write %s.\n", path);
+		exit(1);
+	}
+	for (i = 0; written < size; i++) {
+		if (i % 97 == 96) written += fprintf(fp, ERRORLINE "\n");
+		else written += fprintf(fp, "2019-09-%02d 12:%02d:%02d host%d INFO request %d done in %d ms\n",
+			i % 30 + 1, i / 60 % 60, i % 60, i % 16, i, i % 1000);
+	}
+	fclose(fp);
+}
+
+static void CompileProgram(const char *text)
+{
+	InputStream *stream = CreateMemStream(text, strlen(text));
+	MYLParser *parser = CreateMYLParser(stream);
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+}
+
+static void Report(const char *name, double t)
+{
+	fprintf(out, "%-12s %10.1f %10.1f\n", name, t * 1e3, MBytes / t);
+}
+
+static void BenchMYL(const char *name, const char *loop, const char *path)
+{
+	char text[512];
+	double start;
+	int runs = 0;
+
+	snprintf(text, sizeof(text),
+		"integer f, n;\n"
+		"f = open(\"%s\", \"r\");\n"
+		"n = 0;\n"
+		"while (eof(f) == 0) %s\n"
+		"close(f);\n"
+		"print(n);\n", path, loop);
+	CompileProgram(text);
+	start = Now();
+	do {
+		Run(0);
+		runs++;
+	} while (Now() - start < MINTIME);
+	Report(name, (Now() - start) / runs);
+}
+
+static void BenchCommand(const char *name, const char *command)
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		if (system(command)) {
+			fprintf(stderr, "%s failed.\n", command);
+			exit(1);
+		}
+		runs++;
+	} while (Now() - start < MINTIME);
+	Report(name, (Now() - start) / runs);
+}
+
+int main(int argc, char *argv[])
+{
+	char path[] = "/tmp/filebenchXXXXXX", command[256], result[64];
+	int megabytes = argc > 1 ? atoi(argv[1]) : 64;
+	int fd;
+
+	if (megabytes <= 0) {
+		fprintf(stderr, "usage::=filebench [megabytes]\n");
+		return 1;
+	}
+	if ((fd = mkstemp(path)) < 0) {
+		fprintf(stderr, "Can't create %s.\n", path);
+		return 1;
+	}
+	close(fd);
+	WriteLog(path, megabytes * 1048576L);
+	MBytes = megabytes;
+	/* The programs print to stdout, the results go to a copy of it */
+	out = fdopen(dup(1), "w");
+	if (!out || !freopen("/dev/null", "w", stdout)) {
+		fprintf(stderr, "Can't redirect the output.\n");
+		return 1;
+	}
+	fprintf(out, "%-12s %10s %10s\n", "count", "ms", "MB/s");
+	snprintf(result, sizeof(result), "%s.count", path);
+	snprintf(command, sizeof(command), "wc -l < %s > %s", path, result);
+	BenchCommand("wc -l", command);
+	BenchMYL("myl lines", "{ readline(f); n++; }", path);
+	snprintf(command, sizeof(command), "grep -cx '" ERRORLINE "' %s > %s", path, result);
+	BenchCommand("grep -cx", command);
+	BenchMYL("myl errors", "if (readline(f) == \"" ERRORLINE "\") n++;", path);
+	unlink(path);
+	unlink(result);
+	fclose(out);
+	return 0;
+}
@@ -0,0 +1,202 @@
+/* genprog.c - synthetic MYL programs for the benchmarks
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "genprog.h"
+
+void InitBuffer(Buffer *buf)
+{
+	buf->len = buf->lines = 0;
+	buf->size = 65536;
+	buf->data = (char *)malloc(buf->size);
+	if (!buf->data) {
+		fprintf(stderr, "Out of memory\n");
+		exit(4);
+	}
+}
+
+void FreeBuffer(Buffer *buf)
+{
+	free(buf->data);
+	buf->data = NULL;
+}
+
+void Emit(Buffer *buf, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+
+	for (;;) {
+		va_start(ap, fmt);
+		n = vsnprintf(buf->data + buf->len, buf->size - buf->len, fmt, ap);
+		va_end(ap);
+		if (n < buf->size - buf->len) break;
+		buf->size = buf->size * 2 + n;
+		buf->data = (char *)realloc(buf->data, buf->size);
+		if (!buf->data) {
+			fprintf(stderr, "Out of memory\n");
+			exit(4);
+		}
+	}
+	for (; n > 0; n--) {
+		if (buf->data[buf->len++] == '\n') buf->lines++;
+	}
+}
+
+static void Preamble(Buffer *buf)
+{
+	Emit(buf, "integer x, y, z;\nfloat f;\nstring s;\n");
+	Emit(buf, "x = 0; y = 1; z = 2; f = 0.5; s = \"\";\n");
+}
+
+/* Distinct variables, each one declared and assigned once */
+static void GenVars(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	for (i = 0; i < size; i++) {
+		Emit(buf, "%sv%d%s", i % 8 ? ", " : "integer ", i,
+			i % 8 == 7 || i == size - 1 ? ";\n" : "");
+	}
+	Emit(buf, "v0 = x + y;\n");
+	for (i = 1; i < size; i++) {
+		Emit(buf, "v%d = v%d + y;\n", i, i - 1);
+	}
+}
+
+/* Distinct integer, float and string literals */
+static void GenLiterals(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	for (i = 0; i < size; i++) {
+		switch (i % 3) {
+		case 0:
+			Emit(buf, "x = y + %d;\n", 1000 + i);
+			break;
+		case 1:
+			Emit(buf, "f = f * %d.25;\n", i);
+			break;
+		default:
+			Emit(buf, "s = \"literal %d\";\n", i);
+			break;
+		}
+	}
+}
+
+/* Nested if/while/for blocks */
+static void GenDepth(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	for (i = 0; i < size; i++) {
+		switch (i % 3) {
+		case 0:
+			Emit(buf, "if (x < %d) {\n", i);
+			break;
+		case 1:
+			Emit(buf, "while (y > %d) {\n", i);
+			break;
+		default:
+			Emit(buf, "for (z = 0; z < %d; z++) {\n", i);
+			break;
+		}
+		Emit(buf, "x = x + y;\n");
+	}
+	for (i = 0; i < size; i++) {
+		Emit(buf, "}\n");
+	}
+}
+
+/* One switch with many cases */
+static void GenCases(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	Emit(buf, "switch (x) {\n");
+	for (i = 0; i < size; i++) {
+		Emit(buf, "case %d:\n\ty = y + z;\n\tbreak;\n", i);
+	}
+	Emit(buf, "default:\n\ty = 0;\n}\n");
+}
+
+/* Labels with backward and forward gotos */
+static void GenLabels(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	for (i = 0; i < size; i++) {
+		if (i % 2) {
+			Emit(buf, "goto F%d;\nx = x - 1;\nF%d: y = y + 1;\n", i, i);
+		} else {
+			Emit(buf, "B%d: x = x + y;\nif (x < %d) goto B%d;\n", i, i, i);
+		}
+	}
+}
+
+/* Typical mixed statements over a fixed set of variables */
+static void GenLines(Buffer *buf, int size)
+{
+	int i;
+
+	Preamble(buf);
+	Emit(buf, "integer a, b, c, d, i, j;\n");
+	for (i = 0; buf->lines < size; i++) {
+		switch (i % 6) {
+		case 0:
+			Emit(buf, "a = b * %d + c %% 7 - d;\n", i % 50);
+			break;
+		case 1:
+			Emit(buf, "if (a > b && c != 0 || d <= %d) b = b + 1;\nelse c = c - 1;\n", i % 40);
+			break;
+		case 2:
+			Emit(buf, "for (i = 0; i < 10; i++) {\n\tj = j + i * 2;\n}\n");
+			break;
+		case 3:
+			Emit(buf, "while (j > 100) j = j / 2;\n");
+			break;
+		case 4:
+			Emit(buf, "f = sqrt(f * 2.0) + a;\n");
+			break;
+		default:
+			Emit(buf, "x = a < b ? a : b;\ny = x << 2 | z & 3;\n");
+			break;
+		}
+	}
+}
+
+const Dimension Dimensions[] = {
+	{"vars", GenVars, 500, 16000},
+	{"literals", GenLiterals, 500, 16000},
+	{"depth", GenDepth, 25, 800},
+	{"cases", GenCases, 250, 8000},
+	{"labels", GenLabels, 250, 8000},
+	{"lines", GenLines, 1000, 16000},
+};
+
+const int DimensionCount = sizeof(Dimensions) / sizeof(Dimensions[0]);
@@ -0,0 +1,55 @@
+/* genprog.h - synthetic MYL programs for the benchmarks
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GENPROG_H
+#define __GENPROG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Buffer {
+	char *data;
+	int len, size;
+	int lines;
+} Buffer;
+
+typedef void (*Generator)(Buffer *buf, int size);
+
+/* A program that grows in one dimension with size */
+typedef struct Dimension {
+	const char *name;
+	Generator gen;
+	int start, max;
+} Dimension;
+
+extern const Dimension Dimensions[];
+extern const int DimensionCount;
+
+void InitBuffer(Buffer *buf);
+void FreeBuffer(Buffer *buf);
+void Emit(Buffer *buf, const char *fmt, ...)
+	__attribute__((format(printf, 2, 3)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+/* lexbench.c - tokens-per-second benchmark of the lexis analyzer
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=lexbench [infile]
+ * Without an input file a synthetic program mixing keywords, operators,
+ * numbers, strings and comments is lexed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "element.h"
+#include "memio.h"
+
+static const char *Snippet =
+	"integer i, j, count;\n"
+	"float ratio;\n"
+	"/* a comment that the lexer must skip */\n"
+	"for (i = 0; i <= 100; i++) {\n"
+	"\tfor (j = 2; j < i; j++) {\n"
+	"\t\tif (i % j == 0 && j != 1 || !count) break;\n"
+	"\t}\n"
+	"\tcount += i << 2 >> 1; ratio = 3.25e1 * .5 - count / 7;\n"
+	"\tswitch (i) { case 1: print(\"one\\n\"); break; default: continue; }\n"
+	"}\n"
+	"while (count-- > 0) ratio *= 1.0001;\n";
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *LoadFile(const char *name, int *len)
+{
+	FILE *fp = fopen(name, "rb");
+	char *buf;
+	long size;
+
+	if (!fp) {
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = (char *)malloc(size + 1);
+	if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+		fclose(fp);
+		free(buf);
+		return NULL;
+	}
+	fclose(fp);
+	*len = (int)size;
+	return buf;
+}
+
+static char *MakeSynthetic(int copies, int *len)
+{
+	int n = strlen(Snippet);
+	char *buf = (char *)malloc(n * copies + 1);
+	int i;
+
+	for (i = 0; i < copies; i++) {
+		memcpy(buf + i * n, Snippet, n);
+	}
+	buf[n * copies] = 0;
+	*len = n * copies;
+	return buf;
+}
+
+static long LexOnce(const char *buf, int len)
+{
+	InputStream *stream = CreateMemStream(buf, len);
+	Arena *arena = CreateArena(65536);
+	ElementParser *parser = CreateElementParser(stream, arena);
+	Element elem;
+	long tokens = 0;
+
+	while (GetElement(parser, &elem) != EOF) {
+		tokens++;
+	}
+	CloseElementParser(parser);
+	CloseArena(arena);
+	CloseMemStream(stream);
+	return tokens;
+}
+
+int main(int argc, char *argv[])
+{
+	char *buf;
+	int len;
+	long tokens = 0, passes = 0;
+	double start, elapsed;
+
+	if (argc > 1) {
+		buf = LoadFile(argv[1], &len);
+		if (!buf) {
+			printf("Can't open file.\n");
+			return 2;
+		}
+	} else {
+		buf = MakeSynthetic(2000, &len);
+	}
+
+	start = Now();
+	do {
+		tokens += LexOnce(buf, len);
+		passes++;
+		elapsed = Now() - start;
+	} while (elapsed < 1.0);
+
+	printf("lex: %ld passes, %ld tokens, %.3f s\n", passes, tokens, elapsed);
+	printf("lex: %.2f Mtokens/s, %.2f MB/s\n",
+		tokens / elapsed / 1e6, (double)len * passes / elapsed / 1e6);
+	free(buf);
+	return 0;
+}
@@ -0,0 +1,172 @@
+/* loopbench.cpp - Dispatches per iteration of counted loops
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=loopbench
+ *
+ * Nested counted loops are compiled without optimization, optimized
+ * without unrolling and unrolled by 2, 4 and 8. Each is run once to count
+ * the instructions dispatched and again for the time, both are printed
+ * per iteration of the innermost loop. The programs end with srandom() of
+ * their result, which keeps the loops from being removed without
+ * printing anything. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+
+typedef struct Program {
+	const char *name;
+	const char *text;
+	long iterations;		/* of the innermost loop */
+} Program;
+
+static const Program Programs[] = {
+	{"primes",
+		"integer i, j, c;\n"
+		"c = 0;\n"
+		"for (i = 2; i <= 2000; i++) {\n"
+		"	for (j = 2; j < i; j++) {\n"
+		"		if (i % j == 0)\n"
+		"			break;\n"
+		"	}\n"
+		"	if (j == i) c++;\n"
+		"}\n"
+		"srandom(c);\n",
+		/* up to the smallest factor of every i */
+		281803},
+	{"sum",
+		"integer i, j, s;\n"
+		"s = 0;\n"
+		"for (i = 0; i < 1000; i++)\n"
+		"	for (j = 0; j < 100; j++)\n"
+		"		s = s + j;\n"
+		"srandom(s);\n",
+		100000},
+	{"nest3",
+		"integer i, j, k, t;\n"
+		"t = 0;\n"
+		"for (i = 0; i < 40; i++)\n"
+		"	for (j = 0; j < 50; j++)\n"
+		"		for (k = 0; k < 30; k++)\n"
+		"			t = t + i * j + k;\n"
+		"srandom(t);\n",
+		60000},
+	{"while",
+		"integer i, s;\n"
+		"s = 0;\n"
+		"i = 0;\n"
+		"while (i < 100000) {\n"
+		"	s = s ^ i;\n"
+		"	i++;\n"
+		"}\n"
+		"srandom(s);\n",
+		100000},
+};
+
+typedef struct Config {
+	const char *name;
+	int optlevel;
+	int unroll;
+} Config;
+
+static const Config Configs[] = {
+	{"-O0",			0, 1},
+	{"--unroll=1",	1, 1},
+	{"--unroll=2",	1, 2},
+	{"--unroll=4",	1, 4},
+	{"--unroll=8",	1, 8},
+};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileProgram(const Program *prog, const Config *config)
+{
+	InputStream *stream = CreateMemStream(prog->text, strlen(prog->text));
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetOptLevel(parser, config->optlevel);
+	SetUnroll(parser, config->unroll);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main()
+{
+	int i, j;
+
+	printf("%-8s %-12s %6s %10s %10s %10s\n", "program", "options",
+		"code", "dispatches", "per iter", "ns/iter");
+	for (i = 0; i < (int)(sizeof(Programs) / sizeof(Program)); i++) {
+		const Program *prog = &Programs[i];
+
+		for (j = 0; j < (int)(sizeof(Configs) / sizeof(Config)); j++) {
+			int size = CompileProgram(prog, &Configs[j]);
+			long n = Dispatches();
+			double t = TimeRun();
+
+			printf("%-8s %-12s %6d %10ld %10.2f %10.2f\n", prog->name,
+				Configs[j].name, size, n, (double)n / prog->iterations,
+				t * 1e9 / prog->iterations);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,342 @@
+/* parsebench.cpp - compare the bison parser with the recursive descent one
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=parsebench [infile ...]
+ *
+ * Every program is compiled by both parsers. The code and the constant
+ * memory must be the same, else the first difference is printed and the
+ * exit status is 1. Then both parsers are timed on the program. Without
+ * infiles the generated programs of compilebench are used, at the first
+ * three sizes of every dimension, then the programs of Errors must fail
+ * with the same message from both parsers and those of Outputs must
+ * print what they are expected to from both, at -O0 and -O1. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+#include "genprog.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+#define SIZES 3
+
+static Instruction Code[CODESIZE];
+
+/* Programs that don't compile */
+static const char *Errors[] = {
+	"integer a; a = foo(1);\n",
+	"integer a;\nprint(1, foo(2,\n3));\n",
+	"integer a;\ninteger a;\n",
+	"integer a;\ninteger a;",
+	"integer a;\ninteger b, a, c;\nprint(1);\n",
+	"integer f(integer x, integer x) return x;\n",
+	"integer f(integer x,\n  float x)\n return x;\n",
+	"print(b);\n",
+	"integer a; a = ;\n",
+	"string s;\ninteger c;\ns = c ? \"a\" : 1;\n",
+	/* a goto out of a function, and into one */
+	"integer f(integer n)\n{\n\tgoto out;\n\treturn n;\n}\nout: print(1);\n",
+	"integer f(integer n)\n{\n\tin: return n;\n}\ngoto in;\nprint(1);\n",
+	"integer f(integer n)\n\tif (n) goto x;\nprint(1);\n",
+	/* return out of a function, and of the wrong type */
+	"integer a;\nreturn a;\nprint(1);\n",
+	"integer f(integer n) return \"a\";\nprint(1);\n",
+	"integer f(integer n) { return \"a\"; }\n",
+	"break;\nprint(1);\n",
+	"continue;\nprint(1);\n",
+	"integer a;\nswitch (a) { default: print(1); default: print(2); }\n",
+};
+
+/* Programs and what they print */
+typedef struct Output {
+	const char *text;
+	const char *expected;
+} Output;
+
+static const Output Outputs[] = {
+	/* ?: of an integer and a float is a float */
+	{"float f; integer c; c = 0; f = c ? 2.5 : 3; print(f);\n"
+	 "c = 1; f = c ? 2.5 : 3; print(f);\n",
+	 "3.000000\n2.500000\n"},
+	{"integer c; float g; g = 1.5; c = 1;\n"
+	 "print(c ? 1 : 2.5, \" \", c ? g : 7, \" \", c ? 1 : 2);\n"
+	 "c = 0; print(c ? 1 : 2.5, \" \", c ? g : 7, \" \", c ? 1 : 2);\n",
+	 "1.000000 1.500000 1\n2.500000 7.000000 2\n"},
+	/* the labels of a function and of the program don't mix */
+	{"integer f(integer n)\n{\n\tgoto in;\n\treturn n;\n\tin: return n + 1;\n}\n"
+	 "goto in;\nprint(1);\nin: print(f(1));\n",
+	 "2\n"},
+	/* a boolean expression assigned as a value */
+	{"integer a, b, k; a = 1; b = 2; k = a && b; print(k);\n"
+	 "b = 0; k = a && b; print(k); k = a || b; print(k); k += a || b; print(k);\n",
+	 "1\n0\n1\n2\n"},
+	/* a counted loop stepping past INT_MAX */
+	{"integer i, n; n = 0;\n"
+	 "for (i = 2147483640; i < 2147483647; i += 3) { n++; if (n > 5) break; }\n"
+	 "print(n, \" \", i);\n",
+	 "6 -2147483641\n"},
+};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileOnce(const char *data, int len, int frontend)
+{
+	InputStream *stream = CreateMemStream(data, len);
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SelectParser(parser, frontend);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static double TimeCompile(const char *data, int len, int frontend)
+{
+	double start = Now();
+	int passes = 0;
+
+	do {
+		CompileOnce(data, len, frontend);
+		passes++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / passes;
+}
+
+static int SameMemory(int addr, const MemUnit *unit)
+{
+	if (VMStack[addr].tag != unit->tag) return 0;
+	switch (unit->tag) {
+	case T_INTEGER:
+		return VMMEM(addr).i == unit->mem.i;
+	case T_FLOAT:
+		return !memcmp(&VMMEM(addr).f, &unit->mem.f, sizeof(float));
+	case T_STRING:
+		return *VMMEM(addr).str == *unit->mem.str;
+	}
+	return 1;
+}
+
+/* Compile with both parsers and report the first difference */
+static int Check(const char *name, const char *data, int len)
+{
+	static MemUnit Memory[STACKSIZE];
+	int i, size, rdsize;
+
+	size = CompileOnce(data, len, MYL_PARSER_YACC);
+	memcpy(Code, VMCode, size * sizeof(Instruction));
+	for (i = 0; i < STACKSIZE; i++) {
+		Memory[i] = VMStack[i];
+		if (Memory[i].tag == T_STRING)
+			Memory[i].mem.str = new StringType(*VMMEM(i).str);
+	}
+
+	rdsize = CompileOnce(data, len, MYL_PARSER_RD);
+	if (rdsize != size) {
+		printf("%s: code size %d, recursive descent %d\n", name, size, rdsize);
+		return 0;
+	}
+	for (i = 0; i < size; i++) {
+		if (memcmp(&Code[i], &VMCode[i], sizeof(Instruction))) {
+			printf("%s: code differs\n", name);
+			PrintDisasm(stdout, i, &Code[i]);
+			PrintDisasm(stdout, i, &VMCode[i]);
+			return 0;
+		}
+	}
+	for (i = 0; i < STACKSIZE; i++) {
+		if (!SameMemory(i, &Memory[i])) {
+			printf("%s: memory differs at 0x%4.4X\n", name, i);
+			return 0;
+		}
+		if (Memory[i].tag == T_STRING) delete Memory[i].mem.str;
+	}
+	return 1;
+}
+
+/* What compiling a program, and running it if run, prints, in a child
+ * because errors exit. The status is 2 if it compiled and wasn't run, -1
+ * if it was killed after a few seconds. */
+static int ChildOutput(const char *data, int frontend, int optlevel, int run,
+	char *buf, int size)
+{
+	int fds[2], len = 0, n, status;
+	InputStream *stream;
+	MYLParser *parser;
+	pid_t pid;
+
+	if (pipe(fds)) return -1;
+	fflush(stdout);
+	pid = fork();
+	if (pid < 0) return -1;
+	if (!pid) {
+		dup2(fds[1], 1);
+		dup2(fds[1], 2);
+		close(fds[0]);
+		alarm(5);
+		stream = CreateMemStream(data, strlen(data));
+		parser = CreateMYLParser(stream);
+		SelectParser(parser, frontend);
+		SetOptLevel(parser, optlevel);
+		Compile(parser);
+		if (!run) _exit(2);
+		Run(0);
+		_exit(0);
+	}
+	close(fds[1]);
+	while (len < size - 1 && (n = read(fds[0], buf + len, size - 1 - len)) > 0)
+		len += n;
+	buf[len] = 0;
+	close(fds[0]);
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static int CheckError(int n, const char *data)
+{
+	char name[32], msg[256], rdmsg[256];
+	int status, rdstatus;
+
+	status = ChildOutput(data, MYL_PARSER_YACC, 1, 0, msg, sizeof(msg));
+	rdstatus = ChildOutput(data, MYL_PARSER_RD, 1, 0, rdmsg, sizeof(rdmsg));
+	snprintf(name, sizeof(name), "error/%d", n);
+	if (status == 2 || status != rdstatus || strcmp(msg, rdmsg)) {
+		printf("%s: %d %s", name, status, msg);
+		printf("recursive descent %d %s", rdstatus, rdmsg);
+		return 0;
+	}
+	printf("%-16s %8d %10s %10s %8s %5s\n", name, (int)strlen(data),
+		"", "", "", "same");
+	return 1;
+}
+
+static int CheckOutput(int n, const Output *prog)
+{
+	static const char *Parsers[] = {"yacc", "recursive descent"};
+	char name[32], out[1024];
+	int frontend, optlevel, status;
+
+	snprintf(name, sizeof(name), "output/%d", n);
+	for (frontend = MYL_PARSER_YACC; frontend <= MYL_PARSER_RD; frontend++) {
+		for (optlevel = 0; optlevel <= 1; optlevel++) {
+			status = ChildOutput(prog->text, frontend, optlevel, 1, out, sizeof(out));
+			if (status || strcmp(out, prog->expected)) {
+				printf("%s: %s -O%d %d\n%s", name, Parsers[frontend],
+					optlevel, status, out);
+				return 0;
+			}
+		}
+	}
+	printf("%-16s %8d %10s %10s %8s %5s\n", name, (int)strlen(prog->text),
+		"", "", "", "same");
+	return 1;
+}
+
+static int Compare(const char *name, const char *data, int len)
+{
+	double yacc, rd;
+
+	if (!Check(name, data, len)) return 0;
+	yacc = TimeCompile(data, len, MYL_PARSER_YACC);
+	rd = TimeCompile(data, len, MYL_PARSER_RD);
+	printf("%-16s %8d %10.3f %10.3f %8.2f %5s\n", name, len,
+		yacc * 1e3, rd * 1e3, yacc / rd, "same");
+	return 1;
+}
+
+static char *ReadFile(const char *path, int *len)
+{
+	FILE *fp = fopen(path, "rb");
+	char *data;
+	long size;
+
+	if (!fp) return NULL;
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	data = (char *)malloc(size + 1);
+	if (!data || fread(data, 1, size, fp) != (size_t)size) {
+		free(data);
+		fclose(fp);
+		return NULL;
+	}
+	fclose(fp);
+	*len = (int)size;
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	int i, failed = 0;
+
+	printf("%-16s %8s %10s %10s %8s %5s\n",
+		"program", "bytes", "yacc ms", "rd ms", "speedup", "code");
+	if (argc > 1) {
+		for (i = 1; i < argc; i++) {
+			int len;
+			char *data = ReadFile(argv[i], &len);
+
+			if (!data) {
+				printf("Can't open %s\n", argv[i]);
+				return 2;
+			}
+			failed |= !Compare(argv[i], data, len);
+			free(data);
+		}
+		return failed;
+	}
+	for (i = 0; i < DimensionCount; i++) {
+		const Dimension *dim = &Dimensions[i];
+		int n, size = dim->start;
+
+		for (n = 0; n < SIZES; n++, size *= 2) {
+			Buffer buf;
+			char name[32];
+
+			InitBuffer(&buf);
+			dim->gen(&buf, size);
+			snprintf(name, sizeof(name), "%s/%d", dim->name, size);
+			failed |= !Compare(name, buf.data, buf.len);
+			FreeBuffer(&buf);
+		}
+	}
+	for (i = 0; i < (int)(sizeof(Errors) / sizeof(Errors[0])); i++)
+		failed |= !CheckError(i, Errors[i]);
+	for (i = 0; i < (int)(sizeof(Outputs) / sizeof(Output)); i++)
+		failed |= !CheckOutput(i, &Outputs[i]);
+	return failed;
+}
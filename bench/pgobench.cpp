@@ -0,0 +1,155 @@
+/* pgobench.cpp - Programs optimized with and without a profile of a run
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=pgobench [infile...]
+ *
+ * Each program, examples/in.myl and examples/branch.myl if none is
+ * given, is compiled at -O1, then run once on the code of the parser to
+ * take a profile, which is written to a file and read back to compile it
+ * at -O1 again. The size of the code, the instructions dispatched and the
+ * time of a run are printed for both. The output of the programs is
+ * thrown away. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "myl.h"
+#include "fileio.h"
+#include "vmachine.h"
+#include "profile.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+
+static FILE *out;
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* The profile file is given to the parser to either write or read */
+static int CompileFile(const char *path, const char *profileout, const char *profilein)
+{
+	InputStream *stream = CreateFileStream(path);
+	MYLParser *parser;
+	int size;
+
+	if (!stream) {
+		fprintf(stderr, "Can't open %s.\n", path);
+		exit(2);
+	}
+	if (!(parser = CreateMYLParser(stream))) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetProfileOut(parser, profileout);
+	SetProfileIn(parser, profilein);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseFileStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+static void Measure(const char *name, const char *options, int size, long *n, double *t)
+{
+	*n = Dispatches();
+	*t = TimeRun();
+	fprintf(out, "%-20s %-8s %6d %10ld %10.2f\n", name, options, size, *n, *t * 1e6);
+}
+
+static void Bench(const char *path, const char *profpath)
+{
+	const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+	Profile *profile;
+	long n0, n1;
+	double t0, t1;
+	int size;
+
+	Measure(name, "-O1", CompileFile(path, NULL, NULL), &n0, &t0);
+
+	size = CompileFile(path, profpath, NULL);
+	if (!(profile = CreateProfile(VMCode, size))) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(1);
+	}
+	RunProfile(0, profile->count, profile->taken);
+	if (!WriteProfile(profile, profpath)) exit(1);
+	CloseProfile(profile);
+
+	Measure(name, "-O1 pgo", CompileFile(path, NULL, profpath), &n1, &t1);
+	fprintf(out, "%-20s %-8s %6s %9.1f%% %9.1f%%\n", name, "saved", "",
+		100.0 * (n0 - n1) / n0, 100.0 * (t0 - t1) / t0);
+}
+
+int main(int argc, char *argv[])
+{
+	char profpath[] = "/tmp/pgobenchXXXXXX";
+	int fd, i;
+
+	if ((fd = mkstemp(profpath)) < 0) {
+		fprintf(stderr, "Can't create %s.\n", profpath);
+		return 1;
+	}
+	close(fd);
+	/* The programs print to stdout, the results go to a copy of it */
+	out = fdopen(dup(1), "w");
+	if (!out || !freopen("/dev/null", "w", stdout)) {
+		fprintf(stderr, "Can't redirect the output.\n");
+		return 1;
+	}
+	fprintf(out, "%-20s %-8s %6s %10s %10s\n", "program", "options", "code",
+		"dispatches", "us/run");
+	if (argc < 2) {
+		Bench("examples/in.myl", profpath);
+		Bench("examples/branch.myl", profpath);
+	}
+	for (i = 1; i < argc; i++) Bench(argv[i], profpath);
+	unlink(profpath);
+	fclose(out);
+	return 0;
+}
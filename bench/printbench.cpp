@@ -0,0 +1,130 @@
+/* printbench.cpp - print into its output buffer of several sizes
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=printbench [lines]
+ *
+ * A program printing an integer, a float and a string on each line, 100000
+ * lines if no count is given, is run with the output buffer of print of 0
+ * (each line written when it ends), 4096 bytes and the default size, into
+ * /dev/null. The same lines formatted by printf are timed for reference. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "output.h"
+#include "vmachine.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+
+static FILE *out;
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void CompileProgram(int lines)
+{
+	char text[256];
+	InputStream *stream;
+	MYLParser *parser;
+
+	snprintf(text, sizeof(text),
+		"integer i;\n"
+		"for (i = 0; i < %d; i++) print(i * 7919, \" \", i * 0.37, \" item\");\n",
+		lines);
+	stream = CreateMemStream(text, strlen(text));
+	if (!(parser = CreateMYLParser(stream))) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		Run(0);
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+static double TimePrintf(int lines)
+{
+	double start = Now();
+	int runs = 0, i;
+
+	do {
+		for (i = 0; i < lines; i++)
+			printf("%d %f item\n", i * 7919, (float)i * 0.37f);
+		fflush(stdout);
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main(int argc, char *argv[])
+{
+	static const int sizes[] = {0, 4096, OUTPUTSIZE};
+	int lines = argc > 1 ? atoi(argv[1]) : 100000;
+	int i;
+
+	if (lines <= 0) {
+		fprintf(stderr, "usage::=printbench [lines]\n");
+		return 1;
+	}
+	/* The program prints to stdout, the results go to a copy of it */
+	out = fdopen(dup(1), "w");
+	if (!out || !freopen("/dev/null", "w", stdout)) {
+		fprintf(stderr, "Can't redirect the output.\n");
+		return 1;
+	}
+	CompileProgram(lines);
+	fprintf(out, "%-12s %10s %10s\n", "output", "ms/run", "ns/line");
+	for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+		char name[16];
+		double t;
+
+		SetOutputSize(sizes[i]);
+		t = TimeRun();
+		snprintf(name, sizeof(name), "buffer %d", sizes[i]);
+		fprintf(out, "%-12s %10.2f %10.1f\n", name, t * 1e3, t * 1e9 / lines);
+	}
+	{
+		double t = TimePrintf(lines);
+		fprintf(out, "%-12s %10.2f %10.1f\n", "printf", t * 1e3, t * 1e9 / lines);
+	}
+	fclose(out);
+	return 0;
+}
@@ -0,0 +1,134 @@
+/* selectbench.cpp - The ?: operator with CMOV against the jumps of if
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=selectbench
+ *
+ * Each program picks one of two variables per iteration, with ?: which
+ * becomes a CMOV, and with if/else which jumps. The random condition
+ * tests the top bit of a linear congruential sequence, which the host
+ * can't predict, the steady one is true for the first half of the loop.
+ * Both are compiled at -O0 and -O1 and run once to count the
+ * instructions dispatched and again for the time, printed per
+ * iteration. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+#define ITERATIONS 100000
+
+typedef struct Program {
+	const char *name;
+	const char *text;
+} Program;
+
+#define PROLOGUE \
+	"integer i, r, s, m, a, b;\n" \
+	"r = 1; s = 0; a = 3; b = 5;\n" \
+	"for (i = 0; i < 100000; i++) {\n" \
+	"	r = (r * 25173 + 13849) % 65536;\n"
+#define EPILOGUE \
+	"	s = s + m;\n" \
+	"}\n" \
+	"srandom(s);\n"
+
+static const Program Programs[] = {
+	{"random ?:", PROLOGUE "	m = r < 32768 ? a : b;\n" EPILOGUE},
+	{"random if", PROLOGUE "	if (r < 32768) m = a; else m = b;\n" EPILOGUE},
+	{"steady ?:", PROLOGUE "	m = i < 50000 ? a : b;\n" EPILOGUE},
+	{"steady if", PROLOGUE "	if (i < 50000) m = a; else m = b;\n" EPILOGUE},
+};
+
+static const int OptLevels[] = {0, 1};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileProgram(const Program *prog, int optlevel)
+{
+	InputStream *stream = CreateMemStream(prog->text, strlen(prog->text));
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetOptLevel(parser, optlevel);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main()
+{
+	int i, j;
+
+	printf("%-10s %-8s %6s %10s %10s %10s\n", "program", "options",
+		"code", "dispatches", "per iter", "ns/iter");
+	for (i = 0; i < (int)(sizeof(Programs) / sizeof(Program)); i++) {
+		const Program *prog = &Programs[i];
+
+		for (j = 0; j < (int)(sizeof(OptLevels) / sizeof(int)); j++) {
+			int size = CompileProgram(prog, OptLevels[j]);
+			long n = Dispatches();
+			double t = TimeRun();
+
+			printf("%-10s -O%-6d %6d %10ld %10.2f %10.2f\n", prog->name,
+				OptLevels[j], size, n, (double)n / ITERATIONS,
+				t * 1e9 / ITERATIONS);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+/* strbench.cpp - Throughput of the string builtins over a large string
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=strbench [megabytes]
+ *
+ * A string of 16 MB of CSV lines if no size is given is read from a
+ * temporary file, then each string builtin is run over the whole of it.
+ * The time of the program without the builtin is taken off, and the MB
+ * scanned per second are printed. For comparison a count of commas is
+ * run as a MYL loop over each byte by substr, on the first MB only. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+
+#define MINTIME 0.3			/* seconds spent on each measurement */
+#define REPEAT 4			/* runs of the builtin in a program */
+
+typedef struct Bench {
+	const char *name;
+	const char *code;		/* run REPEAT times on s */
+	int whole;				/* scans all of s, or the first MB */
+} Bench;
+
+static const Bench Benches[] = {
+	{"length",		"n = length(s);", 1},
+	{"find byte",	"n = find(s, \"#\");", 1},
+	{"find word",	"n = find(s, \"zebra\");", 1},
+	{"count byte",	"n = count(s, \",\");", 1},
+	{"count word",	"n = count(s, \"ERROR\");", 1},
+	{"split",		"t = split(s, \",\", 1000000000);", 1},
+	{"replace",		"t = replace(s, \",\", \";\");", 1},
+	{"upper",		"t = upper(s);", 1},
+	{"lower",		"t = lower(s);", 1},
+	{"myl loop",	"for (j = 0; j < 1048576; j++) if (substr(s, j, 1) == \",\") n++;", 0},
+};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void WriteData(const char *path, long size)
+{
+	FILE *fp = fopen(path, "w");
+	long written = 0;
+	int i;
+
+	if (!fp) {
+		fprintf(stderr, "Can't write %s.\n", path);
+		exit(1);
+	}
+	for (i = 0; written < size; i++) {
+		written += fprintf(fp, "%d,host%d,%s,request %d,%d.%02d\n", i, i % 16,
+			i % 97 ? "INFO" : "ERROR", i * 7, i % 1000, i % 100);
+	}
+	fclose(fp);
+}
+
+/* The time of a run of the program, with code run REPEAT times */
+static double TimeProgram(const char *path, const char *code)
+{
+	char text[512];
+	InputStream *stream;
+	MYLParser *parser;
+	double start;
+	int runs = 0;
+
+	snprintf(text, sizeof(text),
+		"string s, t;\n"
+		"integer f, i, j, n;\n"
+		"f = open(\"%s\", \"r\");\n"
+		"s = readall(f);\n"
+		"close(f);\n"
+		"n = 0;\n"
+		"for (i = 0; i < %d; i++) { %s }\n", path, REPEAT, code);
+	stream = CreateMemStream(text, strlen(text));
+	if (!(parser = CreateMYLParser(stream))) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	start = Now();
+	do {
+		Run(0);
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main(int argc, char *argv[])
+{
+	char path[] = "/tmp/strbenchXXXXXX";
+	int megabytes = argc > 1 ? atoi(argv[1]) : 16;
+	double base, t;
+	int fd, i;
+
+	if (megabytes <= 0) {
+		fprintf(stderr, "usage::=strbench [megabytes]\n");
+		return 1;
+	}
+	if ((fd = mkstemp(path)) < 0) {
+		fprintf(stderr, "Can't create %s.\n", path);
+		return 1;
+	}
+	close(fd);
+	WriteData(path, megabytes * 1048576L);
+	printf("%-12s %10s %10s\n", "builtin", "ms", "MB/s");
+	base = TimeProgram(path, "");
+	for (i = 0; i < (int)(sizeof(Benches) / sizeof(Bench)); i++) {
+		t = (TimeProgram(path, Benches[i].code) - base) / REPEAT;
+		if (t < 1e-9) t = 1e-9;
+		printf("%-12s %10.3f %10.0f\n", Benches[i].name, t * 1e3,
+			(Benches[i].whole ? megabytes : 1) / t);
+	}
+	unlink(path);
+	return 0;
+}
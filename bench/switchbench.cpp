@@ -0,0 +1,198 @@
+/* switchbench.cpp - Switches of 1000 cases by table, search and hash
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* usage::=switchbench [cases]
+ *
+ * Each program runs one switch per iteration on a key taken from a
+ * linear congruential sequence. The dense keys make a JTAB, the sparse
+ * ones a JBIN and the strings a JHASH, the float keys are still tested
+ * one by one and show what a chain costs. The strings are rotated
+ * through eight variables, one of them matching no case. Each program is
+ * compiled at -O0 and -O1, the time to compile is printed with the
+ * instructions dispatched and the time per iteration. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "myl.h"
+#include "memio.h"
+#include "vmachine.h"
+#include "genprog.h"
+
+#define MINTIME 0.2			/* seconds spent on each measurement */
+#define ITERATIONS 10000
+#define ROTATION 8			/* string variables */
+
+typedef void (*Body)(Buffer *buf, int cases);
+
+typedef struct Program {
+	const char *name;
+	Body body;
+} Program;
+
+static void Loop(Buffer *buf)
+{
+	Emit(buf, "integer i, r, s;\nfloat f;\n");
+	Emit(buf, "r = 1; s = 0;\n");
+	Emit(buf, "for (i = 0; i < %d; i++) {\n", ITERATIONS);
+	Emit(buf, "	r = (r * 25173 + 13849) %% 65536;\n");
+}
+
+static void Cases(Buffer *buf, int cases, const char *fmt, int scale)
+{
+	int i;
+
+	for (i = 0; i < cases; i++) {
+		Emit(buf, "	case ");
+		Emit(buf, fmt, i * scale);
+		Emit(buf, ": s = s + %d; break;\n", i % 7 + 1);
+	}
+	Emit(buf, "	default: s = s - 1;\n	}\n}\nsrandom(s);\n");
+}
+
+static void GenDense(Buffer *buf, int cases)
+{
+	Loop(buf);
+	Emit(buf, "	switch (r %% %d) {\n", cases + cases / 10);
+	Cases(buf, cases, "%d", 1);
+}
+
+static void GenSparse(Buffer *buf, int cases)
+{
+	Loop(buf);
+	Emit(buf, "	switch (r %% %d * 37) {\n", cases + cases / 10);
+	Cases(buf, cases, "%d", 37);
+}
+
+static void GenFloat(Buffer *buf, int cases)
+{
+	Loop(buf);
+	Emit(buf, "	f = r %% %d + 0.5;\n", cases + cases / 10);
+	Emit(buf, "	switch (f) {\n");
+	Cases(buf, cases, "%d.5", 1);
+}
+
+static void GenString(Buffer *buf, int cases)
+{
+	int i;
+
+	for (i = 0; i <= ROTATION; i++)
+		Emit(buf, "string t%d;\n", i);
+	for (i = 0; i < ROTATION - 1; i++)
+		Emit(buf, "t%d = \"key%d\";\n", i, (i * 7919 + 13) % cases);
+	Emit(buf, "t%d = \"none\";\n", ROTATION - 1);
+	Loop(buf);
+	Emit(buf, "	t%d = t0;\n", ROTATION);
+	for (i = 0; i < ROTATION; i++)
+		Emit(buf, "	t%d = t%d;\n", i, i + 1);
+	Emit(buf, "	switch (t0) {\n");
+	Cases(buf, cases, "\"key%d\"", 1);
+}
+
+static const Program Programs[] = {
+	{"dense", GenDense},
+	{"sparse", GenSparse},
+	{"string", GenString},
+	{"float", GenFloat},
+};
+
+static const int OptLevels[] = {0, 1};
+
+static double Now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CompileProgram(const Buffer *buf, int optlevel)
+{
+	InputStream *stream = CreateMemStream(buf->data, buf->len);
+	MYLParser *parser = CreateMYLParser(stream);
+	int size;
+
+	if (!parser) {
+		fprintf(stderr, "Can't create parser.\n");
+		exit(3);
+	}
+	SetOptLevel(parser, optlevel);
+	size = Compile(parser);
+	CloseMYLParser(parser);
+	CloseMemStream(stream);
+	return size;
+}
+
+static long Dispatches()
+{
+	long n;
+
+	IP = 0;
+	for (n = 1; Step(); n++);
+	return n;
+}
+
+static double TimeRun()
+{
+	double start = Now();
+	int runs = 0;
+
+	do {
+		IP = 0;
+		while (Step());
+		runs++;
+	} while (Now() - start < MINTIME);
+	return (Now() - start) / runs;
+}
+
+int main(int argc, char *argv[])
+{
+	int cases = argc > 1 ? atoi(argv[1]) : 1000;
+	int i, j;
+
+	if (cases < 8) {
+		fprintf(stderr, "usage::=switchbench [cases]\n");
+		return 1;
+	}
+	printf("%-8s %-8s %6s %10s %10s %10s %10s\n", "program", "options",
+		"code", "compile ms", "dispatches", "per iter", "ns/iter");
+	for (i = 0; i < (int)(sizeof(Programs) / sizeof(Program)); i++) {
+		const Program *prog = &Programs[i];
+		Buffer buf;
+
+		InitBuffer(&buf);
+		prog->body(&buf, cases);
+		for (j = 0; j < (int)(sizeof(OptLevels) / sizeof(int)); j++) {
+			double start = Now();
+			int size = CompileProgram(&buf, OptLevels[j]);
+			double compile = Now() - start;
+			long n = Dispatches();
+			double t = TimeRun();
+
+			printf("%-8s -O%-6d %6d %10.2f %10ld %10.2f %10.2f\n", prog->name,
+				OptLevels[j], size, compile * 1e3, n, (double)n / ITERATIONS,
+				t * 1e9 / ITERATIONS);
+		}
+		FreeBuffer(&buf);
+	}
+	return 0;
+}
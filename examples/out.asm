@@ -0,0 +1,110 @@
+[0000]CALL 0x18 0x2 (0)
+[0001]ARG (8000) (0) (FFFFFFFF)
+[0002]FARG -1 (0) (FFFFFFFF)
+[0003]CALL 0x18 0x2 (0)
+[0004]ARG (8001) (0) (FFFFFFFF)
+[0005]FARG 1 (0) (FFFFFFFF)
+[0006]CALL 0x18 0x2 (0)
+[0007]ARG (8002) (0) (FFFFFFFF)
+[0008]FARG 3445.06 (0) (FFFFFFFF)
+[0009]CALL 0x18 0x2 (0)
+[000A]ARG (8003) (0) (FFFFFFFF)
+[000B]ARG 0xE0000000 (0) (FFFFFFFF)
+[000C]CALL 0x18 0x2 (0)
+[000D]ARG (8004) (0) (FFFFFFFF)
+[000E]ARG 0x12 (0) (FFFFFFFF)
+[000F]CALL 0x18 0x1 (0)
+[0010]ARG (8005) (0) (FFFFFFFF)
+[0011]CALL 0x18 0x1 (0)
+[0012]ARG (8006) (0) (FFFFFFFF)
+[0013]MOV 0x2 (0) (0)
+[0014]JLE (0) 0x64 0x2F
+[0015]CALL 0x18 0x1 (0)
+[0016]ARG (8007) (0) (FFFFFFFF)
+[0017]CALL 0x18 0x1 (0)
+[0018]ARG (8008) (0) (FFFFFFFF)
+[0019]MOV 0x3 (0) (0)
+[001A]MOV (0) (0) (1)
+[001B]DEC (0) (0) (1)
+[001C]JNE (0) 0x0 0x39
+[001D]CALL 0x18 0x1 (0)
+[001E]ARG (800A) (0) (FFFFFFFF)
+[001F]CALL 0x18 0x1 (0)
+[0020]ARG (800B) (0) (FFFFFFFF)
+[0021]MOV 0x2 (0) (0)
+[0022]MOV 0x3 (0) (1)
+[0023]MUL (0) (0) (0)
+[0024]MOV (1) (0) (2)
+[0025]DEC (0) (0) (2)
+[0026]JE (1) 0x0 0x40
+[0027]MOV (2) (0) (1)
+[0028]MUL (0) (0) (0)
+[0029]MOV (1) (0) (2)
+[002A]DEC (0) (0) (2)
+[002B]JNE (1) 0x0 0x27
+[002C]JMP (0) (0) 0x40
+[002D]INC (0) (0) (0)
+[002E]JG (0) 0x64 0x15
+[002F]MOV 0x2 (0) (1)
+[0030]JGE (1) (0) 0x35
+[0031]MOD (0) (1) (2)
+[0032]JE (2) 0x0 0x35
+[0033]INC (0) (0) (1)
+[0034]JL (1) (0) 0x31
+[0035]JNE (1) (0) 0x2D
+[0036]CALL 0x18 0x1 (1)
+[0037]ARG (0) (0) (FFFFFFFF)
+[0038]JMP (0) (0) 0x2D
+[0039]CALL 0x18 0x1 (0)
+[003A]ARG (8009) (0) (FFFFFFFF)
+[003B]MOV (1) (0) (0)
+[003C]MOV (0) (0) (1)
+[003D]DEC (0) (0) (1)
+[003E]JNE (0) 0x0 0x39
+[003F]JMP (0) (0) 0x1D
+[0040]CALL 0x18 0x2 (0)
+[0041]ARG (800C) (0) (FFFFFFFF)
+[0042]ARG (0) (0) (FFFFFFFF)
+[0043]CALL 0x18 0x1 (0)
+[0044]ARG (800D) (0) (FFFFFFFF)
+[0045]CALL 0x18 0x1 (0)
+[0046]ARG (800E) (0) (FFFFFFFF)
+[0047]CALL 0x18 0x1 (0)
+[0048]ARG (8011) (0) (FFFFFFFF)
+[0049]CALL 0x18 0x1 (0)
+[004A]ARG (8013) (0) (FFFFFFFF)
+[004B]CALL 0x18 0x1 (0)
+[004C]ARG (8014) (0) (FFFFFFFF)
+[004D]CALL 0x1 0x3 (3)
+[004E]ARG (8015) (0) (FFFFFFFF)
+[004F]ARG (8016) (0) (FFFFFFFF)
+[0050]ARG (8017) (0) (FFFFFFFF)
+[0051]CALL 0x18 0x1 (0)
+[0052]ARG (3) (0) (FFFFFFFF)
+[0053]RET 0x0 0x0 0x0
+
+Dumping memory:
+Memory[0x8000]:a=
+Memory[0x8001]:a=
+Memory[0x8002]:b=
+Memory[0x8003]:c=
+Memory[0x8004]:d=
+Memory[0x8005]:
+Memory[0x8006]:Primes less than 100:
+Memory[0x8007]:
+Memory[0x8008]:while loop:
+Memory[0x8009]:hello
+Memory[0x800A]:
+Memory[0x800B]:do/while loop:
+Memory[0x800C]:i=
+Memory[0x800D]:
+Memory[0x800E]:switch/case:
+Memory[0x800F]:Case 1
+Memory[0x8010]:Case 2
+Memory[0x8011]:Case 3
+Memory[0x8012]:default
+Memory[0x8013]:
+Memory[0x8014]:string test:
+Memory[0x8015]:aaa
+Memory[0x8016]:bbb
+Memory[0x8017]:ccc
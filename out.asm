@@ -0,0 +1,43 @@
+[0000]MOV 0x0 (0) (2)
+[0001]MOV (2) (0) (1)
+[0002]MOV 0x7FFFFFF8 (0) (2)
+[0003]MOV (2) (0) (0)
+[0004]FORPREP (0) 0x0 (0)
+[0005]JL (0) 0x7FFFFFFF 0xB
+[0006]JMP (0) (0) 0x14
+[0007]JMP (0) (0) 0x14
+[0008]FORLOOP (0) 0x3 (0)
+[0009]JL (0) 0x7FFFFFFF 0xB
+[000A]JMP (0) (0) 0x14
+[000B]MOV (1) (0) (2)
+[000C]INC (0) (0) (1)
+[000D]MOV (1) (0) (2)
+[000E]MOV 0x5 (0) (3)
+[000F]JG (2) (3) 0x11
+[0010]JMP (0) (0) 0x8
+[0011]JMP (0) (0) 0x14
+[0012]FORLOOP (0) 0x3 (0)
+[0013]JL (0) 0x7FFFFFFF 0xB
+[0014]CALL 0x18 0x3 (2)
+[0015]ARG (1) (0) (FFFFFFFF)
+[0016]ARG (8000) (0) (FFFFFFFF)
+[0017]ARG (0) (0) (FFFFFFFF)
+[0018]MOV 0x0 (0) (2)
+[0019]MOV (2) (0) (0)
+[001A]FORPREP (0) 0x0 (0)
+[001B]JL (0) 0xA 0x21
+[001C]JMP (0) (0) 0x25
+[001D]JMP (0) (0) 0x25
+[001E]FORLOOP (0) 0x1 (0)
+[001F]JL (0) 0xA 0x21
+[0020]JMP (0) (0) 0x25
+[0021]MOV (1) (0) (2)
+[0022]INC (0) (0) (1)
+[0023]FORLOOP (0) 0x1 (0)
+[0024]JL (0) 0xA 0x21
+[0025]CALL 0x18 0x1 (2)
+[0026]ARG (1) (0) (FFFFFFFF)
+[0027]RET 0x0 0x0 0x0
+
+Dumping memory:
+Memory[0x8000]: 
@@ -0,0 +1,114 @@
+/* arena.c - bump pointer memory used by one compilation
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+typedef struct ArenaBlock {
+	struct ArenaBlock *next;
+	size_t size;
+	size_t used;
+} ArenaBlock;
+
+struct Arena {
+	ArenaBlock *head;		/* block being filled, older ones follow */
+	size_t blocksize;
+};
+
+/* Data of a block starts right after its header */
+#define BLOCKHEAD ((sizeof(ArenaBlock)+ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1))
+#define BLOCKDATA(b) ((char *)(b)+BLOCKHEAD)
+
+static ArenaBlock *NewBlock(size_t size)
+{
+	ArenaBlock *block = (ArenaBlock *)malloc(BLOCKHEAD+size);
+
+	if (!block) {
+		fprintf(stderr, "Out of memory\n");
+		exit(4);
+	}
+	block->next = 0;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+Arena *CreateArena(size_t blocksize)
+{
+	Arena *arena = (Arena *)malloc(sizeof(Arena));
+
+	if (!arena) {
+		return NULL;
+	}
+	arena->blocksize = blocksize;
+	arena->head = NewBlock(blocksize);
+	return arena;
+}
+
+void CloseArena(Arena *arena)
+{
+	ArenaBlock *block = arena->head, *next;
+
+	while (block) {
+		next = block->next;
+		free(block);
+		block = next;
+	}
+	free(arena);
+}
+
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+	ArenaBlock *block = arena->head;
+	void *p;
+
+	size = (size+ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1);
+	if (block->used+size > block->size) {
+		if (size > arena->blocksize/4) {
+			/* Big items get their own block behind the current one,
+			 * so the space left in the current one is not wasted */
+			block = NewBlock(size);
+			block->next = arena->head->next;
+			arena->head->next = block;
+			block->used = size;
+			return BLOCKDATA(block);
+		}
+		block = NewBlock(arena->blocksize);
+		block->next = arena->head;
+		arena->head = block;
+	}
+	p = BLOCKDATA(block)+block->used;
+	block->used += size;
+	return p;
+}
+
+char *ArenaStrdup(Arena *arena, const char *str)
+{
+	size_t len = strlen(str)+1;
+	char *p = (char *)ArenaAlloc(arena, len);
+
+	memcpy(p, str, len);
+	return p;
+}
@@ -0,0 +1,45 @@
+/* arena.h - bump pointer memory used by one compilation
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Everything the compiler allocates lives until the arena is closed,
+ * there is no way to free a single item. */
+typedef struct Arena Arena;
+
+Arena *CreateArena(size_t blocksize);
+void CloseArena(Arena *arena);
+
+void *ArenaAlloc(Arena *arena, size_t size);
+char *ArenaStrdup(Arena *arena, const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
@@ -0,0 +1,1889 @@
+/* codegen.cpp - Code generation shared by the parsers
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "myl.h"
+#include "myl_internal.h"
+#include "element.h"
+#include "stackitem.h"
+#include "vmachine.h"
+#include "funcdefs.h"
+#include "ir.h"
+#include "profile.h"
+#include "codegen.h"
+
+typedef struct Varlistitem {
+	int name;				/* variable name */
+	int addr;				/* address */
+	struct Varlistitem*next;
+	char flag;
+	char type;				/* T_FLOAT or T_INTEGER...etc. */
+} Varlistitem;
+
+typedef struct Caselistitem {
+	int name;
+	int addr;
+	int type;
+	struct Caselistitem*next;
+	struct Caselistitem*hashnext;
+} Caselistitem;
+
+typedef struct Labellistitem {
+	int name;
+	int addr;
+	int list;
+	struct Labellistitem*next;
+} Labellistitem;
+
+typedef struct Funclistitem {
+	int name;
+	int entry;				/* address of its ENTER */
+	int body;				/* the code after the PARAMs */
+	int type;				/* of the value */
+	int paracnt;
+	Varlistitem *params;	/* the first variables of the function */
+	struct Funclistitem*next;
+} Funclistitem;
+
+typedef struct CaseStack {
+	Caselistitem list;
+	Caselistitem *tail;
+	Caselistitem **hash;	/* the cases by type and name */
+	int hashsize, count;
+	struct CaseStack *next,*prev;
+} CaseStack;
+
+static StackItem LoopTable;
+static StackItem *LoopTop;
+static Varlistitem Varlist={-1,CODESIZE,0,0};
+static CaseStack *CaseTop;
+static Labellistitem *LabelList;
+static Funclistitem Funclist;
+static Funclistitem *CurFunc;	/* being defined, 0 outside a function */
+static Varlistitem *OuterVars;	/* hidden in the function */
+static Labellistitem *OuterLabels;
+static int FrameBase, FrameTop;	/* the slots of the function */
+static Instruction ParamArg[HEAPSTART];	/* of the calls being parsed */
+static int ParamCode[HEAPSTART];
+static int ParamType[HEAPSTART];
+static int ParamTop;
+static int LastCall;			/* the last CALLU */
+static Profile *OutProfile;		/* of the run, until it is written */
+static const char *OutProfilePath;
+
+static Labellistitem *SearchLabel(int);
+static Labellistitem *NewLabel(MYLParser *parser, int);
+static void CheckLabels(MYLParser *parser);
+
+static Instruction Code;
+
+static void PushCase(MYLParser *parser, int type);
+static void PopCase();
+static int CurrentCase();
+static int SearchCase(int type, int cnt_id);
+static int RegCase(MYLParser *parser, int type, int cnt_id, int addr);
+
+static int SearchVar(int name);
+static Funclistitem *SearchFunc(int name);
+static int GetVarType(int name);
+static int NewVar(MYLParser *parser, int name, int type);
+//static void SetVarType(int varid, int type);
+static void SetVarFlag(int varid, int flag);
+//static int GetVarFlag(int varid);
+static int GetVar(int varid);
+static int IsVar(int addr, int type);
+
+static int CountedLoop(const Expval *cond, const Intval *act,
+	const Intval *body, Instruction *test);
+static int LoadedConstant(int begin, int end, int addr, int *value);
+static int Assigns(int begin, int end, int addr);
+static int Entered(int begin, int end);
+static void SetForCode(int addr, int op, int step, const Instruction *test);
+
+static int MakeSelect(const Expval *sel, const Expval *colon, const Expval *exp);
+static int IsLoad(const Instruction *inst, int place);
+static void FoldParams(const Paraval *params, int noimm);
+static int Convertible(int from, int to);
+static int TailCall(const Expval *exp);
+
+static void makevalue(Expval *pval);
+static void makelist(MYLParser *parser, Expval *pval);
+static int LastCompare(const Expval *pval);
+static int CompareCode(int op);
+static int FuncMap(const char *name);
+static char memmap[STACKSIZE];
+int CurrentIP;
+static int OprCode(int);
+static void backpatch(int,int);
+static int merge(int, int);
+static int newmem();
+static int newtemp();
+static void freetemp(int);
+static void CheckCodeSize();
+static void GenCode(const Instruction *inst);
+static void fGenCode(int op, float src1, float src2, int dest);
+static void iGenCode(int op, int src1, int src2, int dest);
+
+void BeginUnit(MYLParser *parser)
+{
+	int i;
+
+	CurrentIP=0;
+	LoopTable.data=0;
+	LoopTable.next=LoopTable.prev=0;
+	LoopTop=&LoopTable;
+
+	Varlist.next=0;
+
+	CaseTop=(CaseStack *)ArenaAlloc(parser->arena, sizeof(CaseStack));
+	CaseTop->prev=CaseTop->next=0;
+	CaseTop->list.next=0;
+	CaseTop->tail=&CaseTop->list;
+	CaseTop->hash=0;
+	CaseTop->hashsize=CaseTop->count=0;
+
+	LabelList=(Labellistitem *)ArenaAlloc(parser->arena, sizeof(Labellistitem));
+	LabelList->next=0;
+	ParamTop=0;
+
+	Funclist.next=0;
+	CurFunc=0;
+	FrameBase=FrameTop=0;
+	LastCall=-1;
+
+	for (i=0; i<STACKSIZE; i++) memmap[i]=0;
+}
+
+void EndUnit(MYLParser *parser, const Intval *myl)
+{
+	CheckLabels(parser);
+	backpatch(myl->chain, CurrentIP);
+	backpatch(myl->breakchain, CurrentIP);
+	iGenCode(RET|FLAG1|FLAG2|FLAG3,0,0,0);
+}
+
+/* Statements */
+
+void JoinStatements(Intval *res, const Intval *first, const Intval *next)
+{
+	res->codebegin=first->codebegin;
+	backpatch(first->chain, next->codebegin);
+	res->chain=next->chain;
+	res->breakchain=merge(first->breakchain, next->breakchain);
+}
+
+void EmptyStatement(Intval *res)
+{
+	res->codebegin=CurrentIP;
+	res->chain=CODESIZE;
+	res->breakchain=CODESIZE;
+}
+
+void ExprStatement(Intval *res, const Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	if (exp->nolist) freetemp(exp->place);
+	else {
+		backpatch (exp->truelist, CurrentIP);
+		backpatch (exp->falselist, CurrentIP);
+	}
+	res->chain=CODESIZE;
+	res->breakchain=CODESIZE;
+}
+
+void ContinueStatement(MYLParser *parser, Intval *res)
+{
+	if (!IsStackEmpty(LoopTop)) {
+		res->codebegin=CurrentIP;
+		res->chain=CODESIZE;
+		res->breakchain=CODESIZE;
+		iGenCode(JMP|FLAG3,0,0,LoopTop->data);
+	}
+	else CompileError(parser, "Invalid continue statement.");
+}
+
+void BreakStatement(MYLParser *parser, Intval *res)
+{
+	if (!IsStackEmpty(LoopTop) || CaseTop->prev) {
+		res->codebegin=CurrentIP;
+		res->chain=CODESIZE;
+		res->breakchain=CurrentIP;
+		iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	}
+	else CompileError(parser, "Invalid break statement");
+}
+
+void GotoStatement(MYLParser *parser, Intval *res, int name)
+{
+	Labellistitem *label;
+	res->codebegin=CurrentIP;
+	res->chain=CODESIZE;
+	res->breakchain=CODESIZE;
+	if ((label=SearchLabel(name))) {
+		if (label->addr!=CODESIZE) {
+			iGenCode(JMP|FLAG3,0,0,label->addr);
+		}
+		else {
+			iGenCode(JMP|FLAG3,0,0,CODESIZE);
+			label->list=merge(CurrentIP-1,label->list);
+		}
+	}
+	else {
+		label=NewLabel(parser, name);
+		label->addr=CODESIZE;
+		label->list=CurrentIP;
+		iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	}
+}
+
+void DeclareVar(MYLParser *parser, int name, int type)
+{
+	if (!SearchVar(name)) {
+		NewVar(parser, name, type);
+	}
+	else CompileError(parser, "Variable redefined");
+}
+
+void DefineLabel(MYLParser *parser, int name)
+{
+	Labellistitem *label;
+	if ((label=SearchLabel(name))) {
+		if (label->addr!=CODESIZE)
+			CompileError(parser, "Label redefined");
+		else {
+			label->addr=CurrentIP;
+			backpatch(label->list, CurrentIP);
+		}
+	}
+	else {
+		label=NewLabel(parser, name);
+		label->addr=CurrentIP;
+		label->list=CODESIZE;
+	}
+}
+
+void DefineCase(MYLParser *parser, int type, int cnt_id)
+{
+	if (CurrentCase()!=type || SearchCase(type, cnt_id))
+		CompileError(parser, "Illegel case");
+	else RegCase(parser, type, cnt_id, CurrentIP);
+}
+
+void DefineDefault(MYLParser *parser)
+{
+	if (CurrentCase()==T_NULL || SearchCase(-1,0))
+		CompileError(parser, "Illegel default");
+	else RegCase(parser, -1,0, CurrentIP);
+}
+
+void BeginIf(MYLParser *parser, Intval *res, Expval *cond)
+{
+	res->codebegin=cond->codebegin;
+	makelist(parser, cond);
+	backpatch(cond->truelist, CurrentIP);
+	res->chain=cond->falselist;
+}
+
+void BeginElse(Intval *res, const Intval *ifpre, const Intval *body)
+{
+	res->codebegin=ifpre->codebegin;
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	backpatch(ifpre->chain, CurrentIP);
+	res->chain=merge(body->chain, CurrentIP-1);
+}
+
+void EndIf(Intval *res, const Intval *pre, const Intval *body)
+{
+	res->codebegin=pre->codebegin;
+	res->chain=merge(pre->chain, body->chain);
+	res->breakchain=body->breakchain;
+}
+
+void BeginWhile(MYLParser *parser, Intval *res, Expval *cond)
+{
+	res->codebegin=cond->codebegin;
+	Push(parser->arena, &LoopTop, cond->codebegin);
+	makelist(parser, cond);
+	backpatch(cond->truelist, CurrentIP);
+	res->chain=cond->falselist;
+}
+
+void EndWhile(Intval *res, const Intval *pre, const Intval *body)
+{
+	res->codebegin=pre->codebegin;
+	backpatch(body->chain, pre->codebegin);
+	iGenCode(JMP|FLAG3,0,0,pre->codebegin);
+	res->chain=merge(pre->chain, body->breakchain);
+	res->breakchain=CODESIZE;
+	Pop(&LoopTop);
+}
+
+void BeginDo(MYLParser *parser)
+{
+	Push(parser->arena, &LoopTop, CurrentIP);
+}
+
+void EndDoWhile(MYLParser *parser, Intval *res, const Intval *body, Expval *cond)
+{
+	res->codebegin=body->codebegin;
+	makelist(parser, cond);
+	backpatch(cond->truelist, body->codebegin);
+	backpatch(body->chain, cond->codebegin);
+	res->chain=merge(body->breakchain, cond->falselist);
+	res->breakchain=CODESIZE;
+	Pop(&LoopTop);
+}
+
+void ForInit(Intval *res, const Expval *init)
+{
+	res->codebegin=init->codebegin;
+	if (init->nolist) {
+		freetemp(init->place);
+		res->chain=CODESIZE;
+	}
+	else {
+		res->chain=merge(init->truelist,init->falselist);
+	}
+}
+
+void ForCondition(MYLParser *parser, Expval *res, Expval *cond)
+{
+	res->codebegin=cond->codebegin;
+	makelist(parser, cond);
+	res->truelist=cond->truelist;
+	res->falselist=cond->falselist;
+}
+
+void ForAction(MYLParser *parser, Intval *res, const Expval *act)
+{
+	res->codebegin=act->codebegin;
+	res->chain=CurrentIP;
+	Push(parser->arena, &LoopTop, act->codebegin);
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	if (act->nolist) freetemp(act->place);
+}
+
+void EndFor(MYLParser *parser, Intval *res, const Intval *init,
+	const Expval *cond, const Intval *act, const Intval *body)
+{
+	Instruction test;
+	int step;
+
+	res->codebegin=init->codebegin;
+	backpatch(init->chain, cond->codebegin);
+	backpatch(cond->truelist, body->codebegin);
+	backpatch(act->chain, cond->codebegin);
+	backpatch(body->chain, act->codebegin);
+	res->chain=merge(body->breakchain,cond->falselist);
+	res->breakchain=CODESIZE;
+	/* The optimizer rotates and unrolls the loop by itself */
+	if (!parser->optlevel && (step=CountedLoop(cond, act, body, &test))) {
+		/* The condition becomes the first test and the action (where
+		 * continue goes) the step, the rest of their code is dead */
+		SetForCode(cond->codebegin, FORPREP|FLAG2, 0, &test);
+		res->chain=merge(res->chain, cond->codebegin+2);
+		SetForCode(act->codebegin, FORLOOP|FLAG2, step, &test);
+		res->chain=merge(res->chain, act->codebegin+2);
+		iGenCode(FORLOOP|FLAG2,test.src1.i,step,test.src1.i);
+		GenCode(&test);
+	}
+	else iGenCode(JMP|FLAG3,0,0,act->codebegin);
+	Pop(&LoopTop);
+}
+
+void BeginSwitch(MYLParser *parser, Expval *res, Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	res->type=exp->type;
+	makevalue(exp);
+	res->place=exp->place;
+	res->truelist=CurrentIP;
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	PushCase(parser, exp->type);
+}
+
+void EndSwitch(MYLParser *parser, Intval *res, const Expval *pre, const Intval *body)
+/* The cases are tested by a chain of JE, which becomes a table of them
+ * at -O0. The optimizer makes the tables when it lowers the code. */
+{
+	Caselistitem *plist,*defnode;
+	Instruction *tests, *table;
+	int ntests=0, size=0, i;
+	res->codebegin=pre->codebegin;
+	res->breakchain=CODESIZE;
+	res->chain=CurrentIP;
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+	backpatch(pre->truelist, CurrentIP);
+	tests=(Instruction *)ArenaAlloc(parser->arena, (CaseTop->count+1)*sizeof(Instruction));
+	plist=&(CaseTop->list);
+	defnode=0;
+	while (plist->next) {
+		plist=plist->next;
+		if (plist->type!=-1&&plist->name!=0) {
+			if (plist->type!=pre->type)
+				CompileError(parser, "Case type mismatch");
+			switch (pre->type) {
+			case T_INTEGER:
+				Code.op=JE|FLAG2|FLAG3;
+				Code.src1.i=pre->place;
+				Code.src2.i=GetInteger(parser->elemParser, plist->name);
+				break;
+			case T_FLOAT:
+				Code.op=JE|FLAG2|FLAG3|FLFLAG;
+				Code.src1.i=pre->place;
+				Code.src2.f=GetFloat(parser->elemParser, plist->name);
+				break;
+			case T_STRING:
+				{int temp;
+				temp=newmem();
+				PrepareMem(temp);
+				SetMemStr(temp, GetString(parser->elemParser, plist->name));
+				Code.op=JE|FLAG3|STRFLAG;
+				Code.src1.i=pre->place;
+				Code.src2.i=temp;}
+				break;
+			default:
+				continue;
+			}
+			Code.dest=plist->addr;
+			tests[ntests++]=Code;
+		}
+		else defnode=plist;
+	}
+	if (!parser->optlevel) {
+		table=(Instruction *)ArenaAlloc(parser->arena, DISPATCHSIZE(ntests)*sizeof(Instruction));
+		size=PlanDispatch(parser->arena, tests, ntests, table);
+		for (i=0; i<size; i++) {
+			/* A key left out of a JTAB goes on past it */
+			if (table[i].dest==-1) table[i].dest=CurrentIP+size-i;
+			GenCode(&table[i]);
+		}
+	}
+	for (i=0; i<ntests && !size; i++) GenCode(&tests[i]);
+	if (defnode) {
+		iGenCode(JMP|FLAG3,0,0,defnode->addr);
+	}
+	backpatch(body->breakchain, CurrentIP);
+	PopCase();
+	freetemp(pre->place);
+}
+
+void BeginFunction(MYLParser *parser, Intval *res, const Expval *pre, int name)
+/* The code of a function is jumped over, it only runs from a CALLU. It
+ * sees its own variables, in the slots after those used so far. */
+{
+	Funclistitem *pfunc=&Funclist;
+	int mem;
+
+	if (CurFunc) CompileError(parser, "Nested function.");
+	if (!IsStackEmpty(LoopTop) || CaseTop->prev)
+		CompileError(parser, "Function inside a loop or switch.");
+	if (FuncMap(GetIdent(parser->elemParser, name))!=UNKNOWN || SearchFunc(name))
+		CompileError(parser, "Function redefined.");
+	if (pre->type==T_LIST) CompileError(parser, "Data mismatch.");
+	res->codebegin=CurrentIP;
+	res->chain=CurrentIP;
+	res->breakchain=CODESIZE;
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+
+	while (pfunc->next) pfunc=pfunc->next;
+	CurFunc=(Funclistitem*)ArenaAlloc(parser->arena, sizeof(Funclistitem));
+	CurFunc->name=name;
+	CurFunc->entry=CurrentIP;
+	CurFunc->body=CurrentIP+1;
+	CurFunc->type=pre->type;
+	CurFunc->paracnt=0;
+	CurFunc->params=0;
+	CurFunc->next=0;
+	pfunc->next=CurFunc;
+	iGenCode(ENTER|FLAG1|FLAG2|FLAG3,0,0,CODESIZE);
+
+	OuterVars=Varlist.next;
+	Varlist.next=0;
+	OuterLabels=LabelList;
+	LabelList=(Labellistitem *)ArenaAlloc(parser->arena, sizeof(Labellistitem));
+	LabelList->next=0;
+	for (mem=HEAPSTART; mem>0 && !memmap[mem-1]; mem--);
+	FrameBase=FrameTop=mem;
+}
+
+void DeclareParam(MYLParser *parser, int type, int name)
+/* Param k is copied from the frame to its variable on entry */
+{
+	int var;
+
+	if (type==T_LIST) CompileError(parser, "Data mismatch.");
+	DeclareVar(parser, name, type);
+	var=SearchVar(name);
+	iGenCode(PARAM|FLAG1|FLAG2,CurFunc->paracnt++,type,GetVar(var));
+	CurFunc->params=Varlist.next;
+	CurFunc->body=CurrentIP;
+}
+
+void EndFunction(MYLParser *parser, Intval *res, const Intval *pre, const Intval *body)
+/* A function that ends without a return returns 0 or "". Its slots are
+ * kept from the code after it. */
+{
+	Instruction *enter=&VMCode[CurFunc->entry];
+	int mem;
+
+	backpatch(body->chain, CurrentIP);
+	backpatch(body->breakchain, CurrentIP);
+	if (CurFunc->type==T_STRING) {
+		mem=newmem();
+		PrepareMem(mem);
+		SetMemStr(mem, "");
+		iGenCode(RETU|FLAG2|FLAG3,mem,0,T_STRING);
+	}
+	else if (CurFunc->type==T_FLOAT) fGenCode(RETU|FLAG1|FLAG2|FLAG3,0.0,0.0,T_FLOAT);
+	else iGenCode(RETU|FLAG1|FLAG2|FLAG3,0,0,CurFunc->type);
+	enter->src1.i=FrameBase;
+	enter->src2.i=FrameTop-FrameBase;
+	enter->dest=CurrentIP;
+	for (mem=FrameBase; mem<FrameTop; mem++) memmap[mem]=1;
+
+	CheckLabels(parser);
+	Varlist.next=OuterVars;
+	LabelList=OuterLabels;
+	CurFunc=0;
+	FrameBase=FrameTop=0;
+	res->codebegin=pre->codebegin;
+	res->chain=pre->chain;
+	res->breakchain=CODESIZE;
+}
+
+void ReturnStatement(MYLParser *parser, Intval *res, Expval *exp)
+/* The value is returned as the type of the function, a constant or a
+ * variable loaded last is returned from where it is */
+{
+	Instruction *load=&VMCode[CurrentIP-1];
+
+	res->codebegin=exp->codebegin;
+	res->chain=CODESIZE;
+	res->breakchain=CODESIZE;
+	if (!CurFunc) CompileError(parser, "Invalid return statement.");
+	makevalue(exp);
+	if (!Convertible(exp->type, CurFunc->type)) CompileError(parser, "Data mismatch.");
+	if (TailCall(exp)) return;
+	freetemp(exp->place);
+	if (exp->codebegin==CurrentIP-1 && IsLoad(load, exp->place)) {
+		Code=*load;
+		Code.op=RETU|FLAG2|FLAG3|(load->op&(FLAG1|FLFLAG));
+		Code.src2.i=0;
+		Code.dest=CurFunc->type;
+		CurrentIP--;
+		GenCode(&Code);
+	}
+	else iGenCode(RETU|FLAG2|FLAG3,exp->place,0,CurFunc->type);
+}
+
+/* Expressions */
+
+void LValue(MYLParser *parser, Varval *res, int name)
+{
+	res->var=SearchVar(name);
+	if (!res->var) {
+		CompileError(parser, "Undefined variable.");
+	}
+	else res->type=GetVarType(res->var);
+}
+
+void Assign(MYLParser *parser, Expval *res, const Varval *lres, int op, Expval *exp)
+/* The value of a plain assignment has no type, so it can't be used */
+{
+	makevalue(exp);
+	res->codebegin=exp->codebegin;
+	res->nolist=1;
+	res->place=newtemp();
+	res->type=T_NULL;
+	SetVarFlag(lres->var,1);
+	if (op!=S_SET) {
+	res->type=lres->type;
+		switch (lres->type) {
+		case T_NULL:
+			CompileError(parser, "Unknown variable.");
+			break;
+		case T_STRING:
+			CompileError(parser, "Can't compute a string variable.");
+			break;
+		case T_INTEGER:
+			if (exp->type==T_INTEGER||exp->type==T_FLOAT)
+				iGenCode(OprCode(op),
+					GetVar(lres->var),exp->place,GetVar(lres->var));
+			else CompileError(parser, "Wrong expression.");
+			break;
+		case T_FLOAT:
+			if (exp->type==T_INTEGER||exp->type==T_FLOAT)
+				iGenCode(OprCode(op)|FLFLAG,
+					GetVar(lres->var),exp->place,GetVar(lres->var));
+			else CompileError(parser, "Wrong expression.");
+			break;
+		case T_LIST:
+			CompileError(parser, "The type 'List' can't be supported by now");
+			break;
+		}
+	}
+	else {
+		switch (lres->type) {
+		case T_NULL:
+			CompileError(parser, "Internal error");
+			break;
+		case T_INTEGER:
+			if (exp->type==T_FLOAT)
+				iGenCode(CNV|FLFLAG,exp->place,0,GetVar(lres->var));
+			else if (exp->type==T_INTEGER)
+				iGenCode(MOV,exp->place,0,GetVar(lres->var));
+			else
+				CompileError(parser, "Incompatible data type");
+			break;
+		case T_FLOAT:
+			if (exp->type==T_INTEGER)
+				iGenCode(CNV,exp->place,0,GetVar(lres->var));
+			else if (exp->type==T_FLOAT)
+				iGenCode(MOV,exp->place,0,GetVar(lres->var));
+			else
+				CompileError(parser, "Incompatible data type");
+			break;
+		case T_STRING:
+			if (exp->type==T_STRING)
+				iGenCode(MOV,exp->place,0,GetVar(lres->var));
+			else
+				CompileError(parser, "Incompatible data type");
+			break;
+		case T_LIST:
+			CompileError(parser, "The type 'List' can't be supported by now");
+			break;
+	}
+	}
+	/*iGenCode(MOV,GetVar(lres->var),0,res->place);*/
+	freetemp(exp->place);
+}
+
+void BeginSelect(MYLParser *parser, Expval *res, Expval *cond)
+{
+	res->codebegin=cond->codebegin;
+	makelist(parser, cond);
+	res->truelist=cond->truelist;
+	res->falselist=cond->falselist;
+}
+
+void SelectColon(Expval *res, Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	makevalue(exp);
+	res->place=exp->place;
+	res->type=exp->type;
+	res->truelist=CurrentIP;
+	iGenCode(JMP|FLAG3,0,0,CODESIZE);
+}
+
+/* The arms of different number types give a float, as in C */
+void EndSelect(MYLParser *parser, Expval *res, const Expval *sel, const Expval *colon, Expval *exp)
+{
+	int end;
+
+	res->codebegin=sel->codebegin;
+	res->nolist=1;
+	makevalue(exp);
+	if (colon->type==T_LIST || exp->type==T_LIST
+		|| (colon->type==T_STRING)!=(exp->type==T_STRING))
+		CompileError(parser, "Type error.");
+	res->type=colon->type==exp->type ? colon->type : T_FLOAT;
+	if (colon->type==exp->type
+		&& (res->place=MakeSelect(sel, colon, exp))!=-1) {
+		freetemp(colon->place);
+		freetemp(exp->place);
+		return;
+	}
+	res->place=colon->place;
+	backpatch(sel->truelist, colon->codebegin);
+	backpatch(sel->falselist, exp->codebegin);
+	if (exp->type==res->type)
+		iGenCode(MOV,exp->place,0,colon->place);
+	else iGenCode(CNV,exp->place,0,colon->place);
+	if (colon->type!=res->type) {
+		/* the integer of the true arm is converted past the false one */
+		end=CurrentIP;
+		iGenCode(JMP|FLAG3,0,0,CODESIZE);
+		backpatch(colon->truelist, CurrentIP);
+		iGenCode(CNV,colon->place,0,colon->place);
+		backpatch(end, CurrentIP);
+	}
+	else backpatch(colon->truelist, CurrentIP);
+	freetemp(exp->place);
+}
+
+void BoolOperand(MYLParser *parser, Expval *res, Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	makelist(parser, exp);
+	res->truelist=exp->truelist;
+	res->falselist=exp->falselist;
+}
+
+void EndBoolOr(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp)
+{
+	res->codebegin=pre->codebegin;
+	res->nolist=0;
+	res->type=T_INTEGER;
+	makelist(parser, exp);
+	backpatch(pre->falselist,exp->codebegin);
+	res->truelist=merge(pre->truelist, exp->truelist);
+	res->falselist=exp->falselist;
+}
+
+void EndBoolAnd(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp)
+{
+	res->codebegin=pre->codebegin;
+	res->nolist=0;
+	res->type=T_INTEGER;
+	makelist(parser, exp);
+	backpatch(pre->truelist,exp->codebegin);
+	res->falselist=merge(pre->falselist, exp->falselist);
+	res->truelist=exp->truelist;
+}
+
+void Operand(Expval *res, Expval *exp, int op)
+/* The left operand of a binary operator, the operator is kept in nolist */
+{
+	res->codebegin=exp->codebegin;
+	res->type=exp->type;
+	makevalue(exp);
+	res->nolist=op;
+	res->place=exp->place;
+}
+
+void IntOperand(MYLParser *parser, Expval *res, Expval *exp, int op)
+{
+	res->codebegin=exp->codebegin;
+	res->type=T_INTEGER;
+	if (exp->type!=T_INTEGER)
+		CompileError(parser, "Wrong operation.");
+	makevalue(exp);
+	res->nolist=op;
+	res->place=exp->place;
+}
+
+void EndCompare(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp)
+{
+	int addr=-1;
+	res->codebegin=pre->codebegin;
+	res->nolist=1;
+	makevalue(exp);
+	res->place=newtemp();
+	res->type=T_INTEGER;
+	if (pre->type!=exp->type) {
+		if (pre->type==T_STRING || exp->type==T_STRING
+		|| pre->type==T_LIST || exp->type==T_LIST)
+			CompileError(parser, "Type error.");
+		addr=newtemp();
+		if (pre->type==T_INTEGER) {
+			iGenCode(CNV,pre->place,0,addr);
+			iGenCode(OprCode(pre->nolist)|FLFLAG,
+				addr,exp->place,res->place);
+		}
+		else {
+			iGenCode(CNV,exp->place,0,addr);
+			iGenCode(OprCode(pre->nolist)|FLFLAG,
+				pre->place,addr,res->place);
+		}
+	}
+	else {
+		if (pre->type==T_INTEGER) {
+			iGenCode(OprCode(pre->nolist)
+				,pre->place,exp->place,res->place);
+		}
+		else if (pre->type==T_FLOAT) {
+			iGenCode(OprCode(pre->nolist)|FLFLAG
+				,pre->place,exp->place,res->place);
+		}
+		else if (pre->type==T_STRING) {
+			iGenCode(OprCode(pre->nolist)|STRFLAG
+				,pre->place,exp->place,res->place);
+		}
+		else CompileError(parser, "Unhandled branch");
+	}
+	freetemp(addr);
+	freetemp(pre->place);
+	freetemp(exp->place);
+}
+
+void EndIntOp(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp)
+{
+	res->codebegin=pre->codebegin;
+	res->nolist=1;
+	makevalue(exp);
+	res->place=newtemp();
+	res->type=T_INTEGER;
+	if (exp->type!=T_INTEGER)
+		CompileError(parser, "Op error.");
+	iGenCode(OprCode(pre->nolist),
+			pre->place,exp->place,res->place);
+	freetemp(pre->place);
+	freetemp(exp->place);
+}
+
+void EndArith(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp)
+{
+	int addr=-1;
+	res->codebegin=pre->codebegin;
+	res->nolist=1;
+	makevalue(exp);
+	res->place=newtemp();
+
+	if (exp->type==T_STRING)
+		CompileError(parser, "Op error.");
+	if (pre->type!=exp->type) {
+		res->type=T_FLOAT;
+		addr=newtemp();
+		if (pre->type==T_INTEGER) {
+			iGenCode(CNV,pre->place,0,addr);
+			iGenCode(OprCode(pre->nolist)|FLFLAG,
+				addr,exp->place,res->place);
+		}
+		else if (exp->type==T_INTEGER) {
+			addr=newtemp();
+			iGenCode(CNV,exp->place,0,addr);
+			iGenCode(OprCode(pre->nolist)|FLFLAG,
+				pre->place,addr,res->place);
+		}
+	}
+	else {
+		res->type=pre->type;
+		if (pre->type==T_INTEGER) {
+			iGenCode(OprCode(pre->nolist)
+				,pre->place,exp->place,res->place);
+		}
+		else {
+			iGenCode(OprCode(pre->nolist)|FLFLAG
+				,pre->place,exp->place,res->place);
+		}
+	}
+	freetemp(addr);
+	freetemp(pre->place);
+	freetemp(exp->place);
+}
+
+void Negate(MYLParser *parser, Expval *res, int op, Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	res->nolist=1;
+	res->type=exp->type;
+	if (exp->type==T_STRING)
+		CompileError(parser, "+ op misused.");
+	makevalue(exp);
+	res->place=newtemp();
+	if (op==S_SUB) {
+		if (exp->type==T_INTEGER)
+			iGenCode(SUB|FLAG1,0,exp->place,res->place);
+		if (exp->type==T_FLOAT) {
+			Code.op=SUB|FLAG1|FLFLAG;
+			Code.src1.f=0.0;
+			Code.src2.i=exp->place;
+			Code.dest=res->place;
+			GenCode(&Code);
+		}
+		freetemp(exp->place);
+	}
+	else res->place=exp->place;
+}
+
+void LogicalNot(MYLParser *parser, Expval *res, Expval *exp)
+/* A value is tested without branches, the compare is left last for
+ * makelist to jump on it */
+{
+	static const int inverse[]={EQU, NOTEQU, GE, GREAT, LE, LESS};
+	Instruction *inst;
+
+	res->codebegin=exp->codebegin;
+	res->type=T_INTEGER;
+	if (exp->nolist && LastCompare(exp)
+		&& !(VMCode[CurrentIP-1].op & FLFLAG)) {
+		/* Exact for integers and strings, not for a float NaN */
+		inst=&VMCode[CurrentIP-1];
+		inst->op=(inst->op & ~OPMASK)|inverse[(inst->op & OPMASK)-NOTEQU];
+		res->nolist=1;
+		res->place=exp->place;
+	}
+	else if (exp->nolist && exp->type!=T_STRING) {
+		/* The integer compare of makelist, also for a float */
+		res->nolist=1;
+		res->place=newtemp();
+		iGenCode(EQU|FLAG2,exp->place,0,res->place);
+		freetemp(exp->place);
+	}
+	else {
+		res->nolist=0;
+		makelist(parser, exp);
+		res->truelist=exp->falselist;
+		res->falselist=exp->truelist;
+	}
+}
+
+void BitwiseNot(MYLParser *parser, Expval *res, int op, Expval *exp)
+{
+	res->codebegin=exp->codebegin;
+	res->nolist=1;
+	if (exp->type!=T_INTEGER) {
+		CompileError(parser, "~ op misused.");
+	}
+	res->type=T_INTEGER;
+	makevalue(exp);
+	res->place=newtemp();
+	iGenCode(OprCode(op),exp->place,0,res->place);
+	freetemp(exp->place);
+}
+
+void IntConstant(MYLParser *parser, Expval *res, int id)
+{
+	res->codebegin=CurrentIP;
+	res->nolist=1;
+	res->place=newtemp();
+	res->type=T_INTEGER;
+	iGenCode(MOV|FLAG1,GetInteger(parser->elemParser, id),0,res->place);
+}
+
+void FloatConstant(MYLParser *parser, Expval *res, int id)
+{
+	res->codebegin=CurrentIP;
+	res->nolist=1;
+	res->place=newtemp();
+	res->type=T_FLOAT;
+	fGenCode(MOV|FLAG1,GetFloat(parser->elemParser, id),0.0,res->place);
+}
+
+void StringConstant(MYLParser *parser, Expval *res, int id)
+{
+	int temp;
+	res->codebegin=CurrentIP;
+	res->nolist=1;
+	temp=newmem();
+	PrepareMem(temp);
+	SetMemStr(temp, GetString(parser->elemParser, id));
+	res->place=newtemp();
+	res->type=T_STRING;
+	iGenCode(MOV,temp,0,res->place);
+}
+
+void PreIncDec(MYLParser *parser, Expval *res, int op, const Varval *lres)
+{
+	res->codebegin=CurrentIP;
+	res->type=lres->type;
+	res->nolist=1;
+	res->place=newtemp();
+	if (lres->type==T_INTEGER)
+		iGenCode(OprCode(op),0,0,GetVar(lres->var));
+	else if (lres->type==T_FLOAT)
+		fGenCode(OprCode(op),0.0,0.0,GetVar(lres->var));
+	else {
+		CompileError(parser, "Data mismatch.");
+	}
+	iGenCode(MOV,GetVar(lres->var),0,res->place);
+}
+
+void PostIncDec(MYLParser *parser, Expval *res, const Varval *lres, int op)
+{
+	res->codebegin=CurrentIP;
+	res->type=lres->type;
+	res->nolist=1;
+	res->place=newtemp();
+	if (lres->type==T_INTEGER) {
+		iGenCode(MOV,GetVar(lres->var),0,res->place);
+		iGenCode(OprCode(op),0,0,GetVar(lres->var));
+	}
+	else if (lres->type==T_FLOAT) {
+		iGenCode(MOV,GetVar(lres->var),0,res->place);
+		fGenCode(OprCode(op),0.0,0.0,GetVar(lres->var));
+	}
+	else {
+		CompileError(parser, "Data mismatch.");
+	}
+}
+
+void VarFactor(MYLParser *parser, Expval *res, int name)
+{
+	int var_index;
+	res->codebegin=CurrentIP;
+	res->nolist=1;
+	res->place=newtemp();
+	var_index=SearchVar(name);
+	if (!var_index) {
+		CompileError(parser, "Unknown variable.");
+	}
+	res->type=GetVarType(var_index);
+	iGenCode(MOV,GetVar(var_index),0,res->place);
+}
+
+static void CallUserFunction(MYLParser *parser, Expval *res, int name, const Paraval *params)
+/* CALLU copies the params into the frame of the function, which converts
+ * the numbers to the types of its params */
+{
+	Funclistitem *pfunc=SearchFunc(name);
+	const Varlistitem *param;
+	int i;
+
+	if (!pfunc) CompileError(parser, "Unknown function.");
+	if (params->paracnt!=pfunc->paracnt) CompileError(parser, "Wrong number of parameters.");
+	for (i=0, param=pfunc->params; i<params->paracnt; i++, param=param->next) {
+		if (!Convertible(ParamType[params->base+i], param->type))
+			CompileError(parser, "Data mismatch.");
+	}
+	res->type=pfunc->type;
+	FoldParams(params, 0);
+	res->place=newtemp();
+	LastCall=CurrentIP;
+	iGenCode(CALLU|FLAG1|FLAG2,pfunc->entry,params->paracnt,res->place);
+	for (i=0; i<params->paracnt; i++) GenCode(&ParamArg[params->base+i]);
+}
+
+void CallFunction(MYLParser *parser, Expval *res, int name, const Paraval *params)
+/* The CALL is followed by an ARG for each param, the builtin reads their
+ * places so nothing is pushed. An intrinsic takes the places itself. The
+ * params loaded last are read from where they were loaded. */
+{
+	int func_index, op, i;
+	Instruction *arg=&ParamArg[params->base];
+	res->codebegin=params->codebegin;
+	res->nolist=1;
+	func_index = FuncMap(GetIdent(parser->elemParser, name));
+	if (func_index == UNKNOWN) {
+		CallUserFunction(parser, res, name, params);
+		return;
+	}
+	res->type=Function[func_index].retval;
+	op=Function[func_index].intrinsic;
+	if (params->paracnt!=Function[func_index].paramcnt) op=0;
+	FoldParams(params, op);
+	res->place=newtemp();
+	if (op) {
+		iGenCode(op|FLFLAG,arg[0].src1.i,
+			params->paracnt>1 ? arg[1].src1.i : 0,res->place);
+		return;
+	}
+	iGenCode(CALL|FLAG1|FLAG2,
+		func_index,params->paracnt,res->place);
+	for (i=0; i<params->paracnt; i++) GenCode(&arg[i]);
+}
+
+void NoParameter(Paraval *res)
+{
+	res->codebegin=CurrentIP;
+	res->paracnt=0;
+	res->base=ParamTop;
+}
+
+void PushParameter(Paraval *res, const Paraval *list, Expval *exp)
+/* list is NULL for the first parameter, the place is kept until the call */
+{
+	res->codebegin=list ? list->codebegin : exp->codebegin;
+	res->paracnt=list ? list->paracnt+1 : 1;
+	res->base=list ? list->base : ParamTop;
+	makevalue(exp);
+	ParamCode[ParamTop]=exp->codebegin;
+	ParamType[ParamTop]=exp->type;
+	ParamArg[ParamTop].op=ARG;
+	ParamArg[ParamTop].dest=-1;
+	ParamArg[ParamTop].src1.i=exp->place;
+	ParamArg[ParamTop++].src2.i=0;
+}
+
+static int JumpCode(int op)
+/* The jump for a compare opcode, -1 for another opcode */
+{
+	switch (op & OPMASK) {
+	case NOTEQU:	return JNE;
+	case EQU:		return JE;
+	case LESS:		return JL;
+	case LE:		return JLE;
+	case GREAT:		return JG;
+	case GE:		return JGE;
+	}
+	return -1;
+}
+
+static int CompareCode(int op)
+/* The compare for a jump opcode, -1 for another opcode */
+{
+	switch (op & OPMASK) {
+	case JNE:	return NOTEQU;
+	case JE:	return EQU;
+	case JL:	return LESS;
+	case JLE:	return LE;
+	case JG:	return GREAT;
+	case JGE:	return GE;
+	}
+	return -1;
+}
+
+static int LastCompare(const Expval *pval)
+/* Whether the value was just computed by a compare */
+{
+	return CurrentIP>0 && JumpCode(VMCode[CurrentIP-1].op)!=-1
+		&& VMCode[CurrentIP-1].dest==pval->place;
+}
+
+static void makelist(MYLParser *parser, Expval *pval)
+{
+	if (pval->nolist && LastCompare(pval)) {
+		/* Jump on the compare itself instead of its result */
+		Instruction *inst=&VMCode[CurrentIP-1];
+		inst->op=(inst->op & ~OPMASK)|JumpCode(inst->op)|FLAG3;
+		inst->dest=CODESIZE;
+		pval->truelist=CurrentIP-1;
+		pval->falselist=CurrentIP;
+		iGenCode(JMP|FLAG3,0,0,CODESIZE);
+		freetemp(pval->place);
+	}
+	else if (pval->nolist) {
+		pval->truelist=CurrentIP;
+		if (pval->type==T_INTEGER)
+			iGenCode(JNE|FLAG2|FLAG3,pval->place,0,CODESIZE);
+		else if (pval->type==T_FLOAT) {
+			Code.op=JNE|FLAG2|FLAG3;
+			Code.src1.i=pval->place;
+			Code.src2.f=0.0;
+			Code.dest=CODESIZE;
+			GenCode(&Code);
+		}
+		else if (pval->type==T_STRING) {
+			CompileError(parser, "Internal error");
+		}
+		pval->falselist=CurrentIP;
+		iGenCode(JMP|FLAG3,0,0,CODESIZE);
+		freetemp(pval->place);
+	}
+}
+
+static void makevalue(Expval *pval)
+{
+	if (!pval->nolist) {
+		pval->place=newtemp();
+		backpatch(pval->truelist, CurrentIP);
+		iGenCode(MOV|FLAG1,1,0,pval->place);
+		iGenCode(JMP|FLAG3,0,0,CurrentIP+2);
+		backpatch(pval->falselist, CurrentIP);
+		iGenCode(MOV|FLAG1,0,0,pval->place);
+	}
+}
+
+static void PushCase(MYLParser *parser, int type)
+{
+	CaseStack *nnode;
+	nnode=(CaseStack *)ArenaAlloc(parser->arena, sizeof(CaseStack));
+	nnode->list.name=0;
+	nnode->list.addr=CODESIZE;
+	nnode->list.type=type;
+	nnode->list.next=0;
+	nnode->tail=&nnode->list;
+	nnode->hash=0;
+	nnode->hashsize=nnode->count=0;
+	nnode->next=0;
+	nnode->prev=CaseTop;
+	CaseTop->next=nnode;
+	CaseTop=nnode;
+}
+
+static void PopCase()
+/* The case list stays in the arena until the compilation ends */
+{
+	CaseTop=CaseTop->prev;
+#ifdef _DEBUG
+	if (!CaseTop) printf("Error when pop case\n");
+#endif
+}
+
+static unsigned CaseHash(int type, int data, int size)
+{
+	return ((unsigned)data*31+(unsigned)type)%(unsigned)size;
+}
+
+static int SearchCase(int type, int data)
+{
+	Caselistitem *plist;
+	if (!CaseTop->hashsize) return 0;
+	plist=CaseTop->hash[CaseHash(type, data, CaseTop->hashsize)];
+	for (; plist; plist=plist->hashnext) {
+		if (plist->type==type&&plist->name==data) return 1;
+	}
+	return 0;
+}
+
+static int CurrentCase()
+{
+	if (CaseTop->prev) {
+		Caselistitem *plist=&(CaseTop->list);
+		return plist->type;
+	}
+	else return T_NULL;
+}
+
+static int RegCase(MYLParser *parser, int type, int cnt_id, int addr)
+/* The hash doubles when it is full, the list keeps the order */
+{
+	Caselistitem *nnode, *plist;
+	unsigned h;
+	nnode=(Caselistitem*)ArenaAlloc(parser->arena, sizeof(Caselistitem));
+	nnode->name=cnt_id;
+	nnode->addr=addr;
+	nnode->type=type;
+	nnode->next=0;
+	CaseTop->tail->next=nnode;
+	CaseTop->tail=nnode;
+	if (CaseTop->count>=CaseTop->hashsize) {
+		CaseTop->hashsize=CaseTop->hashsize ? CaseTop->hashsize*2 : 16;
+		CaseTop->hash=(Caselistitem **)ArenaAlloc(parser->arena,
+			CaseTop->hashsize*sizeof(Caselistitem *));
+		memset(CaseTop->hash, 0, CaseTop->hashsize*sizeof(Caselistitem *));
+		for (plist=CaseTop->list.next; plist!=nnode; plist=plist->next) {
+			h=CaseHash(plist->type, plist->name, CaseTop->hashsize);
+			plist->hashnext=CaseTop->hash[h];
+			CaseTop->hash[h]=plist;
+		}
+	}
+	h=CaseHash(type, cnt_id, CaseTop->hashsize);
+	nnode->hashnext=CaseTop->hash[h];
+	CaseTop->hash[h]=nnode;
+	return ++CaseTop->count;
+}
+
+static Labellistitem *SearchLabel(int name)
+{
+	Labellistitem *plabel=LabelList;
+	while (plabel->next) {
+		plabel=plabel->next;
+		if (plabel->name==name) return plabel;
+	}
+	return 0;
+}
+
+/* A goto can't leave or enter a function, its label is in the same one */
+static void CheckLabels(MYLParser *parser)
+{
+	Labellistitem *plabel;
+
+	for (plabel=LabelList->next; plabel; plabel=plabel->next) {
+		if (plabel->addr==CODESIZE) CompileError(parser, "Undefined label.");
+	}
+}
+
+static Labellistitem *NewLabel(MYLParser *parser, int name)
+{
+	Labellistitem *plabel=LabelList,
+		*nnode=(Labellistitem*)ArenaAlloc(parser->arena, sizeof(Labellistitem));
+	nnode->name=name;
+	nnode->next=0;
+	while (plabel->next) {
+		plabel=plabel->next;
+	}
+	plabel->next=nnode;
+	return nnode;
+}
+
+static int NewVar(MYLParser *parser, int name, int type)
+{
+	int i=0;
+	Varlistitem *pnode=&Varlist,*nnode;
+	while (pnode->next) {
+		i++;
+		pnode=pnode->next;
+	}
+	nnode=(Varlistitem*)ArenaAlloc(parser->arena, sizeof(Varlistitem));
+	nnode->addr=newtemp();
+	nnode->flag=0;
+	nnode->name=name;
+	nnode->next=0;
+	nnode->type=type;
+	pnode->next=nnode;
+	return i+1;
+}
+
+static int SearchVar(int name)
+{
+	int i=0;
+	Varlistitem *pnode=&Varlist;
+	while (pnode->next) {
+		i++;
+		pnode=pnode->next;
+		if (pnode->name==name) return i;
+	}
+	return 0;
+}
+static Funclistitem *SearchFunc(int name)
+{
+	Funclistitem *pfunc=&Funclist;
+	while (pfunc->next) {
+		pfunc=pfunc->next;
+		if (pfunc->name==name) return pfunc;
+	}
+	return 0;
+}
+
+static int GetVarType(int varid)
+{
+	Varlistitem *pnode=&Varlist;
+	if (!varid) {
+		printf("Variable undefined.\n");
+		exit(1);
+	}
+	while (varid-->0) pnode=pnode->next;
+	return pnode->type;
+}
+
+#if 0
+static void SetVarType(int varid, int type)
+{
+	Varlistitem *pnode=&Varlist;
+	while (varid-->0) pnode=pnode->next;
+	pnode->type=type;
+}
+#endif
+
+static void SetVarFlag(int varid, int flag)
+{
+	Varlistitem *pnode=&Varlist;
+	while (varid-->0) pnode=pnode->next;
+	pnode->flag=1;
+}
+
+#if 0
+static int GetVarFlag(int varid)
+{
+	Varlistitem *pnode=&Varlist;
+	while (varid-->0) pnode=pnode->next;
+	return pnode->flag;
+}
+#endif
+
+static int GetVar(int varid)
+{
+	Varlistitem *pnode=&Varlist;
+	if (!varid) {
+		printf("Variable undefined.\n");
+		exit(1);
+	}
+	while (varid-->0) pnode=pnode->next;
+	return pnode->addr;
+}
+
+static int IsVar(int addr, int type)
+{
+	Varlistitem *pnode=&Varlist;
+	while (pnode->next) {
+		pnode=pnode->next;
+		if (pnode->addr==addr) return type==T_NULL || pnode->type==type;
+	}
+	return 0;
+}
+
+/* A for loop that compares an integer variable with an integer constant
+ * or variable, and steps it by a constant with ++, --, += or -=. Neither
+ * may be assigned in the body, which must be entered from the test only.
+ * Returns the step and the test on the variable, or 0. */
+static int CountedLoop(const Expval *cond, const Intval *act,
+	const Intval *body, Instruction *test)
+{
+	const Instruction *load=&VMCode[cond->codebegin];
+	const Instruction *bound=load+1, *jump=load+2;
+	int var=load->src1.i, step=0, value, addr;
+
+	if (act->codebegin-cond->codebegin!=4 || body->codebegin-act->codebegin<3)
+		return 0;
+	if (load->op!=MOV || !IsVar(var, T_INTEGER)) return 0;
+	switch (jump->op) {
+	case JG|FLAG3:
+	case JL|FLAG3:
+	case JLE|FLAG3:
+	case JGE|FLAG3:
+		break;
+	default:
+		return 0;
+	}
+	if (jump->src1.i!=load->dest || jump->src2.i!=bound->dest) return 0;
+	*test=*jump;
+	test->src1.i=var;
+	if (bound->op==(MOV|FLAG1)) {
+		test->op|=FLAG2;
+		test->src2.i=bound->src1.i;
+	}
+	else if (bound->op==MOV && IsVar(bound->src1.i, T_INTEGER))
+		test->src2.i=bound->src1.i;
+	else return 0;
+
+	/* The last one is the jump back to the condition */
+	for (addr=act->codebegin; addr<body->codebegin-1; addr++) {
+		const Instruction *inst=&VMCode[addr];
+		if (inst->dest!=var) {
+			if ((inst->op&~FLAG1)!=MOV || IsVar(inst->dest, T_NULL)) return 0;
+			continue;
+		}
+		if (step) return 0;
+		switch (inst->op) {
+		case INC:
+			step=1;
+			break;
+		case DEC:
+			step=-1;
+			break;
+		case ADD:
+		case SUB:
+			if (inst->src1.i!=var
+				|| !LoadedConstant(act->codebegin, addr, inst->src2.i, &value)
+				|| value==INT_MIN)
+				return 0;
+			step=inst->op==ADD ? value : -value;
+			break;
+		default:
+			return 0;
+		}
+	}
+	if (Assigns(body->codebegin, CurrentIP, var)
+		|| (!(test->op&FLAG2) && Assigns(body->codebegin, CurrentIP, test->src2.i))
+		|| Entered(body->codebegin, CurrentIP))
+		return 0;
+	return step;
+}
+
+/* The integer that the code from begin to end leaves in addr */
+static int LoadedConstant(int begin, int end, int addr, int *value)
+{
+	while (--end>=begin) {
+		if (VMCode[end].dest==addr) {
+			*value=VMCode[end].src1.i;
+			return VMCode[end].op==(MOV|FLAG1);
+		}
+	}
+	return 0;
+}
+
+static int Assigns(int begin, int end, int addr)
+{
+	for (; begin<end; begin++) {
+		switch (VMCode[begin].op & OPMASK) {
+		case ARG:
+		case JMP:
+		case RET:
+		case JE:
+		case JNE:
+		case JG:
+		case JL:
+		case JLE:
+		case JGE:
+			break;
+		default:
+			if (VMCode[begin].dest==addr) return 1;
+		}
+	}
+	return 0;
+}
+
+/* Whether a label or a case of an open switch is in the code */
+static int Entered(int begin, int end)
+{
+	Labellistitem *label;
+	CaseStack *cases;
+	Caselistitem *item;
+
+	for (label=LabelList->next; label; label=label->next) {
+		if (label->addr>=begin && label->addr<end) return 1;
+	}
+	for (cases=CaseTop; cases; cases=cases->prev) {
+		for (item=cases->list.next; item; item=item->next) {
+			if (item->addr>=begin && item->addr<end) return 1;
+		}
+	}
+	return 0;
+}
+
+/* The counter instruction, its test and the jump out of the loop */
+static void SetForCode(int addr, int op, int step, const Instruction *test)
+{
+	VMCode[addr].op=op;
+	VMCode[addr].src1.i=test->src1.i;
+	VMCode[addr].src2.i=step;
+	VMCode[addr].dest=test->src1.i;
+	VMCode[addr+1]=*test;
+	VMCode[addr+2].op=JMP|FLAG3;
+	VMCode[addr+2].src1.i=VMCode[addr+2].src2.i=0;
+	VMCode[addr+2].dest=CODESIZE;
+}
+
+/* A ?: on one compare whose sides only load a variable or a constant
+ * computes the compare and picks a side with CMOV, neither load can
+ * fail. Returns the place of the value, -1 to keep the jumps. */
+static int MakeSelect(const Expval *sel, const Expval *colon, const Expval *exp)
+{
+	int test=colon->codebegin-2, op, flags, place;
+	const Instruction *load1=&VMCode[test+2], *load2=&VMCode[test+4];
+
+	if (test<0 || sel->truelist!=test || VMCode[test].dest!=CODESIZE
+		|| sel->falselist!=test+1 || VMCode[test+1].dest!=CODESIZE
+		|| colon->truelist!=test+3
+		|| exp->codebegin!=test+4 || CurrentIP!=test+5
+		|| (op=CompareCode(VMCode[test].op))==-1
+		|| !IsLoad(load1, colon->place) || !IsLoad(load2, exp->place))
+		return -1;
+	flags=(load1->op&FLAG1 ? load1->op&(FLAG1|FLFLAG) : 0)
+		|(load2->op&FLAG1 ? FLAG2|(load2->op&FLFLAG) : 0);
+	if ((flags&(FLAG1|FLAG2))==(FLAG1|FLAG2)
+		&& (load1->op&FLFLAG)!=(load2->op&FLFLAG))
+		return -1;
+	place=newtemp();
+	VMCode[test].op=(VMCode[test].op&~(OPMASK|FLAG3))|op;
+	VMCode[test].dest=place;
+	VMCode[test+1].op=CMOV|flags;
+	VMCode[test+1].src1=load1->src1;
+	VMCode[test+1].src2=load2->src1;
+	VMCode[test+1].dest=place;
+	CurrentIP=test+2;
+	return place;
+}
+
+/* The places of the params are freed, and those loaded last are read
+ * from where they were loaded, but for the immediates if noimm */
+static void FoldParams(const Paraval *params, int noimm)
+{
+	Instruction *arg=&ParamArg[params->base], *load;
+	int i;
+
+	for (i=0; i<params->paracnt; i++) freetemp(arg[i].src1.i);
+	for (i=params->paracnt-1; i>=0; i--) {
+		load=&VMCode[CurrentIP-1];
+		if (ParamCode[params->base+i]!=CurrentIP-1 || !IsLoad(load, arg[i].src1.i)
+			|| (noimm && (load->op&FLAG1)))
+			break;
+		arg[i].op|=load->op&(FLAG1|FLFLAG);
+		arg[i].src1=load->src1;
+		CurrentIP--;
+	}
+	ParamTop=params->base;
+}
+
+/* Numbers convert to each other, a string is only a string */
+static int Convertible(int from, int to)
+{
+	if (from==T_LIST || to==T_LIST) return 0;
+	return (from==T_STRING)==(to==T_STRING);
+}
+
+/* A call of the function itself that is returned is a tail call: its
+ * args are copied to the params, a param read by an arg after it was
+ * copied to is put aside first, and it jumps back to the body. The args
+ * of the call are still in ParamArg. */
+static int TailCall(const Expval *exp)
+{
+	const Instruction *call;
+	Instruction *arg=&ParamArg[ParamTop];
+	const int *type=&ParamType[ParamTop];
+	const Varlistitem *param, *read;
+	int argc, i, j, mem;
+
+	if (LastCall<0 || !exp->nolist) return 0;
+	call=&VMCode[LastCall];
+	if ((call->op&OPMASK)!=CALLU
+		|| call->src1.i!=CurFunc->entry || call->dest!=exp->place
+		|| LastCall+1+call->src2.i!=CurrentIP)
+		return 0;
+	argc=call->src2.i;
+	CurrentIP=LastCall;
+	LastCall=-1;
+	freetemp(exp->place);
+	/* The temporary places of the args are kept until they are read */
+	for (i=0; i<argc; i++) {
+		mem=arg[i].src1.i;
+		if (!(arg[i].op&FLAG1) && mem<HEAPSTART && !IsVar(mem, T_NULL)) memmap[mem]=1;
+	}
+	for (i=0; i<argc; i++) {
+		if (arg[i].op&FLAG1) continue;
+		for (j=0, read=CurFunc->params; j<i; j++, read=read->next) {
+			if (read->addr!=arg[i].src1.i) continue;
+			mem=newtemp();
+			iGenCode(MOV,read->addr,0,mem);
+			arg[i].src1.i=mem;
+			break;
+		}
+	}
+	for (i=0, param=CurFunc->params; i<argc; i++, param=param->next) {
+		Code=arg[i];
+		Code.dest=param->addr;
+		Code.src2.i=0;
+		if (type[i]==param->type || param->type==T_STRING)
+			Code.op=MOV|(arg[i].op&(FLAG1|FLFLAG));
+		else Code.op=CNV|(arg[i].op&FLAG1)|(type[i]==T_FLOAT ? FLFLAG : 0);
+		if (Code.op!=MOV || Code.src1.i!=Code.dest) GenCode(&Code);
+	}
+	for (i=0; i<argc; i++) {
+		mem=arg[i].src1.i;
+		if (!(arg[i].op&FLAG1) && mem<HEAPSTART && !IsVar(mem, T_NULL)) freetemp(mem);
+	}
+	iGenCode(JMP|FLAG3,0,0,CurFunc->body);
+	return 1;
+}
+
+/* A MOV of a constant or a variable to the temporary place */
+static int IsLoad(const Instruction *inst, int place)
+{
+	if ((inst->op&~(FLAG1|FLFLAG))!=MOV || inst->dest!=place || IsVar(place, T_NULL))
+		return 0;
+	return (inst->op&FLAG1) || inst->src1.i>=HEAPSTART || IsVar(inst->src1.i, T_NULL);
+}
+
+static void backpatch(int i,int addr)
+{
+	while (i!=CODESIZE) {
+		int temp;
+		temp=VMCode[i].dest;
+		VMCode[i].dest=addr;
+		i=temp;
+	}
+}
+
+static int merge(int a1, int a2)
+{
+	if (a2!=CODESIZE) {
+		while (VMCode[a2].dest!=CODESIZE)
+			a2=VMCode[a2].dest;
+		VMCode[a2].dest=a1;
+		return a2;
+	}
+	else return a1;
+}
+
+static void CheckCodeSize()
+{
+	if (CurrentIP>=CODESIZE) {
+		printf("Program too large.\n");
+		exit(1);
+	}
+}
+
+static void GenCode(const Instruction *inst)
+{
+	CheckCodeSize();
+	VMCode[CurrentIP]=*inst;
+	CurrentIP++;
+}
+
+static void fGenCode(int op, float src1, float src2, int dest)
+{
+	CheckCodeSize();
+	VMCode[CurrentIP].op=op|FLFLAG;
+	VMCode[CurrentIP].src1.f=src1;
+	VMCode[CurrentIP].src2.f=src2;
+	VMCode[CurrentIP].dest=dest;
+	CurrentIP++;
+}
+static void iGenCode(int op, int src1, int src2, int dest)
+{
+	CheckCodeSize();
+	VMCode[CurrentIP].op=op;
+	VMCode[CurrentIP].src1.i=src1;
+	VMCode[CurrentIP].src2.i=src2;
+	VMCode[CurrentIP].dest=dest;
+	CurrentIP++;
+}
+
+static int FuncMap(const char *name)
+{
+	int i;
+
+	for (i = 0; i < FuncCount; i++) {
+		if (!strcmp(Function[i].funcname, name)) return i;
+	}
+	return UNKNOWN;
+}
+
+static int OprCode(int i)
+{
+	static const int xtable[]={
+		-1, ADD, SUB, SHL, SHR, XOR, MUL, DIV,
+		MOD, OR, AND, -1, -1, -1, -1, -1, OR,
+		AND, NOTEQU, EQU, LESS, LE, GREAT, GE, SHL, SHR,
+		ADD, SUB, MUL, DIV, MOD, NOT, INC, DEC,
+		-1, -1, -1, -1, -1, -1, -1};
+	return xtable[i];
+}
+
+static int newmem()
+{
+	int mem=HEAPSTART;
+	while (mem<STACKSIZE && memmap[mem]) mem++;
+	if (mem>=STACKSIZE) {
+		printf("Out of constant memory.\n");
+		exit(1);
+	}
+	memmap[mem]=1;
+	if (mem>=HeapTop) HeapTop=mem+1;
+	return mem;
+}
+
+static int newtemp()
+/* A function takes its slots from FrameBase on */
+{
+	int mem=FrameBase;
+	while (mem<HEAPSTART && memmap[mem]) mem++;
+	if (mem>=HEAPSTART) {
+		printf("Out of variable memory.\n");
+		exit(1);
+	}
+	memmap[mem]=1;
+	if (mem>=FrameTop) FrameTop=mem+1;
+	return mem;
+}
+
+static void freetemp(int addr)
+{
+	if (addr!=-1)
+		memmap[addr]=0;
+}
+
+int NextToken(MYLParser *parser, Element *elem)
+{
+	if (GetElement(parser->elemParser, elem)==EOF) return TK_EOF;
+	if (elem->type==INTEGER) return TK_CNTINT;
+	if (elem->type==C_FLOAT) return TK_FLT;
+	if (elem->type==STRING)	return TK_STR;
+	if (elem->type==IDENTIFIER) return TK_IDENT;
+	if (elem->type==KEYWORD) {
+		if (elem->id+TK_KEYIF<TK_KEYTYPE)
+			return elem->id+TK_KEYIF;
+		else return TK_KEYTYPE;
+	}
+	if (elem->type==SYMBOL) {
+		if (elem->id<=S_ANDSET) return TK_SETOPS;
+		if (elem->id==S_LBRACKET) return TK_LBRACKET;
+		if (elem->id==S_RBRACKET) return TK_RBRACKET;
+		if (elem->id==S_LPARA) return TK_LPARA;
+		if (elem->id==S_RPARA) return TK_RPARA;
+		if (elem->id==S_COMMA) return TK_COMMA;
+		if (elem->id==S_SEMICOLON) return TK_SEMICOLON;
+		if (elem->id==S_LOGOR) return TK_BOOLOR;
+		if (elem->id==S_LOGAND) return TK_BOOLAND;
+		if (elem->id==S_LOGNOT) return TK_BOOLNOT;
+		if (elem->id>=S_NOTEQU && elem->id<=S_GE) return TK_BOOLOPS;
+		if (elem->id==S_ADD||elem->id==S_SUB) return TK_ADDOPS;
+		if (elem->id==S_LSHIFT||elem->id==S_RSHIFT) return TK_SHIFTOPS;
+		if (elem->id==S_BITOR||elem->id==S_BITAND||elem->id==S_BITXOR) return TK_BITOPS;
+		if (elem->id==S_NOT) return TK_BITNOT;
+		if (elem->id==S_MUL||elem->id==S_DIV||elem->id==S_MOD) return TK_MULOPS;
+		if (elem->id==S_INC) return TK_INCOPS;
+		if (elem->id==S_DEC) return TK_DECOPS;
+		if (elem->id==S_SELECT) return TK_SELECT;
+		if (elem->id==S_COLON) return TK_COLON;
+	}
+	CompileError(parser, "LEX error");
+	return TK_EOF;
+}
+
+void CompileError(MYLParser *parser, const char *s)
+{
+	InputStream *stream = parser->stream;
+	if (parser->errline>=0)
+		fprintf(stderr, "(Line:%3d,Column:%3d)%s\n", parser->errline, parser->errcol, s);
+	else
+		fprintf(stderr, "(Line:%3d,Column:%3d)%s\n", stream->curLine(stream), stream->curCol(stream),s);
+	exit(0);
+}
+
+int Compile(MYLParser *parser)
+/* A profile is of the parser's code, which is left as it is to take one */
+{
+	Profile *profile=0;
+	int size;
+
+	BeginUnit(parser);
+	ResetVM();
+	if (parser->frontend==MYL_PARSER_RD) RDParse(parser);
+	else YaccParse(parser);
+	parser->parsedsize = CurrentIP;
+	if (parser->profileout) return CurrentIP;
+	if (parser->profilein && parser->optlevel)
+		profile = ReadProfile(parser->profilein, VMCode, CurrentIP);
+	size = OptimizeCode(parser->arena, VMCode, CurrentIP, parser->optlevel,
+		parser->unroll, profile);
+	CloseProfile(profile);
+	return size;
+}
+
+/* Also called at exit, when the program stopped on an error */
+static void SaveProfile()
+{
+	if (!OutProfile) return;
+	WriteProfile(OutProfile, OutProfilePath);
+	CloseProfile(OutProfile);
+	OutProfile = 0;
+}
+
+void Process(MYLParser *parser)
+{
+	int i, size;
+	long steps;
+	FILE *fdump;
+
+	size = Compile(parser);
+
+	// dump VM
+	fdump = fopen("out.asm", "w");
+	for (i = 0; i<size; i++)
+		PrintDisasm(fdump, i, &VMCode[i]);
+	fprintf(fdump, "\nDumping memory:\n");
+	for (i=0; i<STACKSIZE; i++) {
+		switch (VMStack[i].tag) {
+		case T_INTEGER:
+			fprintf(fdump, "Memory[0x%4.4X]:%i\n", i, VMMEM(i).i);
+			break;
+		case T_FLOAT:
+			fprintf(fdump, "Memory[0x%4.4X]:%f\n", i, VMMEM(i).f);
+			break;
+		case T_STRING:
+			fprintf(fdump, "Memory[0x%4.4X]:%s\n", i, VMMEM(i).str->c_str());
+			break;
+		}
+	}
+	fclose(fdump);
+
+	// run VM
+	if (parser->profileout) {
+		OutProfile = CreateProfile(VMCode, size);
+		if (!OutProfile) {
+			printf("Out of memory.\n");
+			exit(1);
+		}
+		OutProfilePath = parser->profileout;
+		atexit(SaveProfile);
+		steps = RunProfile(0, OutProfile->count, OutProfile->taken);
+		SaveProfile();
+	}
+	else if (!parser->stats) {
+		Run(0);
+		return;
+	}
+	else {
+		IP = 0;
+		for (steps = 1; Step(); steps++);
+	}
+	if (!parser->stats) return;
+	fflush(stdout);
+	fprintf(stderr, "code: %d instructions, %d optimized, %ld executed\n",
+		parser->parsedsize, size, steps);
+}
@@ -0,0 +1,142 @@
+/* codegen.h - Code generation shared by the parsers
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CODEGEN_H
+#define __CODEGEN_H
+
+#include "myl_internal.h"
+#include "element.h"
+
+/* Both gram.y and the hand-written parser in rdparse.cpp generate code
+ * through the functions below, which are named after the grammar rules.
+ * A parser calls them in the order an LR parser reduces the rules, so
+ * both produce the same VMCode. The result never aliases an operand. */
+
+typedef struct Expval {
+	int codebegin;
+	int place;
+	int truelist, falselist;
+	int nolist;
+	int type;				/* Type of the expression */
+} Expval;
+
+typedef struct Intval {
+	int codebegin;
+	int chain;
+	int breakchain;
+	int paracnt;
+} Intval;
+
+typedef struct Paraval {
+	int codebegin;
+	int paracnt;
+	int base;		/* of its places in the param stack */
+} Paraval;
+
+typedef struct Varval {
+	int var;
+	int type;
+} Varval;
+
+/* Tokens, in the order of the %token list of gram.y */
+enum {
+	TK_EOF,
+	TK_CNTINT, TK_FLT, TK_STR, TK_IDENT,
+	TK_KEYIF, TK_KEYELSE, TK_KEYFOR, TK_KEYWHILE, TK_KEYDO, TK_KEYCONT,
+	TK_KEYBREAK, TK_KEYSWITCH, TK_KEYCASE, TK_KEYDEFAULT, TK_KEYGOTO,
+	TK_KEYRETURN, TK_KEYTYPE,
+	TK_SEMICOLON, TK_LBRACKET, TK_RBRACKET, TK_LPARA, TK_RPARA,
+	TK_SELECT, TK_COLON, TK_BOOLOR, TK_BOOLAND, TK_INCOPS, TK_DECOPS,
+	TK_SETOPS, TK_COMMA, TK_BOOLOPS, TK_BITOPS, TK_SHIFTOPS, TK_ADDOPS,
+	TK_MULOPS, TK_BOOLNOT, TK_BITNOT
+};
+
+extern int CurrentIP;
+
+/* Read the next token, TK_EOF at the end of the stream */
+int NextToken(MYLParser *parser, Element *elem);
+void CompileError(MYLParser *parser, const char *s);
+
+/* Parsers, return 0 on success */
+int YaccParse(MYLParser *parser);
+int RDParse(MYLParser *parser);
+
+/* Compilation unit */
+void BeginUnit(MYLParser *parser);
+void EndUnit(MYLParser *parser, const Intval *myl);
+
+/* Statements */
+void JoinStatements(Intval *res, const Intval *first, const Intval *next);
+void EmptyStatement(Intval *res);
+void ExprStatement(Intval *res, const Expval *exp);
+void ContinueStatement(MYLParser *parser, Intval *res);
+void BreakStatement(MYLParser *parser, Intval *res);
+void GotoStatement(MYLParser *parser, Intval *res, int name);
+void DeclareVar(MYLParser *parser, int name, int type);
+void DefineLabel(MYLParser *parser, int name);
+void DefineCase(MYLParser *parser, int type, int cnt_id);
+void DefineDefault(MYLParser *parser);
+void BeginIf(MYLParser *parser, Intval *res, Expval *cond);
+void BeginElse(Intval *res, const Intval *ifpre, const Intval *body);
+void EndIf(Intval *res, const Intval *pre, const Intval *body);
+void BeginWhile(MYLParser *parser, Intval *res, Expval *cond);
+void EndWhile(Intval *res, const Intval *pre, const Intval *body);
+void BeginDo(MYLParser *parser);
+void EndDoWhile(MYLParser *parser, Intval *res, const Intval *body, Expval *cond);
+void ForInit(Intval *res, const Expval *init);
+void ForCondition(MYLParser *parser, Expval *res, Expval *cond);
+void ForAction(MYLParser *parser, Intval *res, const Expval *act);
+void EndFor(MYLParser *parser, Intval *res, const Intval *init,
+	const Expval *cond, const Intval *act, const Intval *body);
+void BeginSwitch(MYLParser *parser, Expval *res, Expval *exp);
+void EndSwitch(MYLParser *parser, Intval *res, const Expval *pre, const Intval *body);
+void BeginFunction(MYLParser *parser, Intval *res, const Expval *pre, int name);
+void DeclareParam(MYLParser *parser, int type, int name);
+void EndFunction(MYLParser *parser, Intval *res, const Intval *pre, const Intval *body);
+void ReturnStatement(MYLParser *parser, Intval *res, Expval *exp);
+
+/* Expressions */
+void LValue(MYLParser *parser, Varval *res, int name);
+void Assign(MYLParser *parser, Expval *res, const Varval *lres, int op, Expval *exp);
+void BeginSelect(MYLParser *parser, Expval *res, Expval *cond);
+void SelectColon(Expval *res, Expval *exp);
+void EndSelect(MYLParser *parser, Expval *res, const Expval *sel, const Expval *colon, Expval *exp);
+void BoolOperand(MYLParser *parser, Expval *res, Expval *exp);
+void EndBoolOr(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp);
+void EndBoolAnd(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp);
+void Operand(Expval *res, Expval *exp, int op);
+void IntOperand(MYLParser *parser, Expval *res, Expval *exp, int op);
+void EndCompare(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp);
+void EndIntOp(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp);
+void EndArith(MYLParser *parser, Expval *res, const Expval *pre, Expval *exp);
+void Negate(MYLParser *parser, Expval *res, int op, Expval *exp);
+void LogicalNot(MYLParser *parser, Expval *res, Expval *exp);
+void BitwiseNot(MYLParser *parser, Expval *res, int op, Expval *exp);
+void IntConstant(MYLParser *parser, Expval *res, int id);
+void FloatConstant(MYLParser *parser, Expval *res, int id);
+void StringConstant(MYLParser *parser, Expval *res, int id);
+void PreIncDec(MYLParser *parser, Expval *res, int op, const Varval *lres);
+void PostIncDec(MYLParser *parser, Expval *res, const Varval *lres, int op);
+void VarFactor(MYLParser *parser, Expval *res, int name);
+void CallFunction(MYLParser *parser, Expval *res, int name, const Paraval *params);
+void NoParameter(Paraval *res);
+void PushParameter(Paraval *res, const Paraval *list, Expval *exp);
+
+#endif
@@ -0,0 +1,115 @@
+/* compact.cpp - Remove the unreachable code and the jumps to jumps
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Works on VMCode itself for the code the SSA form can't be built for,
+ * LowerIR leaves neither of them. The parser leaves the code after a
+ * break, continue or goto, and a jump to a jump around the else branches
+ * and in the switch dispatch. */
+
+#include "ir.h"
+
+static int IsJump(int op)
+{
+	return (op & OPMASK) == JMP || IsBranch(op & OPMASK);
+}
+
+/* The end of the chain of jumps from addr, stopping on a loop */
+static int Target(const Instruction *code, int addr, int size)
+{
+	int steps;
+
+	for (steps = 0; steps < size && (code[addr].op & OPMASK) == JMP; steps++)
+		addr = code[addr].dest;
+	return addr;
+}
+
+/* Returns the new code size, or size if a jump isn't to a known place */
+int CompactCode(Arena *arena, Instruction *code, int size)
+{
+	char *reach = NEWARRAY(arena, char, size + 1);
+	int *work = NEWARRAY(arena, int, size + 1);
+	int *pos = NEWARRAY(arena, int, size + 1);
+	int *first = NEWARRAY(arena, int, size + 1);
+	int nwork = 0, n, addr;
+
+	for (addr = 0; addr < size; addr++) {
+		if (IsJump(code[addr].op) && (!(code[addr].op & FLAG3)
+			|| code[addr].dest < 0 || code[addr].dest >= size))
+			return size;
+	}
+	for (addr = 0; addr < size; addr++) {
+		if (!IsJump(code[addr].op)) continue;
+		code[addr].dest = Target(code, code[addr].dest, size);
+		/* The jump would only return */
+		if ((code[addr].op & OPMASK) == JMP
+			&& (code[code[addr].dest].op & OPMASK) == RET)
+			code[addr] = code[code[addr].dest];
+	}
+
+	if (size) {
+		reach[0] = 1;
+		work[nwork++] = 0;
+	}
+	while (nwork) {
+		const Instruction *inst = &code[work[--nwork]];
+		int next = work[nwork] + 1;
+
+		if (IsJump(inst->op) && !reach[inst->dest]) {
+			reach[inst->dest] = 1;
+			work[nwork++] = inst->dest;
+		}
+		/* A function is reached by its calls, its ENTER is kept */
+		if ((inst->op & OPMASK) == CALLU && !reach[inst->src1.i]) {
+			reach[inst->src1.i] = 1;
+			work[nwork++] = inst->src1.i;
+		}
+		switch (inst->op & OPMASK) {
+		case JMP:
+		case RET:
+		case RETU:
+			continue;
+		}
+		if (next < size && !reach[next]) {
+			reach[next] = 1;
+			work[nwork++] = next;
+		}
+	}
+
+	/* A jump to the next instruction left is left out too */
+	first[size] = size;
+	for (addr = size - 1; addr >= 0; addr--) {
+		if (reach[addr] && (code[addr].op & OPMASK) == JMP
+			&& code[addr].dest > addr && first[code[addr].dest] == first[addr + 1])
+			reach[addr] = 0;
+		first[addr] = reach[addr] ? addr : first[addr + 1];
+	}
+	for (addr = n = 0; addr <= size; addr++) {
+		pos[addr] = n;
+		if (addr < size && reach[addr]) n++;
+	}
+	for (addr = 0; addr < size; addr++) {
+		if (!reach[addr]) continue;
+		code[pos[addr]] = code[addr];
+		if (IsJump(code[addr].op)) code[pos[addr]].dest = pos[code[addr].dest];
+		if ((code[addr].op & OPMASK) == CALLU) code[pos[addr]].src1.i = pos[code[addr].src1.i];
+		if ((code[addr].op & OPMASK) == ENTER) code[pos[addr]].dest = pos[code[addr].dest];
+	}
+	return n;
+}
@@ -0,0 +1,256 @@
+/* csvscan.c - Aggregates of a column of a CSV file
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The file is mapped and taken 64 bytes at a time: SSE2 compares them
+ * with the newline, the separator and the quote, which gives a bit mask
+ * of each. The bits of the separators are only looked at up to the
+ * column, after that the scan goes on from newline to newline. A block
+ * with a quote in it, or inside a quoted field, is taken byte by byte.
+ *
+ * A number is read as an integer of up to 19 digits and a power of 10,
+ * which is exact in a double when the digits fit 53 bits and the power
+ * is 22 or less; strtod reads the others. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "csvscan.h"
+#include "files.h"
+
+#define MAXNUMBER 128		/* longer fields aren't numbers */
+
+typedef struct Scan {
+	int col;
+	char sep;
+	int field;			/* of the line */
+	int quoted;			/* inside quotes */
+	const char *start;	/* of the field */
+	CSVStats *stats;
+} Scan;
+
+static const double Pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static int SlowNumber(const char *text, const char *end, double *value)
+{
+	char buf[MAXNUMBER];
+	char *stop;
+
+	if (end - text >= MAXNUMBER) return 0;
+	memcpy(buf, text, end - text);
+	buf[end - text] = 0;
+	*value = strtod(buf, &stop);
+	return stop == buf + (end - text);
+}
+
+int ParseNumber(const char *text, const char *end, double *value)
+{
+	const char *p, *begin;
+	unsigned long long digits = 0;
+	int ndigits = 0, exp = 0, negative = 0, any = 0, e;
+
+	while (text < end && (*text == ' ' || *text == '\t')) text++;
+	while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+	if (end - text >= 2 && *text == '"' && end[-1] == '"') {
+		text++;
+		end--;
+	}
+	begin = p = text;
+	if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+	for (; p < end && *p >= '0' && *p <= '9'; p++, any = 1) {
+		if (ndigits < 19) {
+			digits = digits * 10 + (*p - '0');
+			if (digits) ndigits++;
+		}
+		else exp++;
+	}
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++, any = 1) {
+			if (ndigits < 19) {
+				digits = digits * 10 + (*p - '0');
+				if (digits) ndigits++;
+				exp--;
+			}
+		}
+	}
+	if (!any) return 0;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		int eneg = 0;
+
+		p++;
+		if (p < end && (*p == '-' || *p == '+')) eneg = *p++ == '-';
+		if (p == end || *p < '0' || *p > '9') return 0;
+		for (e = 0; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (e < 100000) e = e * 10 + (*p - '0');
+		}
+		exp += eneg ? -e : e;
+	}
+	if (p != end) return 0;
+	if (ndigits >= 19 || digits >> 53 || exp > 22 || exp < -22)
+		return SlowNumber(begin, end, value);
+	*value = exp < 0 ? (double)digits / Pow10[-exp] : (double)digits * Pow10[exp];
+	if (negative) *value = -*value;
+	return 1;
+}
+
+/* The field from scan->start ends at end, with a newline if line */
+static void EndField(Scan *scan, const char *end, int line)
+{
+	double value;
+
+	if (scan->field == scan->col && ParseNumber(scan->start, end, &value)) {
+		CSVStats *stats = scan->stats;
+		if (!stats->count || value < stats->min) stats->min = value;
+		if (!stats->count || value > stats->max) stats->max = value;
+		stats->sum += value;
+		stats->count++;
+	}
+	scan->field = line ? 0 : scan->field + 1;
+	scan->start = end + 1;
+}
+
+static void ScanBytes(Scan *scan, const char *p, const char *end)
+{
+	for (; p < end; p++) {
+		if (*p == '"') scan->quoted = !scan->quoted;
+		else if (scan->quoted) continue;
+		else if (*p == scan->sep) EndField(scan, p, 0);
+		else if (*p == '\n') EndField(scan, p, 1);
+	}
+}
+
+#ifdef __SSE2__
+static unsigned long long Match64(const char *p, __m128i key)
+{
+	unsigned long long mask = 0;
+	int k;
+
+	for (k = 0; k < 4; k++) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(p + 16 * k));
+		mask |= (unsigned long long)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, key)) << (16 * k);
+	}
+	return mask;
+}
+#endif
+
+void CSVScan(const char *data, size_t n, int col, char sep, CSVStats *stats)
+{
+	const char *p = data, *end = data + n;
+	Scan scan;
+
+	memset(stats, 0, sizeof(CSVStats));
+	scan.col = col;
+	scan.sep = sep;
+	scan.field = 0;
+	scan.quoted = 0;
+	scan.start = data;
+	scan.stats = stats;
+#ifdef __SSE2__
+	{
+		const __m128i newline = _mm_set1_epi8('\n'), separator = _mm_set1_epi8(sep);
+		const __m128i quote = _mm_set1_epi8('"');
+
+		for (; end - p >= 64; p += 64) {
+			unsigned long long lines, seps, mask;
+			int have;
+
+			if (scan.quoted || Match64(p, quote)) {
+				ScanBytes(&scan, p, p + 64);
+				continue;
+			}
+			lines = Match64(p, newline);
+			seps = scan.field <= col ? Match64(p, separator) : 0;
+			have = scan.field <= col;
+			for (mask = lines | seps; mask; ) {
+				int bit = __builtin_ctzll(mask);
+
+				mask &= mask - 1;
+				if (!((lines >> bit) & 1)) {
+					EndField(&scan, p + bit, 0);
+					/* Past the column only the newline matters */
+					if (scan.field > col) mask &= lines;
+					continue;
+				}
+				EndField(&scan, p + bit, 1);
+				if (!have) {
+					seps = Match64(p, separator);
+					have = 1;
+				}
+				mask |= seps & ~((2ULL << bit) - 1);
+			}
+		}
+	}
+#endif
+	ScanBytes(&scan, p, end);
+	if (scan.start < end) EndField(&scan, end, 1);
+}
+
+/* st_mtime is in seconds, a file rewritten within one keeps it */
+#ifdef __APPLE__
+#define MTIME_NSEC(st) ((st).st_mtimespec.tv_nsec)
+#else
+#define MTIME_NSEC(st) ((st).st_mtim.tv_nsec)
+#endif
+
+static struct {
+	char *path;
+	int col;
+	char sep;
+	struct stat st;
+	unsigned long writes;	/* FileWrites() at the scan */
+	CSVStats stats;
+} Last;
+
+int CSVAggregate(const char *path, int col, char sep, CSVStats *stats)
+{
+	struct stat st;
+	const char *data;
+	size_t n;
+	int handle;
+
+	if (stat(path, &st)) return 0;
+	if (Last.path && !strcmp(Last.path, path) && Last.col == col && Last.sep == sep
+		&& S_ISREG(st.st_mode) && st.st_ino == Last.st.st_ino && st.st_dev == Last.st.st_dev
+		&& st.st_size == Last.st.st_size && st.st_mtime == Last.st.st_mtime
+		&& MTIME_NSEC(st) == MTIME_NSEC(Last.st) && FileWrites() == Last.writes) {
+		*stats = Last.stats;
+		return 1;
+	}
+	if ((handle = OpenFile(path, "r")) < 0) return 0;
+	data = ReadAll(handle, &n);
+	CSVScan(data, n, col, sep, stats);
+	CloseFile(handle);
+	free(Last.path);
+	Last.path = strdup(path);
+	Last.col = col;
+	Last.sep = sep;
+	Last.st = st;
+	Last.writes = FileWrites();
+	Last.stats = *stats;
+	return 1;
+}
@@ -0,0 +1,54 @@
+/* csvscan.h - Aggregates of a column of a CSV file
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CSVSCAN_H
+#define __CSVSCAN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CSVStats {
+	long count;			/* of the fields that are numbers */
+	double sum;
+	double min;			/* 0 if there are none */
+	double max;
+} CSVStats;
+
+/* Add up column col, from 0, of the lines of data split at sep. A field
+ * that isn't a number, such as that of a header, is skipped. */
+void CSVScan(const char *data, size_t n, int col, char sep, CSVStats *stats);
+
+/* The same for the file at path, the last scan is kept for the next one
+ * of the same column while the file doesn't change. 0 if it can't be
+ * read. */
+int CSVAggregate(const char *path, int col, char sep, CSVStats *stats);
+
+/* The number in the text, which is all of it but spaces and quotes
+ * around it. 0 if it isn't one. */
+int ParseNumber(const char *text, const char *end, double *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
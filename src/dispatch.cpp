@@ -0,0 +1,167 @@
+/* dispatch.cpp - Jump tables, binary search and perfect hashing for switch
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* A switch tests its cases with a chain of JE on the same slot, the
+ * first one that matches is taken. The chain becomes a JTAB when its
+ * integer keys fill at least half of their range, a JBIN on the sorted
+ * keys otherwise, and a JHASH for string keys. The JE in the tables are
+ * still tests of the chain, a key left out of a JTAB jumps on past the
+ * table.
+ *
+ * The perfect hash puts the keys in buckets by their hash and tries the
+ * seeds of the biggest bucket first until its keys land on free slots,
+ * so a string is compared once. */
+
+#include "ir.h"
+
+#define MAXSEED 4096		/* seeds tried for a bucket */
+
+typedef struct Key {
+	const Instruction *test;
+	int index;				/* in the chain, the first one is kept */
+	unsigned hash;
+} Key;
+
+static int CompareInt(const void *a, const void *b)
+{
+	const Key *ka = (const Key *)a, *kb = (const Key *)b;
+
+	if (ka->test->src2.i != kb->test->src2.i)
+		return ka->test->src2.i < kb->test->src2.i ? -1 : 1;
+	return ka->index - kb->index;
+}
+
+static int CompareString(const void *a, const void *b)
+{
+	const Key *ka = (const Key *)a, *kb = (const Key *)b;
+	int order = VMMEM(ka->test->src2.i).str->compare(*VMMEM(kb->test->src2.i).str);
+
+	return order ? order : ka->index - kb->index;
+}
+
+static int SameKey(const Key *a, const Key *b, int strings)
+{
+	if (strings) return *VMMEM(a->test->src2.i).str == *VMMEM(b->test->src2.i).str;
+	return a->test->src2.i == b->test->src2.i;
+}
+
+static void SetHeader(Instruction *inst, int op, int slot, int src2, int n)
+{
+	inst->op = op|FLAG2|FLAG3;
+	inst->src1.i = slot;
+	inst->src2.i = src2;
+	inst->dest = n;
+}
+
+/* Returns the size of the code, 0 if no seed separates the keys */
+static int PerfectHash(Arena *arena, Key *keys, int n, Instruction *code)
+{
+	int nbuckets = n / 2 + 1, nslots = n + n / 4 + 1;
+	int *count = NEWARRAY(arena, int, nbuckets + 1);
+	int *order = NEWARRAY(arena, int, n);
+	int *bysize = NEWARRAY(arena, int, nbuckets);
+	int *sizes = NEWARRAY(arena, int, n + 2);
+	int *owner = NEWARRAY(arena, int, nslots);
+	int *slots = NEWARRAY(arena, int, n);
+	Instruction *tests = code + 1 + nbuckets;
+	int i, j, k, b, seed;
+
+	/* The keys by their buckets, then the buckets from the biggest down */
+	for (i = 0; i < n; i++) count[keys[i].hash % nbuckets + 1]++;
+	for (b = 0; b < nbuckets; b++) count[b + 1] += count[b];
+	for (i = 0; i < n; i++) order[count[keys[i].hash % nbuckets]++] = i;
+	for (b = nbuckets; b > 0; b--) count[b] = count[b - 1];
+	count[0] = 0;
+	for (b = 0; b < nbuckets; b++) sizes[n - (count[b + 1] - count[b]) + 1]++;
+	for (k = 0; k <= n; k++) sizes[k + 1] += sizes[k];
+	for (b = 0; b < nbuckets; b++) bysize[sizes[n - (count[b + 1] - count[b])]++] = b;
+
+	for (k = 0; k < nslots; k++) owner[k] = -1;
+	SetHeader(&code[0], JHASH, keys[0].test->src1.i, nbuckets, nslots);
+	for (i = 0; i < nbuckets; i++) {
+		b = bysize[i];
+		for (seed = 0; seed < MAXSEED; seed++) {
+			for (j = count[b]; j < count[b + 1]; j++) {
+				slots[j] = HashSlot(keys[order[j]].hash, seed) % nslots;
+				if (owner[slots[j]] != -1) break;
+				owner[slots[j]] = order[j];
+			}
+			if (j == count[b + 1]) break;
+			while (--j >= count[b]) owner[slots[j]] = -1;
+		}
+		if (seed == MAXSEED) return 0;
+		SetHeader(&code[1 + b], JHASH, seed, 0, 0);
+		code[1 + b].op |= FLAG1;
+	}
+	/* A free slot repeats a key, whose test is then still right */
+	for (k = 0; k < nslots; k++)
+		tests[k] = *keys[owner[k] == -1 ? 0 : owner[k]].test;
+	return 1 + nbuckets + nslots;
+}
+
+/* Writes the dispatch of the n tests to code, which has room for
+ * DISPATCHSIZE(n) instructions. A JE there whose dest is -1 jumps on
+ * past the table. Returns the size, 0 to keep the chain. */
+int PlanDispatch(Arena *arena, const Instruction *tests, int n, Instruction *code)
+{
+	Key *keys;
+	int strings, i, m;
+	unsigned span;
+
+	if (n < MINCASES) return 0;
+	strings = (tests[0].op & STRFLAG) != 0;
+	for (i = 0; i < n; i++) {
+		if (tests[i].op != (strings ? JE|STRFLAG|FLAG3 : JE|FLAG2|FLAG3)
+			|| tests[i].src1.i != tests[0].src1.i)
+			return 0;
+		if (strings && VMStack[tests[i].src2.i].tag != T_STRING) return 0;
+	}
+
+	keys = NEWARRAY(arena, Key, n);
+	for (i = 0; i < n; i++) {
+		keys[i].test = &tests[i];
+		keys[i].index = i;
+		if (strings) keys[i].hash = HashString(*VMMEM(tests[i].src2.i).str);
+	}
+	qsort(keys, n, sizeof(Key), strings ? CompareString : CompareInt);
+	for (i = m = 0; i < n; i++) {
+		if (!m || !SameKey(&keys[m - 1], &keys[i], strings)) keys[m++] = keys[i];
+	}
+	if (strings) return m < MINCASES ? 0 : PerfectHash(arena, keys, m, code);
+
+	span = (unsigned)keys[m - 1].test->src2.i - (unsigned)keys[0].test->src2.i;
+	if (span < 2u * m) {
+		SetHeader(&code[0], JTAB, keys[0].test->src1.i, keys[0].test->src2.i, span + 1);
+		for (i = 0; i <= (int)span; i++) {
+			code[1 + i] = *keys[0].test;
+			code[1 + i].src2.i = (int)((unsigned)keys[0].test->src2.i + i);
+			code[1 + i].dest = -1;
+		}
+		for (i = 0; i < m; i++) {
+			code[1 + ((unsigned)keys[i].test->src2.i - (unsigned)keys[0].test->src2.i)] =
+				*keys[i].test;
+		}
+		return 2 + span;
+	}
+	SetHeader(&code[0], JBIN, keys[0].test->src1.i, 0, m);
+	code[0].op &= ~FLAG2;
+	for (i = 0; i < m; i++) code[1 + i] = *keys[i].test;
+	return 1 + m;
+}
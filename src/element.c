@@ -19,48 +19,22 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "element.h"
+#include "arena.h"
+#include "lextab.h"
 
-#define TABLE_SIZE(__x) ((int)(sizeof(__x)/sizeof(__x[0])))
+#define TOKENSIZE 1024
 
-static const char *Keywords[]={
-	"if",	"else",	"for",	"while",	"do",
-	"continue",	"break", "switch",	"case",	
-	"default",	"goto", 
-	/* Types */
-	"integer", "float", "string", "list"
-};
+#define KEYWORD_TEXT(__text) __text,
+static const char *Keywords[]={ MYL_KEYWORDS(KEYWORD_TEXT) };
+#undef KEYWORD_TEXT
 
-const int FIRSTTYPE=11;
-static const char *Symbols[]={
-	"=",
-	"+=",	"-=",	"<<=",	">>=",	"^=",
-	"*=",	"/=",	"%=",
-	"|=",	"&=",
-	"?",	":",
-	"!",
-	"||",
-	"&&",
-	"|",
-	"&",
-	"!=",	"==",
-	"<",	"<=",	">",	">=",
-	"<<",	">>",
-	"+",	"-",
-	"*",	"/",	"%",
-	"~",	"++",	"--",
-	"(",	")",	
-	"{",	"}",
-	"\"",	",",	";",
-	".",	"^"
-};
-static const char Charset[]="=+-<>^*/%|&?:!(){}\",;~.";
+const int FIRSTTYPE=12;
 
 /* Element items */
 typedef struct IntegerItem {
@@ -86,7 +60,8 @@ typedef struct StringItem {
 struct ElementParser {
 	/* Priviate Data Definitions */
 	InputStream *stream;
-	char buffer[128];
+	Arena *arena;
+	char buffer[TOKENSIZE];
 	int index;
 	int ch;
 	/* Elements lists */
@@ -97,49 +72,37 @@ struct ElementParser {
 };
 
 static int FindInteger(IntegerItem *integerList, int num);
-static int NewInteger(IntegerItem *integerList, int num);
-static int RegInteger(IntegerItem *integerList, int num);
+static int NewInteger(Arena *arena, IntegerItem *integerList, int num);
+static int RegInteger(Arena *arena, IntegerItem *integerList, int num);
 
 static int FindFloat(FloatItem *floatList, float num);
-static int NewFloat(FloatItem *floatList, float num);
-static int RegFloat(FloatItem *floatList, float num);
+static int NewFloat(Arena *arena, FloatItem *floatList, float num);
+static int RegFloat(Arena *arena, FloatItem *floatList, float num);
 
 static int FindIdent(IdentItem *itemList, const char *name);
-static int NewIdent(IdentItem *itemList, const char *name);
-static int RegIdent(IdentItem *itemList, const char *name);
+static int NewIdent(Arena *arena, IdentItem *itemList, const char *name);
+static int RegIdent(Arena *arena, IdentItem *itemList, const char *name);
 
-static int NewString(StringItem *stringList, const char *name);
+static int NewString(Arena *arena, StringItem *stringList, const char *name);
 static int FindString(StringItem *stringList, const char *name);
-static int RegString(StringItem *stringList, const char *name);
+static int RegString(Arena *arena, StringItem *stringList, const char *name);
 
-static int FindKeyword(const char *name);
-static int FindSymbol(const char *name);
-static int _ch_isblank(int ch);
-static int _ch_issymbol(int ch);
+static int FindKeyword(const char *name, int len);
 static void ReportError();
 /* DFA */
-static int state02(ElementParser *parser, Element *elem);
-static int state03(ElementParser *parser, Element *elem);
-static int state04(ElementParser *parser, Element *elem);
-static int state05(ElementParser *parser, Element *elem);
-static int state06(ElementParser *parser, Element *elem);
-static int state07(ElementParser *parser, Element *elem);
-static int state08(ElementParser *parser, Element *elem);
-static int state09(ElementParser *parser, Element *elem);
-static int state10(ElementParser *parser, Element *elem);
-static int state11(ElementParser *parser, Element *elem);
-static int state12(ElementParser *parser, Element *elem);
-static int state13(ElementParser *parser, Element *elem);
-static int state14(ElementParser *parser, Element *elem);
-static int state15(ElementParser *parser, Element *elem);
-static int state16(ElementParser *parser, Element *elem);
-static int state17(ElementParser *parser, Element *elem);
-static int state18(ElementParser *parser, Element *elem);
-
-static int app_state01(ElementParser *parser, Element *elem);
-static int app_state02(ElementParser *parser, Element *elem);
-static int app_state05(ElementParser *parser, Element *elem);
-static int float_state(ElementParser *parser, Element *elem);
+static void NextChar(ElementParser *parser);
+static void AppendChar(ElementParser *parser, int ch);
+static void KeepChar(ElementParser *parser);
+static int ScanIdent(ElementParser *parser, Element *elem);
+static int ScanNumber(ElementParser *parser, Element *elem);
+static int ScanFraction(ElementParser *parser, Element *elem);
+static int ScanExponent(ElementParser *parser, Element *elem);
+static int ScanSymbol(ElementParser *parser, Element *elem);
+static int ScanString(ElementParser *parser, Element *elem);
+static int ScanEscape(ElementParser *parser);
+static int SkipComment(ElementParser *parser);
+static int FloatElement(ElementParser *parser, Element *elem);
+static int IsDelimiter(int ch);
 
 static int FindInteger(IntegerItem *iList, int num)
 {
@@ -154,7 +117,7 @@ static int FindInteger(IntegerItem *iList, int num)
 	return 0;
 }
 
-static int NewInteger(IntegerItem *iList, int num)
+static int NewInteger(Arena *arena, IntegerItem *iList, int num)
 {
 	int i=0;
 	IntegerItem *pnode=iList, *nnode;
@@ -162,19 +125,19 @@ static int NewInteger(IntegerItem *iList, int num)
 		i++;
 		pnode=pnode->next;
 	}
-	nnode=(IntegerItem*)malloc(sizeof(IntegerItem));
+	nnode=(IntegerItem*)ArenaAlloc(arena, sizeof(IntegerItem));
 	nnode->data=num;
 	nnode->next=0;
 	pnode->next=nnode;
 	return i+1;
 }
 
-static int RegInteger(IntegerItem *integerList, int num)
+static int RegInteger(Arena *arena, IntegerItem *integerList, int num)
 {
 	int i;
 
 	if (!(i = FindInteger(integerList, num))) {
-		return NewInteger(integerList, num);
+		return NewInteger(arena, integerList, num);
 	}
 	else return i;
 }
@@ -193,7 +156,7 @@ static int FindFloat(FloatItem *floatList, float num)
 	return 0;
 }
 
-static int NewFloat(FloatItem *floatList, float num)
+static int NewFloat(Arena *arena, FloatItem *floatList, float num)
 {
 	int i=0;
 	FloatItem *pnode = floatList, *nnode;
@@ -202,19 +165,19 @@ static int NewFloat(FloatItem *floatList, float num)
 		i++;
 		pnode=pnode->next;
 	}
-	nnode=(FloatItem*)malloc(sizeof(FloatItem));
+	nnode=(FloatItem*)ArenaAlloc(arena, sizeof(FloatItem));
 	nnode->data=num;
 	nnode->next=0;
 	pnode->next=nnode;
 	return i+1;
 }
 
-static int RegFloat(FloatItem *floatList, float num)
+static int RegFloat(Arena *arena, FloatItem *floatList, float num)
 {
 	int i;
 
 	if (!(i=FindFloat(floatList, num))) {
-		return NewFloat(floatList, num);
+		return NewFloat(arena, floatList, num);
 	}
 	else return i;
 }
@@ -233,7 +196,7 @@ static int FindString(StringItem *stringList, const char *name)
 	return 0;
 }
 
-static int NewString(StringItem *stringList, const char *name)
+static int NewString(Arena *arena, StringItem *stringList, const char *name)
 {
 	int i=0;
 	StringItem *pnode = stringList, *nnode;
@@ -242,20 +205,19 @@ static int NewString(StringItem *stringList, const char *name)
 		i++;
 		pnode=pnode->next;
 	}
-	nnode=(StringItem*)malloc(sizeof(StringItem));
-	nnode->data=(char *)malloc(sizeof(char)*strlen(name));
-	strcpy(nnode->data, name);
+	nnode=(StringItem*)ArenaAlloc(arena, sizeof(StringItem));
+	nnode->data=ArenaStrdup(arena, name);
 	nnode->next=0;
 	pnode->next=nnode;
 	return i+1;
 }
 
-static int RegString(StringItem *stringList, const char *name)
+static int RegString(Arena *arena, StringItem *stringList, const char *name)
 {
 	int i;
 
 	if (!(i = FindString(stringList, name))) {
-		return NewString(stringList, name);
+		return NewString(arena, stringList, name);
 	}
 	else return i;
 }
@@ -274,7 +236,7 @@ static int FindIdent(IdentItem *identList, const char *name)
 	return 0;
 }
 
-static int NewIdent(IdentItem *identList, const char *name)
+static int NewIdent(Arena *arena, IdentItem *identList, const char *name)
 {
 	int i=0;
 	IdentItem *pnode = identList, *nnode;
@@ -283,20 +245,19 @@ static int NewIdent(IdentItem *identList, const char *name)
 		i++;
 		pnode=pnode->next;
 	}
-	nnode=(IdentItem*)malloc(sizeof(IdentItem));
-	nnode->data=(char *)malloc(sizeof(char)*strlen(name));
-	strcpy(nnode->data, name);
+	nnode=(IdentItem*)ArenaAlloc(arena, sizeof(IdentItem));
+	nnode->data=ArenaStrdup(arena, name);
 	nnode->next=0;
 	pnode->next=nnode;
 	return i+1;
 }
 
-static int RegIdent(IdentItem *identList, const char *name)
+static int RegIdent(Arena *arena, IdentItem *identList, const char *name)
 {
 	int i;
 
 	if (!(i=FindIdent(identList, name))) {
-		return NewIdent(identList, name);
+		return NewIdent(arena, identList, name);
 	}
 	else return i;
 }
@@ -333,31 +294,27 @@ char *GetString(ElementParser *parser, int idx)
 	return pnode->data;
 }
 
-static int FindKeyword(const char *name)
+static int FindKeyword(const char *name, int len)
 {
-	int i;
-	for (i=0; i<TABLE_SIZE(Keywords); i++)
-		if (!strcmp (Keywords[i], name)) return i;
-	return -1;
-}
+	int i = LexKwSlot[((unsigned char)name[0] * LEX_KW_K1
+		+ (unsigned char)name[len-1] * LEX_KW_K2 + len) & (LEX_KW_SIZE-1)];
 
-static int FindSymbol(const char *name)
-{
-	int i;
-	for (i=0; i<TABLE_SIZE(Symbols); i++)
-		if (!strcmp(Symbols[i], name)) return i;
+	if (i >= 0 && !strcmp(Keywords[i], name)) return i;
 	return -1;
 }
 
-static int _ch_isblank(int ch)
-{
-	return ch == ' ' || ch == '\t'
-		|| ch == '\n' || ch == -1;
-}
-
-static int _ch_issymbol(int ch)
+static int IsDelimiter(int ch)
+/* Characters allowed right after an identifier or an integer */
 {
-	return strrchr(Charset, ch)!=NULL;
+	switch (LexCharClass[ch+1]) {
+	case LEX_EOF:
+	case LEX_BLANK:
+	case LEX_SYMBOL:
+	case LEX_QUOTE:
+		return 1;
+	default:
+		return 0;
+	}
 }
 
 static void ReportError()
@@ -373,65 +330,36 @@ static void InitDFA(ElementParser *parser)
 	parser->ch = stream->getChar(stream);
 }
 
-int app_state01(ElementParser *parser, Element *elem)
-{
-	if (isdigit(parser->ch))
-		return app_state02(parser, elem);
-	else {
-		parser->buffer[parser->index]=0;
-		elem->type=SYMBOL;
-		elem->id=FindSymbol(parser->buffer);
-		return 1;
-	}
-}
-int app_state02(ElementParser *parser, Element *elem)
+static void NextChar(ElementParser *parser)
 {
 	InputStream *stream = parser->stream;
 
-	while (isdigit(parser->ch)) {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	if (parser->ch=='E' || parser->ch=='e') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-		return app_state05(parser, elem);
-	}
-	else {
-		return float_state(parser, elem);
-	}
+	parser->ch = stream->getChar(stream);
 }
-int app_state05(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
 
-	if (parser->ch=='+' || parser->ch=='-') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	if (isdigit(parser->ch)) {
-		/* append state06 */
-		while (isdigit(parser->ch)) {
-			parser->buffer[parser->index++]=parser->ch;
-			parser->ch = stream->getChar(stream);
-		}
-		return float_state(parser, elem);
-	}
-	else {
+static void AppendChar(ElementParser *parser, int ch)
+{
+	if (parser->index >= TOKENSIZE-1)
 		ReportError();
-		return 0;
-	}
+	parser->buffer[parser->index++]=ch;
+}
+
+static void KeepChar(ElementParser *parser)
+/* Append current char to the token buffer and move on */
+{
+	AppendChar(parser, parser->ch);
+	NextChar(parser);
 }
 
-int float_state(ElementParser *parser, Element *elem)
+static int FloatElement(ElementParser *parser, Element *elem)
 {
 	parser->buffer[parser->index] = 0;
 	elem->type = C_FLOAT;
-	elem->id = RegFloat(&parser->floatList, (float)atof(parser->buffer));
+	elem->id = RegFloat(parser->arena, &parser->floatList, (float)atof(parser->buffer));
 	return 1;
 }
 
-ElementParser *CreateElementParser(InputStream *stream)
+ElementParser *CreateElementParser(InputStream *stream, Arena *arena)
 {
 	ElementParser *parser = calloc(1, sizeof(ElementParser));
 
@@ -440,496 +368,206 @@ ElementParser *CreateElementParser(InputStream *stream)
 	}
 
 	parser->stream = stream;
+	parser->arena = arena;
 	InitDFA(parser);
 	return parser;
 }
 
 void CloseElementParser(ElementParser *parser)
+/* Elements lists are released with the arena */
 {
 	free(parser);
 }
 
 int GetElement(ElementParser *parser, Element *elem)
 {
-	InputStream *stream = parser->stream;
-
-	parser->index=0;
-	while (parser->ch!=EOF) {
-		if (_ch_isblank(parser->ch)) {
-			parser->ch = stream->getChar(stream);
+	for (;;) {
+		parser->index=0;
+		switch (LexCharClass[parser->ch+1]) {
+		case LEX_BLANK:
+			NextChar(parser);
 			continue;
-		}
-		if (isalpha(parser->ch)) {
-			parser->buffer[parser->index++]=parser->ch;
-			parser->ch = stream->getChar(stream);
-			return state02(parser, elem);
-		}
-		else if (isdigit(parser->ch))  {
-			parser->buffer[parser->index++]=parser->ch;
-			parser->ch = stream->getChar(stream);
-			return state03(parser, elem);
-		}
-		else { 
-			switch (parser->ch) {
-				case '(':
-				case ')':
-				case '{':
-				case '}':
-				case ';':
-				case ',':
-				case '?':
-				case ':':
-				case '~':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					parser->buffer[parser->index]=0;
-					elem->type=SYMBOL;
-					elem->id=FindSymbol(parser->buffer);
-					return 1;
-				case '.':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return app_state01(parser, elem);
-				case '+':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state04(parser, elem);
-				case '-':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state06(parser, elem);
-				case '*':
-				case '%':
-				case '!':
-				case '^':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state07(parser, elem);
-				case '/':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					switch (state16(parser, elem)) {
-						case 2:
-							parser->index=0;
-							continue;
-						case 0:
-							return 0;
-						default:
-							return 1;
-					}
-				case '=':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state05(parser, elem);
-				case '&':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state08(parser, elem);
-				case '|':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state09(parser, elem);
-				case '<':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state10(parser, elem);
-				case '>':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state11(parser, elem);
-				case '\"':
-					/*				parser->buffer[parser->index++]=parser->ch;*/
-					/* Skip the first letter of a string */
-					parser->ch = stream->getChar(stream);
-					return state14(parser, elem);
-				case '\'':
-					parser->buffer[parser->index++]=parser->ch;
-					parser->ch = stream->getChar(stream);
-					return state15(parser, elem);
-				default:
-					ReportError();
-					return 0;
+		case LEX_ALPHA:
+			return ScanIdent(parser, elem);
+		case LEX_DIGIT:
+			return ScanNumber(parser, elem);
+		case LEX_SYMBOL:
+			if (ScanSymbol(parser, elem) == LEX_COMMENT) {
+				SkipComment(parser);
+				continue;
 			}
+			return 1;
+		case LEX_QUOTE:
+			/* Skip the first letter of a string */
+			NextChar(parser);
+			return ScanString(parser, elem);
+		case LEX_EOF:
+			elem->type=ENDFLAG;
+			elem->id=0;
+			return EOF;
+		case LEX_APOS:
+			/* MYL doesn't accept char constant */
+		default:
+			ReportError();
+			return 0;
 		}
 	}
-	elem->type=ENDFLAG;
-	elem->id=0;
-	return EOF;
 }
 
-static int state02(ElementParser *parser, Element *elem)
+static int ScanIdent(ElementParser *parser, Element *elem)
 {
-	InputStream *stream = parser->stream;
+	int cls;
+
+	do {
+		KeepChar(parser);
+		cls = LexCharClass[parser->ch+1];
+	} while (cls == LEX_ALPHA || cls == LEX_DIGIT);
 
-	while (isalpha(parser->ch) || isdigit(parser->ch)) {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
+	if (!IsDelimiter(parser->ch)) {
+		ReportError();
+		return 0;
 	}
-	if (_ch_isblank(parser->ch) || _ch_issymbol(parser->ch)) {
-		parser->buffer[parser->index]=0;
-		if ((elem->id=FindKeyword(parser->buffer))!=-1) {
-			elem->type=KEYWORD;
-		}
-		else {
-			elem->type=IDENTIFIER;
-			elem->id=RegIdent(&parser->identList, parser->buffer);
-		}
-		return 1;
+	parser->buffer[parser->index]=0;
+	if ((elem->id=FindKeyword(parser->buffer, parser->index))!=-1) {
+		elem->type=KEYWORD;
 	}
 	else {
-		ReportError();
-		return 0;
+		elem->type=IDENTIFIER;
+		elem->id=RegIdent(parser->arena, &parser->identList, parser->buffer);
 	}
+	return 1;
 }
 
-static int state03(ElementParser *parser, Element *elem)
+static int ScanNumber(ElementParser *parser, Element *elem)
 {
-	InputStream *stream = parser->stream;
+	do {
+		KeepChar(parser);
+	} while (LexCharClass[parser->ch+1] == LEX_DIGIT);
 
-	while (isdigit(parser->ch)) {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
 	if (parser->ch=='.') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-		if (isdigit(parser->ch))
-			return app_state02(parser, elem);
-		else if (parser->ch=='E'||parser->ch=='e') {
-			parser->buffer[parser->index++]=parser->ch;
-			parser->ch = stream->getChar(stream);
-			return app_state05(parser, elem);
-		}
-		else
-			return float_state(parser, elem);
+		KeepChar(parser);
+		return ScanFraction(parser, elem);
 	}
 	else if (parser->ch=='E' || parser->ch=='e') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-		return app_state05(parser, elem);
-	}
-	if (_ch_isblank(parser->ch) || _ch_issymbol(parser->ch)) {
-		parser->buffer[parser->index] = 0;
-		elem->type = INTEGER;
-		elem->id = RegInteger(&parser->integerList, atoi(parser->buffer));
-		return 1;
+		KeepChar(parser);
+		return ScanExponent(parser, elem);
 	}
-	else {
+	if (!IsDelimiter(parser->ch)) {
 		ReportError();
 		return 0;
 	}
-}
-
-static int state04(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='+' || parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state05(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state06(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='-' || parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state07(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state08(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='&' || parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
+	parser->buffer[parser->index] = 0;
+	elem->type = INTEGER;
+	elem->id = RegInteger(parser->arena, &parser->integerList, atoi(parser->buffer));
 	return 1;
 }
 
-static int state09(ElementParser *parser, Element *elem)
+static int ScanFraction(ElementParser *parser, Element *elem)
+/* Digits after the point, with an optional exponent */
 {
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='|' || parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
+	while (LexCharClass[parser->ch+1] == LEX_DIGIT)
+		KeepChar(parser);
+	if (parser->ch=='E' || parser->ch=='e') {
+		KeepChar(parser);
+		return ScanExponent(parser, elem);
 	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
+	return FloatElement(parser, elem);
 }
 
-static int state10(ElementParser *parser, Element *elem)
+static int ScanExponent(ElementParser *parser, Element *elem)
 {
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='<') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-		return state12(parser, elem);
-	}
-	else if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
+	if (parser->ch=='+' || parser->ch=='-')
+		KeepChar(parser);
+	if (LexCharClass[parser->ch+1] != LEX_DIGIT) {
+		ReportError();
+		return 0;
 	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
+	while (LexCharClass[parser->ch+1] == LEX_DIGIT)
+		KeepChar(parser);
+	return FloatElement(parser, elem);
 }
 
-static int state11(ElementParser *parser, Element *elem)
+static int ScanSymbol(ElementParser *parser, Element *elem)
+/* Longest match over the symbol DFA. Every prefix of a symbol is a
+ * symbol as well, so the last state reached is always accepting. */
 {
-	InputStream *stream = parser->stream;
+	int state = 0, next;
 
-	if (parser->ch=='>') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-		return state13(parser, elem);
+	while ((next = LexSymNext[state][LexSymClass[parser->ch+1]])) {
+		state = next;
+		KeepChar(parser);
 	}
-	else if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state12(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
+	if (LexSymAccept[state] == S_POINT
+		&& LexCharClass[parser->ch+1] == LEX_DIGIT)
+		return ScanFraction(parser, elem);
+	if (LexSymAccept[state] == LEX_COMMENT)
+		return LEX_COMMENT;
 
-	if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
 	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
+	elem->id=LexSymAccept[state];
 	return 1;
 }
 
-static int state13(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
+static int ScanEscape(ElementParser *parser)
+/* Current char follows a backslash, return the char it stands for */
+{
+	int ch = parser->ch;
+
+	NextChar(parser);
+	if (ch<='Z' && ch>='A')
+		return ch-'A'+1;
+	switch (ch) {
+	case 't':
+		return '\t';
+	case 'n':
+		return '\n';
+	case 'r':
+		return '\r';
+	case 'b':
+		return '\b';
+	case '\"':
+	case '\'':
+	case '\\':
+		return ch;
+	default:
+		ReportError();
+		return 0;
 	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
 }
 
-static int state14(ElementParser *parser, Element *elem)
+static int ScanString(ElementParser *parser, Element *elem)
 {
-	InputStream *stream = parser->stream;
-
 	while (parser->ch!=EOF) {
 		if (parser->ch=='\"') {
 			parser->buffer[parser->index]=0;
-			parser->ch = stream->getChar(stream);
+			NextChar(parser);
 			elem->type = STRING;
-			elem->id = RegString(&parser->stringList, parser->buffer);
+			elem->id = RegString(parser->arena, &parser->stringList, parser->buffer);
 			return 1;
 		}
 		else if (parser->ch=='\\') {
-			parser->ch = stream->getChar(stream);
-			if (parser->ch<='Z' && parser->ch>='A') {
-				parser->buffer[parser->index++]=parser->ch-'A'+1;
-				parser->ch = stream->getChar(stream);
-			}
-			else switch (parser->ch) {
-				case 't':
-					parser->buffer[parser->index++]='\t';
-					parser->ch = stream->getChar(stream);
-					break;
-				case 'n':
-					parser->buffer[parser->index++]='\n';
-					parser->ch = stream->getChar(stream);
-					break;
-				case 'r':
-					parser->buffer[parser->index++]='\r';
-					parser->ch = stream->getChar(stream);
-					break;
-				case 'b':
-					parser->buffer[parser->index++]='\b';
-					parser->ch = stream->getChar(stream);
-					break;
-				case '\"':
-					parser->buffer[parser->index++]='\"';
-					parser->ch = stream->getChar(stream);
-					break;
-				case '\'':
-					parser->buffer[parser->index++]='\'';
-					parser->ch = stream->getChar(stream);
-					break;
-				case '\\':
-					parser->buffer[parser->index++]='\\';
-					parser->ch = stream->getChar(stream);
-					break;
-				default:
-					ReportError();
-			}
-		}
-		else {
-			parser->buffer[parser->index++]=parser->ch;
-			parser->ch = stream->getChar(stream);
-		}
-	}
-	return 0;
-}
-
-static int state15(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='\\') {
-		parser->ch = stream->getChar(stream);
-		if (parser->ch<='Z' && parser->ch>='A') {
-			parser->buffer[parser->index]=parser->ch-'A'+1;
-			parser->ch = stream->getChar(stream);
-		}
-		else switch (parser->ch) {
-			case 't':
-				parser->buffer[parser->index]='\t';
-				parser->ch = stream->getChar(stream);
-				break;
-			case 'n':
-				parser->buffer[parser->index]='\n';
-				parser->ch = stream->getChar(stream);
-				break;
-			case 'r':
-				parser->buffer[parser->index]='\r';
-				parser->ch = stream->getChar(stream);
-				break;
-			case 'b':
-				parser->buffer[parser->index]='\b';
-				parser->ch = stream->getChar(stream);
-				break;
-			case '\"':
-				parser->buffer[parser->index]='\"';
-				parser->ch = stream->getChar(stream);
-				break;
-			case '\'':
-				parser->buffer[parser->index]='\'';
-				parser->ch = stream->getChar(stream);
-				break;
-			case '\\':
-				parser->buffer[parser->index]='\\';
-				parser->ch = stream->getChar(stream);
-				break;
-			default:
-				ReportError();
-				return 0;
+			NextChar(parser);
+			AppendChar(parser, ScanEscape(parser));
 		}
+		else KeepChar(parser);
 	}
-	else {
-		parser->buffer[parser->index]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	if (parser->ch=='\'') {
-		parser->ch = stream->getChar(stream);
-		/* MYL doesn't accept char constant */
-		ReportError();
-		return 0;
-		/*
-		   elem->type=CONSTANT;
-		   elem->id = RegInteger(&parser->integerList, parser->buffer[parser->index]);
-		   return 1;*/
-	}
+	ReportError();
 	return 0;
 }
 
-static int state16(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='*') {
-		parser->ch = stream->getChar(stream);
-		return state17(parser, elem);
-	}
-	else if (parser->ch=='=') {
-		parser->buffer[parser->index++]=parser->ch;
-		parser->ch = stream->getChar(stream);
-	}
-	parser->buffer[parser->index]=0;
-	elem->type=SYMBOL;
-	elem->id=FindSymbol(parser->buffer);
-	return 1;
-}
-
-static int state17(ElementParser *parser, Element *elem)
+static int SkipComment(ElementParser *parser)
+/* Skip to the end of a comment, the opener has been read */
 {
-	InputStream *stream = parser->stream;
-
 	while (parser->ch!=EOF) {
 		if (parser->ch=='*') {
-			parser->ch = stream->getChar(stream);
-			if (state18(parser, elem))	return 2;
+			NextChar(parser);
+			if (parser->ch=='/') {
+				NextChar(parser);
+				return 1;
+			}
 		}
-		parser->ch = stream->getChar(stream);
+		else NextChar(parser);
 	}
+	ReportError();
 	return 0;
 }
-
-static int state18(ElementParser *parser, Element *elem)
-{
-	InputStream *stream = parser->stream;
-
-	if (parser->ch=='/') {
-		parser->ch = stream->getChar(stream);
-		return 2;
-	}
-	else return 0;
-}
-
@@ -24,15 +24,14 @@
 
 /* Data types */
 #include "inputstream.h"
+#include "lexdefs.h"
+#include "arena.h"
 
+#define SYMBOL_ENUM(__id, __text) __id,
 enum {
-	S_SET, S_ADDSET, S_SUBSET, S_LSSET, S_RSSET, S_XORSET, S_MULSET, S_DIVSET,
-	S_MODSET, S_ORSET, S_ANDSET, S_SELECT, S_COLON, S_LOGNOT, S_LOGOR, S_LOGAND, S_BITOR,
-	S_BITAND, S_NOTEQU, S_EQU, S_LESS, S_LE, S_GREAT, S_GE, S_LSHIFT, S_RSHIFT,
-	S_ADD, S_SUB, S_MUL, S_DIV, S_MOD, S_NOT, S_INC, S_DEC,
-	S_LPARA, S_RPARA, S_LBRACKET, S_RBRACKET, S_QUOTE, S_COMMA, S_SEMICOLON,
-	S_POINT, S_BITXOR
+	MYL_SYMBOLS(SYMBOL_ENUM)
 };
+#undef SYMBOL_ENUM
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,7 +50,7 @@ extern const int FIRSTTYPE;
 
 typedef struct ElementParser ElementParser;
 
-ElementParser *CreateElementParser(InputStream *stream);
+ElementParser *CreateElementParser(InputStream *stream, Arena *arena);
 void CloseElementParser(ElementParser *elem);
 
 int GetElement(ElementParser *parser, Element *elem);
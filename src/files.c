@@ -0,0 +1,267 @@
+/* files.c - Files read through mmap and written through a buffer
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* A file read is mapped whole, so a line is returned where it is without
+ * being read into a buffer first, and the kernel reads ahead of the scan.
+ * A file up to POPULATESIZE is mapped with its pages at once, which saves
+ * a fault for each page; a larger one is faulted in as it is read so
+ * that it doesn't have to fit in memory.
+ * A file that can't be mapped, such as a pipe, is read whole into memory
+ * instead. A file written collects the writes in a buffer of FILEBUFSIZE,
+ * written out when it is full, when it is closed and at exit. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "files.h"
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+#define POPULATESIZE (256 << 20)
+
+typedef struct File {
+	int fd;				/* -1 if the handle is free */
+	int writing;
+	/* read */
+	char *data;
+	size_t size;
+	size_t pos;
+	int mapped;
+	/* written */
+	char *buf;
+	size_t len;
+	int failed;
+} File;
+
+static File Files[MAXFILES];
+static int Started;
+static unsigned long Writes;
+
+static void WriteAll(File *file, const char *data, size_t len)
+{
+	ssize_t n;
+
+	if (len > 0) Writes++;
+	while (len > 0) {
+		if ((n = write(file->fd, data, len)) <= 0) {
+			file->failed = 1;
+			return;
+		}
+		data += n;
+		len -= n;
+	}
+}
+
+static int FlushFile(File *file)
+{
+	WriteAll(file, file->buf, file->len);
+	file->len = 0;
+	return !file->failed;
+}
+
+static void FlushFiles()
+{
+	int i;
+
+	for (i = 0; i < MAXFILES; i++) {
+		if (Files[i].fd >= 0 && Files[i].writing) FlushFile(&Files[i]);
+	}
+}
+
+static void Start()
+{
+	int i;
+
+	for (i = 0; i < MAXFILES; i++) Files[i].fd = -1;
+	atexit(FlushFiles);
+	Started = 1;
+}
+
+/* A pipe or a special file, which has no size to map */
+static int ReadWhole(File *file)
+{
+	size_t cap = FILEBUFSIZE;
+	ssize_t n;
+	char *data;
+
+	if (!(file->data = (char *)malloc(cap))) return 0;
+	while ((n = read(file->fd, file->data + file->size, cap - file->size)) > 0) {
+		file->size += n;
+		if (file->size == cap) {
+			if (!(data = (char *)realloc(file->data, cap * 2))) return 0;
+			file->data = data;
+			cap *= 2;
+		}
+	}
+	return n == 0;
+}
+
+static int OpenRead(File *file)
+{
+	struct stat st;
+	void *map;
+
+	if (fstat(file->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ,
+			st.st_size <= POPULATESIZE ? MAP_PRIVATE | MAP_POPULATE : MAP_PRIVATE,
+			file->fd, 0);
+		if (map != MAP_FAILED) {
+			madvise(map, st.st_size, MADV_SEQUENTIAL);
+			file->data = (char *)map;
+			file->size = st.st_size;
+			file->mapped = 1;
+			return 1;
+		}
+	}
+	return ReadWhole(file);
+}
+
+static void Release(File *file)
+{
+	if (file->mapped) munmap(file->data, file->size);
+	else free(file->data);
+	free(file->buf);
+	if (file->fd >= 0) close(file->fd);
+	memset(file, 0, sizeof(File));
+	file->fd = -1;
+}
+
+int OpenFile(const char *path, const char *mode)
+{
+	File *file;
+	int i, flags;
+
+	if (!Started) Start();
+	for (i = 0; i < MAXFILES && Files[i].fd >= 0; i++);
+	if (i == MAXFILES) return -1;
+	file = &Files[i];
+	if (!strcmp(mode, "r")) flags = O_RDONLY;
+	else if (!strcmp(mode, "w")) flags = O_WRONLY | O_CREAT | O_TRUNC;
+	else if (!strcmp(mode, "a")) flags = O_WRONLY | O_CREAT | O_APPEND;
+	else return -1;
+	memset(file, 0, sizeof(File));
+	if ((file->fd = open(path, flags, 0666)) < 0) return -1;
+	if (flags == O_RDONLY) {
+		if (!OpenRead(file)) {
+			Release(file);
+			return -1;
+		}
+	}
+	else {
+		/* "w" has truncated it already */
+		Writes++;
+		file->writing = 1;
+		if (!(file->buf = (char *)malloc(FILEBUFSIZE))) {
+			Release(file);
+			return -1;
+		}
+	}
+	return i;
+}
+
+int FileMode(int handle)
+{
+	if (!Started || handle < 0 || handle >= MAXFILES || Files[handle].fd < 0)
+		return 0;
+	return Files[handle].writing ? 'w' : 'r';
+}
+
+static File *GetFile(int handle, int writing)
+{
+	if (FileMode(handle) != (writing ? 'w' : 'r')) return NULL;
+	return &Files[handle];
+}
+
+int CloseFile(int handle)
+{
+	File *file;
+	int ok = 1;
+
+	if (!FileMode(handle)) return -1;
+	file = &Files[handle];
+	if (file->writing) ok = FlushFile(file);
+	Release(file);
+	return ok ? 0 : -1;
+}
+
+const char *ReadLine(int handle, size_t *len)
+{
+	File *file = GetFile(handle, 0);
+	const char *line, *nl;
+
+	if (!file) return NULL;
+	line = file->data + file->pos;
+	*len = file->size - file->pos;
+	if ((nl = (const char *)memchr(line, '\n', *len))) {
+		*len = nl - line;
+		file->pos += *len + 1;
+	}
+	else file->pos = file->size;
+	return line;
+}
+
+const char *ReadAll(int handle, size_t *len)
+{
+	File *file = GetFile(handle, 0);
+	const char *rest;
+
+	if (!file) return NULL;
+	rest = file->data + file->pos;
+	*len = file->size - file->pos;
+	file->pos = file->size;
+	return rest;
+}
+
+int EndOfFile(int handle)
+{
+	File *file = GetFile(handle, 0);
+
+	if (!file) return -1;
+	return file->pos >= file->size;
+}
+
+int WriteFile(int handle, const char *data, size_t len)
+{
+	File *file = GetFile(handle, 1);
+
+	if (!file) return -1;
+	if (file->len + len > FILEBUFSIZE) {
+		FlushFile(file);
+		/* too large to be worth the copy */
+		if (len > FILEBUFSIZE) {
+			WriteAll(file, data, len);
+			return 0;
+		}
+	}
+	memcpy(file->buf + file->len, data, len);
+	file->len += len;
+	return 0;
+}
+
+unsigned long FileWrites()
+{
+	return Writes;
+}
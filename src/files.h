@@ -0,0 +1,57 @@
+/* files.h - The files the builtins open
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FILES_H
+#define __FILES_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAXFILES 64			/* open at once */
+#define FILEBUFSIZE 65536	/* the buffer of a file written */
+
+/* mode is "r", "w" or "a". Returns the handle, -1 if it can't be opened */
+int OpenFile(const char *path, const char *mode);
+/* 0, -1 if the handle isn't open or the writes fail */
+int CloseFile(int handle);
+/* 'r' or 'w' for an open handle, 0 for another */
+int FileMode(int handle);
+
+/* The next line without its newline, where it is in the file, or the
+ * rest of the file. NULL if the handle isn't open for reading. */
+const char *ReadLine(int handle, size_t *len);
+const char *ReadAll(int handle, size_t *len);
+/* 1 if all was read, -1 if the handle isn't open for reading */
+int EndOfFile(int handle);
+
+/* -1 if the handle isn't open for writing */
+int WriteFile(int handle, const char *data, size_t len);
+/* Counts the opens for writing and the writes to the files, to tell if
+ * a file read before may have changed since */
+unsigned long FileWrites();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,177 +22,582 @@
 #include "vmachine.h"
 #include <time.h>
 #include <stdio.h>
+#include <dlfcn.h>
+
+#include "myl.h"
+#include "output.h"
+#include "files.h"
+#include "strops.h"
+#include "csvscan.h"
 
 //#include "type.h"
 
-FuncInfo Function[]={
-/*Name\param count(-1 means variable params)\return type*/  
-	{"dos",		1,T_INTEGER},
-
-	{"join",	-1,T_STRING},		/* join n strings */
-
-	{"time",	0, T_INTEGER},
-
-	{"acos",	1,T_FLOAT},
-	{"asin",	1,T_FLOAT},
-	{"atan",	1,T_FLOAT},
-	{"ceil",	1,T_FLOAT},
-	{"cos",		1,T_FLOAT},
-	{"cosh",	1,T_FLOAT},
-	{"exp",		1,T_FLOAT},
-	{"fabs",	1,T_FLOAT},
-	{"floor",	1,T_FLOAT},
-	{"fmod",	2,T_FLOAT},
-	{"int",		1,T_FLOAT},
-	{"loge",	1,T_FLOAT},
-	{"log10",	1,T_FLOAT},
-	{"pow",		2,T_FLOAT},
-	{"random",	1,T_FLOAT},
-	{"sin",		1,T_FLOAT},
-	{"sinh",	1,T_FLOAT},
-	{"sqrt",	1,T_FLOAT},
-	{"srandom",	1,T_NULL},
-	{"tan",		1,T_FLOAT},
-	{"tanh",	1,T_FLOAT},
-
-	{"print",	-1,T_INTEGER},
+FuncInfo Function[MAXFUNCS]={
+/*Name\param count(-1 means variable params)\return type\pure\intrinsic*/  
+	{"dos",		1,T_INTEGER,0,0},
+
+	{"join",	-1,T_STRING,0,0},		/* join n strings */
+
+	{"time",	0, T_INTEGER,0,0},
+
+	{"acos",	1,T_FLOAT,1,0},
+	{"asin",	1,T_FLOAT,1,0},
+	{"atan",	1,T_FLOAT,1,0},
+	{"ceil",	1,T_FLOAT,1,CEILF},
+	{"cos",		1,T_FLOAT,1,COSF},
+	{"cosh",	1,T_FLOAT,1,0},
+	{"exp",		1,T_FLOAT,1,EXPF},
+	{"fabs",	1,T_FLOAT,1,FABSF},
+	{"floor",	1,T_FLOAT,1,FLOORF},
+	{"fmod",	2,T_FLOAT,1,0},
+	{"int",		1,T_FLOAT,1,0},
+	{"loge",	1,T_FLOAT,1,0},
+	{"log10",	1,T_FLOAT,1,0},
+	{"pow",		2,T_FLOAT,1,POWF},
+	{"random",	1,T_FLOAT,0,0},
+	{"sin",		1,T_FLOAT,1,SINF},
+	{"sinh",	1,T_FLOAT,1,0},
+	{"sqrt",	1,T_FLOAT,1,SQRTF},
+	{"srandom",	1,T_NULL,0,0},
+	{"tan",		1,T_FLOAT,1,0},
+	{"tanh",	1,T_FLOAT,1,0},
+
+	{"print",	-1,T_INTEGER,0,0},
+	{"open",	2,T_INTEGER,0,0},		/* open(path, "r"|"w"|"a") */
+	{"readline",1,T_STRING,0,0},
+	{"readall",	1,T_STRING,0,0},
+	{"eof",		1,T_INTEGER,0,0},
+	{"write",	-1,T_INTEGER,0,0},		/* write(file, ...) as print */
+	{"close",	1,T_INTEGER,0,0},
+	{"length",	1,T_INTEGER,0,0},
+	{"substr",	3,T_STRING,0,0},		/* substr(s, start, len) */
+	{"find",	-1,T_INTEGER,0,0},		/* find(s, sub[, from]), -1 if not */
+	{"count",	2,T_INTEGER,0,0},		/* count(s, sub) */
+	{"split",	3,T_STRING,0,0},		/* split(s, sep, k), field k from 0 */
+	{"replace",	3,T_STRING,0,0},		/* replace(s, old, new), all of them */
+	{"upper",	1,T_STRING,0,0},
+	{"lower",	1,T_STRING,0,0},
+	{"number",	1,T_FLOAT,0,0},			/* the number in s, 0 if none */
+	{"csvagg",	-1,T_FLOAT,0,0},		/* csvagg(path, col, "sum"...[, sep]) */
+	{"csvcount",-1,T_INTEGER,0,0},		/* csvcount(path, col[, sep]) */
 };
 
-const int FuncCount = sizeof(Function) / sizeof(FuncInfo);
+/* The extensions add theirs after the builtins */
+int FuncCount = BUILTINS;
 
 //static void sql_f(char *sevname,char *username,char *pass,char *cmd, char *retbuf);
 
+/* The value of a pure function of the params in the order of the call,
+ * also used to fold the calls with constant params */
+float EvalPure(int func, const float *param)
+{
+	switch (func) {
+	case ACOS:
+		return (float)acos(param[0]);
+	case ASIN:
+		return (float)asin(param[0]);
+	case ATAN:
+		return (float)atan(param[0]);
+	case CEIL:
+		return (float)ceil(param[0]);
+	case COS:
+		return (float)cos(param[0]);
+	case COSH:
+		return (float)cosh(param[0]);
+	case EXP:
+		return (float)exp(param[0]);
+	case FABS:
+		return (float)fabs(param[0]);
+	case FLOOR:
+		return (float)floor(param[0]);
+	case FMOD:
+		return (float)fmod(param[0],param[1]);
+	case F_INT:
+		return (float)((int)param[0]);
+	case LOGE:
+		return (float)log(param[0]);
+	case LOG10:
+		return (float)log10(param[0]);
+	case POW:
+		return (float)pow(param[0],param[1]);
+	case SIN:
+		return (float)sin(param[0]);
+	case SINH:
+		return (float)sinh(param[0]);
+	case SQRT:
+		return (float)sqrt(param[0]);
+	case TAN:
+		return (float)tan(param[0]);
+	case TANH:
+		return (float)tanh(param[0]);
+	}
+	return 0.0f;
+}
+
+/* The builtin an intrinsic opcode runs, -1 for another opcode */
+int IntrinsicFunc(int op)
+{
+	int i;
+
+	for (i=0; i<FuncCount; i++) {
+		if (Function[i].intrinsic && Function[i].intrinsic==(op & OPMASK))
+			return i;
+	}
+	return -1;
+}
+
+/* The ARG words after the CALL name the params, the ones with FLAG1
+ * hold an immediate which is put in unit */
+static const MemUnit *Param(int i, MemUnit *unit)
+{
+	const Instruction *arg=&VMCode[IP+1+i];
+
+	if (!(arg->op&FLAG1)) return &VMStack[arg->src1.i];
+	if (arg->op&FLFLAG) {
+		unit->tag=T_FLOAT;
+		unit->mem.f=arg->src1.f;
+	}
+	else {
+		unit->tag=T_INTEGER;
+		unit->mem.i=arg->src1.i;
+	}
+	return unit;
+}
+
+static float ParamFloat(int i)
+{
+	const Instruction *arg=&VMCode[IP+1+i];
+
+	if (!(arg->op&FLAG1)) return GetMemFloat(arg->src1.i);
+	return arg->op&FLFLAG ? arg->src1.f : (float)arg->src1.i;
+}
+
+static int ParamInt(int i)
+{
+	const Instruction *arg=&VMCode[IP+1+i];
+
+	if (!(arg->op&FLAG1)) return GetMemInt(arg->src1.i);
+	return arg->op&FLFLAG ? (int)arg->src1.f : arg->src1.i;
+}
+
+/* The file of param 0, open for reading or writing */
+static int ParamFile(int writing)
+{
+	int handle=ParamInt(0);
+
+	if (FileMode(handle)!=(writing ? 'w' : 'r'))
+		VMError(__LINE__, writing ? "Not a file written" : "Not a file read");
+	return handle;
+}
+
+/* The params after the file, formatted as print does */
+static int WriteParams(int argc)
+{
+	char num[NUMBERSIZE];
+	const MemUnit *p;
+	MemUnit unit;
+	int handle=ParamFile(1), len=0, total=0, i;
+
+	for (i=1; i<argc; i++) {
+		p=Param(i, &unit);
+		switch (p->tag) {
+		case T_INTEGER:
+		case T_FLOAT:
+			len=FormatNumber(num, p->tag==T_FLOAT, p->mem.i, p->mem.f);
+			WriteFile(handle, num, len);
+			break;
+		case T_STRING:
+			len=(int)p->mem.str->size();
+			WriteFile(handle, p->mem.str->data(), len);
+			break;
+		default:
+			VMError(__LINE__, "Write error");
+		}
+		total+=len;
+	}
+	return total;
+}
+
+static const StringType *ParamStr(int i, MemUnit *unit)
+{
+	const MemUnit *p=Param(i, unit);
+
+	if (p->tag!=T_STRING) VMError(__LINE__, "Be not a string");
+	return p->mem.str;
+}
+
+/* The string builtins write into the string of the dest slot, which
+ * may be the slot of their first param */
+static void StringResult(int func)
+{
+	MemUnit unit1, unit2, unit3;
+	const StringType *s=ParamStr(0, &unit1), *old, *with;
+	int dest=VMCode[IP].dest;
+	StringType out;
+	size_t len=0;
+	const char *field;
+	long start, at;
+	int n;
+
+	switch (func) {
+	case SUBSTR:
+		start=ParamInt(1);
+		n=ParamInt(2);
+		if (start<0) start=0;
+		if ((size_t)start>s->size() || n<0) n=0;
+		else if ((size_t)n>s->size()-start) n=(int)(s->size()-start);
+		SetMemChars(dest, s->data()+start, n);
+		break;
+	case SPLIT:
+		old=ParamStr(1, &unit2);
+		field=StrField(s->data(), s->size(), old->data(), old->size(), ParamInt(2), &len);
+		SetMemChars(dest, field ? field : "", field ? len : 0);
+		break;
+	case REPLACE:
+		old=ParamStr(1, &unit2);
+		with=ParamStr(2, &unit3);
+		if (old->size()==1 && with->size()==1) {
+			len=s->size();
+			PrepareMem(dest);
+			if (VMMEM(dest).str!=s) VMMEM(dest).str->resize(len);
+			StrReplaceByte(&(*VMMEM(dest).str)[0], s->data(), len, (*old)[0], (*with)[0]);
+			break;
+		}
+		for (start=0; !old->empty()
+			&& (at=StrFind(s->data(), s->size(), old->data(), old->size(), start))>=0;
+			start=at+old->size()) {
+			out.append(*s, start, at-start);
+			out.append(*with);
+		}
+		out.append(*s, start, StringType::npos);
+		PrepareMem(dest);
+		VMMEM(dest).str->swap(out);
+		break;
+	case UPPER:
+	case LOWER:
+		len=s->size();
+		PrepareMem(dest);
+		if (VMMEM(dest).str!=s) VMMEM(dest).str->resize(len);
+		(func==UPPER ? StrUpper : StrLower)(&(*VMMEM(dest).str)[0], s->data(), len);
+		break;
+	}
+}
+
+/* The column of csvagg and csvcount, which have count params or one more
+ * for the separator */
+static void ScanColumn(int argc, int count, CSVStats *stats)
+{
+	MemUnit unit;
+	const StringType *path=ParamStr(0, &unit), *sep;
+	int col=ParamInt(1);
+	char c=',';
+
+	if (argc!=count && argc!=count+1)
+		VMError(__LINE__, "Amount of parameters mismatch");
+	if (argc>count) {
+		sep=ParamStr(count, &unit);
+		if (sep->size()!=1 || (*sep)[0]=='\n' || (*sep)[0]=='"')
+			VMError(__LINE__, "Bad separator");
+		c=(*sep)[0];
+	}
+	if (col<0) VMError(__LINE__, "Bad column");
+	if (!CSVAggregate(path->c_str(), col, c, stats))
+		VMError(__LINE__, "Can't read the file");
+}
+
+static float Aggregate(const StringType &what, const CSVStats *stats)
+{
+	if (what=="sum") return (float)stats->sum;
+	if (what=="min") return (float)stats->min;
+	if (what=="max") return (float)stats->max;
+	if (what=="count") return (float)stats->count;
+	if (what=="mean") return stats->count ? (float)(stats->sum/stats->count) : 0.0f;
+	VMError(__LINE__, "Unknown aggregate");
+	return 0.0f;
+}
+
+/* The params are read in place, an immediate is passed by value */
+static void CallNative(int func, int argc)
+{
+	MYLExtValue params[MYLEXT_MAXPARAMS], ret;
+	const MemUnit *p;
+	MemUnit unit;
+	const char *err;
+	int i;
+
+	if (argc>MYLEXT_MAXPARAMS) VMError(__LINE__, "Too many params");
+	for (i=0; i<argc; i++) {
+		p=Param(i, &unit);
+		params[i].type=p->tag;
+		switch (p->tag) {
+		case T_INTEGER:
+			params[i].u.i=p->mem.i;
+			break;
+		case T_FLOAT:
+			params[i].u.f=p->mem.f;
+			break;
+		case T_STRING:
+			params[i].u.s=p->mem.str->c_str();
+			break;
+		default:
+			VMError(__LINE__, "Access violation.");
+		}
+	}
+	ret.type=Function[func].retval;
+	ret.u.i=0;
+	if (ret.type==T_STRING) ret.u.s="";
+	if ((err=Function[func].native(params, argc, &ret))) VMError(__LINE__, err);
+	switch (Function[func].retval) {
+	case T_INTEGER:
+		SetMemInt(VMCode[IP].dest, ret.type==T_FLOAT ? (int)ret.u.f : ret.u.i);
+		break;
+	case T_FLOAT:
+		SetMemFloat(VMCode[IP].dest, ret.type==T_INTEGER ? (float)ret.u.i : ret.u.f);
+		break;
+	case T_STRING:
+		SetMemStr(VMCode[IP].dest, ret.type==T_STRING && ret.u.s ? ret.u.s : "");
+		break;
+	}
+}
+
+static int RegisterNative(const char *name, int paramcnt, int rettype, MYLExtFunc func)
+{
+	int i;
+
+	if (!name || !func || FuncCount>=MAXFUNCS || paramcnt<-1 || paramcnt>MYLEXT_MAXPARAMS
+		|| rettype<T_NULL || rettype>T_STRING)
+		return 0;
+	for (i=0; i<FuncCount; i++) {
+		if (!strcmp(Function[i].funcname, name)) return 0;
+	}
+	if (!(Function[FuncCount].funcname=strdup(name))) return 0;
+	Function[FuncCount].paramcnt=paramcnt;
+	Function[FuncCount].retval=rettype;
+	Function[FuncCount].pure=0;
+	Function[FuncCount].intrinsic=0;
+	Function[FuncCount].native=func;
+	FuncCount++;
+	return 1;
+}
+
+/* The library stays loaded until the exit */
+int LoadExtension(const char *path)
+{
+	void *lib=dlopen(path, RTLD_NOW|RTLD_LOCAL);
+	MYLExtInit init;
+
+	if (!lib) {
+		printf("Can't load extension %s: %s\n", path, dlerror());
+		return 0;
+	}
+	*(void **)&init=dlsym(lib, MYLEXT_INIT);
+	if (!init) {
+		printf("Extension %s has no %s.\n", path, MYLEXT_INIT);
+		dlclose(lib);
+		return 0;
+	}
+	if (!init(RegisterNative)) {
+		printf("Extension %s failed to start.\n", path);
+		return 0;
+	}
+	return 1;
+}
+
 void DoCall()
  {
 	int srcint1, srcint2;
 	float RetValue = 0.0f;
 	StringType StrValue="";
+	float param[PUREPARAMS];
+	MemUnit unit, sep;
+	const MemUnit *p, *q;
 	int i;
 	int IntValue = -1;
 
 	PrepareInt(VMCode[IP].op, &srcint1, &srcint2);
 	if (Function[srcint1].paramcnt != -1
 		&& srcint2 != Function[srcint1].paramcnt) {
+		FlushOutput();
 		printf ("Amount of parameters mismatch.\n");
 		exit(0);
 	}
+	if (Function[srcint1].native) {
+		CallNative(srcint1, srcint2);
+		IP+=1+srcint2;
+		return;
+	}
 	switch (srcint1) {
 	case DOS:
-		if (VMStack[SP+srcint2-1].tag != T_STRING) 
+		p=Param(0, &unit);
+		if (p->tag != T_STRING) 
 			VMError(__LINE__, "params ERROR");
-		IntValue = system( (VMMEM(SP+srcint2-1).str)->c_str() );
+		/* The command writes after what was printed */
+		FlushOutput();
+		IntValue = system( p->mem.str->c_str() );
 		break;
 	case JOIN:
 		if (srcint2<3)
 			VMError(__LINE__, "Too few params");
-		if (VMStack[SP+srcint2-1].tag!=T_STRING
-			||VMStack[SP+srcint2-2].tag!=T_STRING)
+		p=Param(0, &sep);
+		q=Param(1, &unit);
+		if (p->tag!=T_STRING||q->tag!=T_STRING)
 			VMError(__LINE__, "Be not a string");
-		for ((i=srcint2-3),
-			StrValue+=*VMMEM(SP+srcint2-2).str; i>=0; i--) {
-			if (VMStack[SP+i].tag!=T_STRING)
+		for ((i=2), StrValue+=*q->mem.str; i<srcint2; i++) {
+			q=Param(i, &unit);
+			if (q->tag!=T_STRING)
 				VMError(__LINE__, "Error");
 			else {
-				StrValue+=*VMMEM(SP+srcint2-1).str;
-				StrValue+=*VMMEM(SP+i).str;
+				StrValue+=*p->mem.str;
+				StrValue+=*q->mem.str;
 			}
 		}
 		break;
 	case PRINT:
-		for (i=srcint2-1; i>=0; i--) {
-			switch (VMStack[SP+i].tag) {
+		for (i=0; i<srcint2; i++) {
+			p=Param(i, &unit);
+			switch (p->tag) {
 			case T_INTEGER:
-				printf ("%d", VMMEM(SP+i).i);
+				OutputInt(p->mem.i);
 				break;
 			case T_FLOAT:
-				printf ("%f", VMMEM(SP+i).f);
+				OutputFloat(p->mem.f);
 				break;
 			case T_STRING:
-				printf ("%s", (VMMEM(SP+i).str)->c_str());
+				OutputString(p->mem.str->data(), (int)p->mem.str->size());
 				break;
 			case T_NULL:
 			default:
 				VMError(__LINE__, "Print error");
 			}
 		}
-		printf("\n");
+		OutputLine();
 		IntValue=srcint2;
 		break;
+	case OPEN:
+		p=Param(0, &unit);
+		q=Param(1, &sep);
+		if (p->tag!=T_STRING||q->tag!=T_STRING)
+			VMError(__LINE__, "Be not a string");
+		IntValue=OpenFile(p->mem.str->c_str(), q->mem.str->c_str());
+		break;
+	case READLINE:
+	case READALL:
+		{
+			size_t len;
+			const char *text=srcint1==READLINE ? ReadLine(ParamFile(0), &len)
+				: ReadAll(ParamFile(0), &len);
+			/* Straight from the file into the slot */
+			SetMemChars(VMCode[IP].dest, text, len);
+			IP+=1+srcint2;
+			return;
+		}
+	case FEOF:
+		IntValue=EndOfFile(ParamFile(0));
+		break;
+	case WRITE:
+		if (srcint2<1)
+			VMError(__LINE__, "Too few params");
+		IntValue=WriteParams(srcint2);
+		break;
+	case CLOSE:
+		IntValue=CloseFile(ParamInt(0));
+		break;
+	case LENGTH:
+		IntValue=(int)ParamStr(0, &unit)->size();
+		break;
+	case FIND:
+		if (srcint2<2 || srcint2>3)
+			VMError(__LINE__, "Amount of parameters mismatch");
+		{
+			const StringType *s=ParamStr(0, &unit), *sub=ParamStr(1, &sep);
+			long from=srcint2==3 ? ParamInt(2) : 0;
+
+			IntValue=from<0 ? -1
+				: (int)StrFind(s->data(), s->size(), sub->data(), sub->size(), from);
+		}
+		break;
+	case COUNT:
+		{
+			const StringType *s=ParamStr(0, &unit), *sub=ParamStr(1, &sep);
+
+			IntValue=(int)StrCount(s->data(), s->size(), sub->data(), sub->size());
+		}
+		break;
+	case NUMBER:
+		{
+			const StringType *s=ParamStr(0, &unit);
+			double value;
+
+			if (ParseNumber(s->data(), s->data()+s->size(), &value))
+				RetValue=(float)value;
+		}
+		break;
+	case CSVAGG:
+		{
+			CSVStats stats;
+
+			ScanColumn(srcint2, 3, &stats);
+			RetValue=Aggregate(*ParamStr(2, &unit), &stats);
+		}
+		break;
+	case CSVCOUNT:
+		{
+			CSVStats stats;
+
+			ScanColumn(srcint2, 2, &stats);
+			IntValue=(int)stats.count;
+		}
+		break;
+	case SUBSTR:
+	case SPLIT:
+	case REPLACE:
+	case UPPER:
+	case LOWER:
+		StringResult(srcint1);
+		IP+=1+srcint2;
+		return;
 	case TIME:
 		IntValue=time(0);
 		break;
-	case ACOS:
-		RetValue=(float)acos(GetMemFloat(SP));
+	case RANDOM:
+		RetValue=(float)(int)
+			(rand()*floor(ParamFloat(0))/(RAND_MAX+1.0));
 		break;
-	case ASIN:
-		RetValue=(float)asin(GetMemFloat(SP));
+	case SRANDOM:
+		srand((unsigned)ParamInt(0));
 		break;
+	case ACOS:
+	case ASIN:
 	case ATAN:
-		RetValue=(float)atan(GetMemFloat(SP));
-		break;
 	case CEIL:
-		RetValue=(float)ceil(GetMemFloat(SP));
-		break;
 	case COS:
-		RetValue=(float)cos(GetMemFloat(SP));
-		break;
 	case COSH:
-		RetValue=(float)cosh(GetMemFloat(SP));
-		break;
 	case EXP:
-		RetValue=(float)exp(GetMemFloat(SP));
-		break;
 	case FABS:
-		RetValue=(float)fabs(GetMemFloat(SP));
-		break;
 	case FLOOR:
-		RetValue=(float)floor(GetMemFloat(SP));
-		break;
 	case FMOD:
-		RetValue=(float)fmod(GetMemFloat(SP+1),GetMemFloat(SP));
-		break;
 	case F_INT:
-		RetValue=(float)((int)GetMemFloat(SP));
-		break;
 	case LOGE:
-		RetValue=(float)log(GetMemFloat(SP));
-		break;
 	case LOG10:
-		RetValue=(float)log10(GetMemFloat(SP));
-		break;
 	case POW:
-		RetValue=(float)pow(GetMemFloat(SP+1),GetMemFloat(SP));
-		break;
-	case RANDOM:
-		RetValue=(float)(int)
-			(rand()*floor(GetMemFloat(SP))/(RAND_MAX+1.0));
-		break;
 	case SIN:
-		RetValue=(float)sin(GetMemFloat(SP));
-		break;
 	case SINH:
-		RetValue=(float)sinh(GetMemFloat(SP));
-		break;
 	case SQRT:
-		RetValue=(float)sqrt(GetMemFloat(SP));
-		break;
-	case SRANDOM:
-		srand((unsigned)GetMemInt(SP));
-		break;
 	case TAN:
-		RetValue=(float)tan(GetMemFloat(SP));
-		break;
 	case TANH:
-		RetValue=(float)tanh(GetMemFloat(SP));
+		for (i=0; i<srcint2; i++) param[i]=ParamFloat(i);
+		RetValue=EvalPure(srcint1, param);
 		break;
 /*	ACOS, ASIN, ATAN, CEIL, COS, COSH, EXP, FABS, FLOOR,
 	FMOD,INT,LOGE,LOG10,POW,RANDOM,SIN,SINH,SQRT,SRANDOM,
 	TAN,TANH,*/
 	case UNKNOWN:
+		FlushOutput();
 		printf("Unknown function be called.\n");
 		exit(0);
 		break;
 	default:
+		FlushOutput();
 		printf("Unhandeled function(%d) be called.\n",srcint1);
 		break;
 	}
@@ -207,7 +612,7 @@ void DoCall()
 		SetMemStr(VMCode[IP].dest, StrValue);
 		break;
 	}
-	IP++;
+	IP+=1+srcint2;
 }
 
 
@@ -22,6 +22,8 @@
 #ifndef __FUNCDEFS_H
 #define __FUNCDEFS_H
 
+#include "mylext.h"
+
 /* Change any function ID here, should change the function table in 
  * funcdefs.c accordinglly */
 enum {
@@ -37,6 +39,14 @@ enum {
 	TAN,TANH,
 	/* Standard I/O */
 	PRINT,
+	/* Files */
+	OPEN, READLINE, READALL, FEOF, WRITE, CLOSE,
+	/* Strings */
+	LENGTH, SUBSTR, FIND, COUNT, SPLIT, REPLACE, UPPER, LOWER, NUMBER,
+	/* CSV files */
+	CSVAGG, CSVCOUNT,
+
+	BUILTINS,		/* the count of the builtins */
 
 	UNKNOWN = -1	/* Wrong call */
 };
@@ -47,15 +57,25 @@ typedef struct FuncInfo {
 					/*	amount of params is flexible			*/
 	int retval;		/*	Flag that determine what kind of return	*/
 					/*	value it has									*/
+	int pure;		/*	No side effects, the value depends only	*/
+					/*	on the params								*/
+	int intrinsic;	/*	The opcode that runs it inline, 0 if	*/
+					/*	none										*/
+	MYLExtFunc native;	/*	Of an extension, called by DoCall	*/
 } FuncInfo;
 
+#define PUREPARAMS 2	/* the most params of a pure function */
+#define MAXFUNCS 256	/* the builtins and those of the extensions */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-extern FuncInfo Function[];
-extern const int FuncCount;
+extern FuncInfo Function[MAXFUNCS];
+extern int FuncCount;
 void DoCall();
+float EvalPure(int func, const float *param);
+int IntrinsicFunc(int op);
 
 #ifdef __cplusplus
 }
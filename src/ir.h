@@ -0,0 +1,171 @@
+/* ir.h - SSA intermediate representation of VMCode
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __IR_H
+#define __IR_H
+
+#include "arena.h"
+#include "vmachine.h"
+#include "profile.h"
+
+/* The parsers generate VMCode, irbuild.cpp lifts it into basic blocks in
+ * SSA form, the passes in iropt.cpp work on the blocks and irlower.cpp
+ * assigns the memory slots and generates VMCode again.
+ *
+ * Every memory slot below HEAPSTART, variable or temporary, is renamed
+ * into values that are written once. The slots from HEAPSTART up hold
+ * the string constants and are never written by the code. */
+
+/* Operand kinds */
+enum {
+	IRO_NONE,
+	IRO_VALUE,			/* an SSA value */
+	IRO_INT,			/* immediate */
+	IRO_FLOAT,
+	IRO_MEM,			/* constant memory at HEAPSTART and above */
+	IRO_UNDEF,			/* a slot read before it is written, T_NULL */
+	IRO_SLOT			/* a memory slot, only before the renaming */
+};
+
+typedef struct IROperand {
+	int kind;
+	union {
+		int i;			/* value, slot, address or integer */
+		float f;
+	} u;
+} IROperand;
+
+/* The opcodes are those of the VM with FLFLAG and STRFLAG but without
+ * FLAG1, FLAG2 and FLAG3, which follow from the operand kinds. INC and
+ * DEC read src[0] and define dest. A CALL has the function in src[0]
+ * and its arguments, which are lowered to the ARG words, a CALLU the
+ * address of the ENTER of the function. PARAM and RETU have the type
+ * they convert to in src[1]. A CMOV has no FLFLAG, its condition is in
+ * args[0]. */
+typedef struct IRInst {
+	int op;
+	int dest;			/* value, or slot before the renaming, -1 if none */
+	IROperand src[2];
+	int argc;
+	IROperand *args;
+} IRInst;
+
+typedef struct IRPhi {
+	int dest;
+	int slot;			/* the merged slot */
+	IROperand *args;	/* one for each predecessor */
+} IRPhi;
+
+/* The last instruction of a block is its terminator: JMP to succ[0],
+ * a compare and jump to succ[0] falling through to succ[1], RET or RETU. */
+typedef struct IRBlock {
+	int addr;			/* first instruction in the lifted code */
+	IRInst *insts;
+	int ninsts;
+	IRPhi *phis;
+	int nphis, maxphis;
+	int succ[2];
+	int nsucc;
+	int *preds;
+	int *predslot;		/* the index in succ[] of the predecessor */
+	int npreds;
+	int idom;
+	int rpo;			/* index in IRUnit.order, -1 if unreachable */
+	long count;			/* times it ran in the profile */
+	long taken;			/* of them, times it went to succ[0] */
+} IRBlock;
+
+typedef struct IRValue {
+	int block;			/* defining block */
+	int slot;			/* memory slot assigned by LowerIR */
+} IRValue;
+
+typedef struct IRUnit {
+	Arena *arena;
+	IRBlock *blocks;	/* blocks[0] is the entry */
+	int nblocks;
+	int *order;			/* reachable blocks in reverse post order */
+	int norder;
+	IRValue *values;
+	int nvalues, maxvalues;
+	int nslots;			/* slots below HEAPSTART used by the lifted code */
+	int profiled;		/* the blocks have counts */
+	int slotbase;		/* LowerIR assigns the slots from there */
+	int usedslots;		/* and sets how many it used */
+} IRUnit;
+
+typedef struct IntList {
+	int *data;
+	int n, max;
+} IntList;
+
+#define IsBranch(op) ((op)==JE || (op)==JNE || (op)==JG || (op)==JL \
+	|| (op)==JLE || (op)==JGE)
+#define IsTerminator(op) ((op)==JMP || (op)==RET || (op)==RETU || IsBranch(op))
+#define NEWARRAY(arena, type, count) ((type *)NewArray(arena, count, sizeof(type)))
+
+/* irbuild.cpp, NULL if the code can't be lifted */
+IRUnit *BuildIR(Arena *arena, const Instruction *code, int size, const Profile *profile);
+long EdgeCount(const IRBlock *block, int k);
+int NewValue(IRUnit *ir, int block);
+void UpdateCFG(IRUnit *ir);
+int MergeBlocks(IRUnit *ir);
+void PrunePhis(IRUnit *ir);
+void *NewArray(Arena *arena, int count, size_t size);
+void *GrowArray(Arena *arena, void *data, int *max, size_t size);
+void ListAdd(Arena *arena, IntList *list, int x);
+void DumpIR(FILE *fp, const IRUnit *ir);
+
+/* irconst.cpp */
+int FoldInst(int op, const IROperand *a, const IROperand *b, IROperand *res);
+int PropagateConstants(IRUnit *ir);
+
+/* ircopy.cpp */
+int PropagateCopies(IRUnit *ir);
+
+/* irdce.cpp */
+void FindDefined(const IRUnit *ir, char *defined);
+int IsPure(const IRInst *in, const char *defined);
+int RemoveDeadCode(IRUnit *ir);
+
+/* irloop.cpp */
+int HoistInvariants(IRUnit *ir);
+int UnrollLoops(IRUnit *ir, int factor);
+int ReduceStrength(IRUnit *ir);
+
+/* irvn.cpp */
+int NumberValues(IRUnit *ir);
+
+/* irlower.cpp, the code size or -1 if it doesn't fit */
+int LowerIR(IRUnit *ir, Instruction *code, int maxsize);
+
+/* dispatch.cpp */
+#define MINCASES 4			/* fewer JE stay a chain */
+#define DISPATCHSIZE(n) (2 * (n) + 2)
+int PlanDispatch(Arena *arena, const Instruction *tests, int n, Instruction *code);
+
+/* compact.cpp */
+int CompactCode(Arena *arena, Instruction *code, int size);
+
+/* iropt.cpp */
+int OptimizeCode(Arena *arena, Instruction *code, int size, int level, int unroll,
+	const Profile *profile);
+
+#endif
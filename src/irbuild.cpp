@@ -0,0 +1,848 @@
+/* irbuild.cpp - Lift VMCode into SSA form
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The code is cut into basic blocks at the jump targets and after the
+ * jumps, dominators are computed by the iterative algorithm of Cooper,
+ * Harvey and Kennedy, phis are placed on the dominance frontiers of the
+ * slots that live across blocks and the slots are renamed in a walk of
+ * the dominator tree. The ARG words after a CALL or CALLU are lifted into
+ * its arguments and renamed with it. */
+
+#include "ir.h"
+
+typedef struct UndoEntry {
+	int slot;
+	int old;
+} UndoEntry;
+
+typedef struct Frame {
+	int block;
+	int exit;
+	int undo;			/* undo log position */
+} Frame;
+
+void *NewArray(Arena *arena, int count, size_t size)
+{
+	void *p = ArenaAlloc(arena, count * size + 1);
+	memset(p, 0, count * size);
+	return p;
+}
+
+/* Double the capacity of an array in the arena */
+void *GrowArray(Arena *arena, void *data, int *max, size_t size)
+{
+	int newmax = *max ? *max * 2 : 4;
+	void *p = ArenaAlloc(arena, newmax * size);
+	if (*max) memcpy(p, data, *max * size);
+	*max = newmax;
+	return p;
+}
+
+int NewValue(IRUnit *ir, int block)
+{
+	if (ir->nvalues == ir->maxvalues)
+		ir->values = (IRValue *)GrowArray(ir->arena, ir->values,
+			&ir->maxvalues, sizeof(IRValue));
+	ir->values[ir->nvalues].block = block;
+	ir->values[ir->nvalues].slot = -1;
+	return ir->nvalues++;
+}
+
+static int Operand(const Instruction *inst, int n, IROperand *opd)
+{
+	int flag = n ? FLAG2 : FLAG1;
+	const Instruction::UData *src = n ? &inst->src2 : &inst->src1;
+
+	if ((inst->op & flag) && !(inst->op & STRFLAG)) {
+		if (inst->op & FLFLAG) {
+			opd->kind = IRO_FLOAT;
+			opd->u.f = src->f;
+		}
+		else {
+			opd->kind = IRO_INT;
+			opd->u.i = src->i;
+		}
+		return 1;
+	}
+	if (src->i < 0 || src->i >= STACKSIZE) return 0;
+	opd->kind = src->i < HEAPSTART ? IRO_SLOT : IRO_MEM;
+	opd->u.i = src->i;
+	return 1;
+}
+
+/* Check that the code can be lifted and mark the block leaders */
+static int FindLeaders(const Instruction *code, int size, char *leader)
+{
+	int addr, n;
+
+	leader[0] = 1;
+	for (addr = 0; addr < size; addr++) {
+		const Instruction *inst = &code[addr];
+
+		switch (inst->op & OPMASK) {
+		case JMP:
+		case JE:
+		case JNE:
+		case JG:
+		case JL:
+		case JLE:
+		case JGE:
+			if (!(inst->op & FLAG3) || inst->dest < 0 || inst->dest >= size)
+				return 0;
+			leader[inst->dest] = 1;
+			leader[addr + 1] = 1;
+			break;
+		case RET:
+		case RETU:
+			leader[addr + 1] = 1;
+			break;
+		case CALL:
+		case CALLU:
+			/* The ARG words are a part of the CALL */
+			if ((inst->op & (FLAG1|FLAG2)) != (FLAG1|FLAG2) || inst->src2.i < 0
+				|| inst->src2.i >= size - addr)
+				return 0;
+			for (n = 1; n <= inst->src2.i; n++) {
+				if ((code[addr + n].op & OPMASK) != ARG) return 0;
+			}
+			addr += inst->src2.i;
+			break;
+		case PUSH:
+		case POP:
+			return 0;
+		case NOT:
+			if (inst->op & FLFLAG) return 0;
+			break;
+		case CMOV:
+		case PARAM:
+			break;
+		default:
+			if ((inst->op & OPMASK) > JGE && IntrinsicFunc(inst->op) < 0) return 0;
+		}
+	}
+	/* The code must not run off its end */
+	if (size == 0) return 0;
+	switch (code[size - 1].op & OPMASK) {
+	case JMP:
+	case RET:
+	case RETU:
+		return 1;
+	}
+	return 0;
+}
+
+static int LiftInst(Arena *arena, const Instruction *inst, IRInst *in)
+{
+	int n;
+
+	in->op = inst->op & (OPMASK|FLFLAG|STRFLAG);
+	in->dest = -1;
+	in->src[0].kind = in->src[1].kind = IRO_NONE;
+	in->argc = 0;
+	in->args = 0;
+	switch (inst->op & OPMASK) {
+	case MOV:
+	case NOT:
+	case CNV:
+		if (!Operand(inst, 0, &in->src[0])) return 0;
+		in->dest = inst->dest;
+		break;
+	case INC:
+	case DEC:
+		in->src[0].kind = IRO_SLOT;
+		in->src[0].u.i = inst->dest;
+		in->dest = inst->dest;
+		break;
+	case CALL:
+		in->src[0].kind = IRO_INT;
+		in->src[0].u.i = inst->src1.i;
+		in->argc = inst->src2.i;
+		if (inst->src1.i < 0 || inst->src1.i >= FuncCount) return 0;
+		in->args = NEWARRAY(arena, IROperand, in->argc);
+		for (n = 0; n < in->argc; n++) {
+			if (!Operand(&inst[1 + n], 0, &in->args[n])) return 0;
+		}
+		/* A function without a value leaves dest as it was */
+		if (Function[inst->src1.i].retval != T_NULL) in->dest = inst->dest;
+		break;
+	case CALLU:
+		in->src[0].kind = IRO_INT;
+		in->src[0].u.i = inst->src1.i;
+		in->argc = inst->src2.i;
+		in->args = NEWARRAY(arena, IROperand, in->argc);
+		for (n = 0; n < in->argc; n++) {
+			if (!Operand(&inst[1 + n], 0, &in->args[n])) return 0;
+		}
+		in->dest = inst->dest;
+		break;
+	case PARAM:
+		/* src2 is the type the param is converted to */
+		if (!Operand(inst, 0, &in->src[0]) || !Operand(inst, 1, &in->src[1])) return 0;
+		in->dest = inst->dest;
+		break;
+	case RETU:
+		/* and dest the type of the value */
+		if (!Operand(inst, 0, &in->src[0])) return 0;
+		in->src[1].kind = IRO_INT;
+		in->src[1].u.i = inst->dest;
+		break;
+	case JE:
+	case JNE:
+	case JG:
+	case JL:
+	case JLE:
+	case JGE:
+		if (!Operand(inst, 0, &in->src[0]) || !Operand(inst, 1, &in->src[1]))
+			return 0;
+		break;
+	case JMP:
+	case RET:
+		break;
+	case ARG:
+		/* Only a jump lands on one */
+		return 0;
+	case CMOV:
+		/* The condition is read from dest before it is written */
+		if (!Operand(inst, 0, &in->src[0]) || !Operand(inst, 1, &in->src[1]))
+			return 0;
+		in->op = CMOV;
+		in->argc = 1;
+		in->args = NEWARRAY(arena, IROperand, 1);
+		in->args[0].kind = IRO_SLOT;
+		in->args[0].u.i = inst->dest;
+		in->dest = inst->dest;
+		break;
+	default:
+		if (!Operand(inst, 0, &in->src[0])) return 0;
+		/* An intrinsic of one param has no src2 */
+		if ((IntrinsicFunc(inst->op) < 0 || Function[IntrinsicFunc(inst->op)].paramcnt > 1)
+			&& !Operand(inst, 1, &in->src[1]))
+			return 0;
+		in->dest = inst->dest;
+	}
+	/* Only the constants live above HEAPSTART */
+	if (in->dest >= HEAPSTART || in->dest < -1) return 0;
+	return 1;
+}
+
+static void CountSlot(IRUnit *ir, const IROperand *opd)
+{
+	if (opd->kind == IRO_SLOT && opd->u.i >= ir->nslots) ir->nslots = opd->u.i + 1;
+}
+
+static int LiftBlocks(IRUnit *ir, const Instruction *code, int size,
+	const char *leader, int *blockof, const Profile *profile)
+{
+	int b, addr, end, n, i;
+
+	ir->blocks[0].addr = -1;
+	ir->blocks[0].insts = NEWARRAY(ir->arena, IRInst, 1);
+	ir->blocks[0].ninsts = 1;
+	ir->blocks[0].insts[0].op = JMP;
+	ir->blocks[0].insts[0].dest = -1;
+	ir->blocks[0].succ[0] = blockof[0];
+	ir->blocks[0].nsucc = 1;
+	if (profile) ir->blocks[0].count = profile->count[0];
+
+	for (b = 1; b < ir->nblocks; b++) {
+		IRBlock *block = &ir->blocks[b];
+		const Instruction *last;
+
+		for (end = block->addr + 1; end < size && !leader[end]; end++);
+		block->insts = NEWARRAY(ir->arena, IRInst, end - block->addr + 1);
+		n = 0;
+		for (addr = block->addr; addr < end; addr++) {
+			IRInst *in = &block->insts[n++];
+
+			if (!LiftInst(ir->arena, &code[addr], in)) return 0;
+			CountSlot(ir, &in->src[0]);
+			CountSlot(ir, &in->src[1]);
+			if ((in->op & OPMASK) == CALL || (in->op & OPMASK) == CALLU) {
+				for (i = 0; i < in->argc; i++) CountSlot(ir, &in->args[i]);
+				addr += in->argc;
+			}
+			if (in->dest >= ir->nslots) ir->nslots = in->dest + 1;
+		}
+		last = &code[end - 1];
+		if (profile) {
+			block->count = profile->count[block->addr];
+			block->taken = profile->taken[end - 1];
+		}
+		switch (last->op & OPMASK) {
+		case JMP:
+			block->succ[0] = blockof[last->dest];
+			block->nsucc = 1;
+			break;
+		case JE:
+		case JNE:
+		case JG:
+		case JL:
+		case JLE:
+		case JGE:
+			if (end >= size) return 0;
+			block->succ[0] = blockof[last->dest];
+			block->succ[1] = blockof[end];
+			block->nsucc = 2;
+			break;
+		case RET:
+		case RETU:
+			block->nsucc = 0;
+			break;
+		default:
+			/* Falls through into the next block */
+			if (end >= size) return 0;
+			block->insts[n].op = JMP;
+			block->insts[n].dest = -1;
+			block->insts[n].src[0].kind = block->insts[n].src[1].kind = IRO_NONE;
+			block->insts[n].argc = 0;
+			n++;
+			block->succ[0] = blockof[end];
+			block->nsucc = 1;
+		}
+		block->ninsts = n;
+	}
+	return 1;
+}
+
+/* Reverse post order of the reachable blocks and their predecessors */
+static void OrderBlocks(IRUnit *ir)
+{
+	int *stack = NEWARRAY(ir->arena, int, ir->nblocks);
+	int *next = NEWARRAY(ir->arena, int, ir->nblocks);
+	int *count = NEWARRAY(ir->arena, int, ir->nblocks);
+	int sp = 0, n = ir->nblocks, b, k, i;
+
+	for (b = 0; b < ir->nblocks; b++) ir->blocks[b].rpo = -1;
+	ir->order = NEWARRAY(ir->arena, int, ir->nblocks);
+	stack[sp++] = 0;
+	ir->blocks[0].rpo = 0;
+	while (sp) {
+		IRBlock *block = &ir->blocks[stack[sp - 1]];
+
+		if (next[stack[sp - 1]] < block->nsucc) {
+			int s = block->succ[next[stack[sp - 1]]++];
+			if (ir->blocks[s].rpo == -1) {
+				ir->blocks[s].rpo = 0;
+				stack[sp++] = s;
+			}
+		}
+		else ir->order[--n] = stack[--sp];
+	}
+	/* Move the order to the front */
+	ir->norder = ir->nblocks - n;
+	memmove(ir->order, ir->order + n, ir->norder * sizeof(int));
+	for (i = 0; i < ir->norder; i++) ir->blocks[ir->order[i]].rpo = i;
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+		for (k = 0; k < block->nsucc; k++) count[block->succ[k]]++;
+	}
+	for (b = 0; b < ir->nblocks; b++) {
+		ir->blocks[b].preds = NEWARRAY(ir->arena, int, count[b]);
+		ir->blocks[b].predslot = NEWARRAY(ir->arena, int, count[b]);
+		ir->blocks[b].npreds = 0;
+	}
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+		for (k = 0; k < block->nsucc; k++) {
+			IRBlock *succ = &ir->blocks[block->succ[k]];
+			succ->preds[succ->npreds] = ir->order[i];
+			succ->predslot[succ->npreds++] = k;
+		}
+	}
+}
+
+static int Intersect(const IRUnit *ir, int b1, int b2)
+{
+	while (b1 != b2) {
+		while (ir->blocks[b1].rpo > ir->blocks[b2].rpo) b1 = ir->blocks[b1].idom;
+		while (ir->blocks[b2].rpo > ir->blocks[b1].rpo) b2 = ir->blocks[b2].idom;
+	}
+	return b1;
+}
+
+static void FindDominators(IRUnit *ir)
+{
+	int i, j, changed = 1;
+
+	for (i = 0; i < ir->nblocks; i++) ir->blocks[i].idom = -1;
+	ir->blocks[0].idom = 0;
+	while (changed) {
+		changed = 0;
+		for (i = 1; i < ir->norder; i++) {
+			IRBlock *block = &ir->blocks[ir->order[i]];
+			int idom = -1;
+
+			for (j = 0; j < block->npreds; j++) {
+				int p = block->preds[j];
+				if (ir->blocks[p].idom == -1) continue;
+				idom = idom == -1 ? p : Intersect(ir, p, idom);
+			}
+			if (block->idom != idom) {
+				block->idom = idom;
+				changed = 1;
+			}
+		}
+	}
+}
+
+void ListAdd(Arena *arena, IntList *list, int x)
+{
+	if (list->n == list->max)
+		list->data = (int *)GrowArray(arena, list->data, &list->max, sizeof(int));
+	list->data[list->n++] = x;
+}
+
+static void AddPhi(IRUnit *ir, int b, int slot)
+{
+	IRBlock *block = &ir->blocks[b];
+	IRPhi *phi;
+	int i;
+
+	if (block->nphis == block->maxphis)
+		block->phis = (IRPhi *)GrowArray(ir->arena, block->phis,
+			&block->maxphis, sizeof(IRPhi));
+	phi = &block->phis[block->nphis++];
+	phi->dest = -1;
+	phi->slot = slot;
+	phi->args = NEWARRAY(ir->arena, IROperand, block->npreds);
+	for (i = 0; i < block->npreds; i++) phi->args[i].kind = IRO_UNDEF;
+}
+
+/* Phis for the slots read in a block before they are written there */
+static void PlacePhis(IRUnit *ir)
+{
+	Arena *arena = ir->arena;
+	IntList *frontier = NEWARRAY(arena, IntList, ir->nblocks);
+	IntList *defs = NEWARRAY(arena, IntList, ir->nslots);
+	IntList work = {0, 0, 0};
+	char *global = NEWARRAY(arena, char, ir->nslots);
+	int *stamp = NEWARRAY(arena, int, ir->nslots);
+	int *hasphi = NEWARRAY(arena, int, ir->nblocks);
+	int *inwork = NEWARRAY(arena, int, ir->nblocks);
+	int i, j, k, b, s;
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+
+		if (block->npreds < 2) continue;
+		for (j = 0; j < block->npreds; j++) {
+			int runner = block->preds[j];
+			while (runner != block->idom) {
+				IntList *df = &frontier[runner];
+				if (!df->n || df->data[df->n - 1] != ir->order[i])
+					ListAdd(arena, df, ir->order[i]);
+				runner = ir->blocks[runner].idom;
+			}
+		}
+	}
+
+	for (s = 0; s < ir->nslots; s++) stamp[s] = -1;
+	for (i = 0; i < ir->norder; i++) {
+		b = ir->order[i];
+		for (j = 0; j < ir->blocks[b].ninsts; j++) {
+			IRInst *in = &ir->blocks[b].insts[j];
+			for (k = 0; k < 2 + in->argc; k++) {
+				const IROperand *opd = k < 2 ? &in->src[k] : &in->args[k - 2];
+				if (opd->kind == IRO_SLOT && stamp[opd->u.i] != b) global[opd->u.i] = 1;
+			}
+			if (in->dest >= 0 && stamp[in->dest] != b) {
+				stamp[in->dest] = b;
+				ListAdd(arena, &defs[in->dest], b);
+			}
+		}
+	}
+
+	for (b = 0; b < ir->nblocks; b++) hasphi[b] = inwork[b] = -1;
+	for (s = 0; s < ir->nslots; s++) {
+		if (!global[s]) continue;
+		work.n = 0;
+		for (i = 0; i < defs[s].n; i++) {
+			ListAdd(arena, &work, defs[s].data[i]);
+			inwork[defs[s].data[i]] = s;
+		}
+		while (work.n) {
+			b = work.data[--work.n];
+			for (i = 0; i < frontier[b].n; i++) {
+				int d = frontier[b].data[i];
+				if (hasphi[d] == s) continue;
+				AddPhi(ir, d, s);
+				hasphi[d] = s;
+				if (inwork[d] != s) {
+					inwork[d] = s;
+					ListAdd(arena, &work, d);
+				}
+			}
+		}
+	}
+}
+
+static void Rename(IRUnit *ir)
+{
+	Arena *arena = ir->arena;
+	int *cur = NEWARRAY(arena, int, ir->nslots);
+	int *child = NEWARRAY(arena, int, ir->nblocks);
+	int *sibling = NEWARRAY(arena, int, ir->nblocks);
+	Frame *frames = NEWARRAY(arena, Frame, ir->nblocks * 2 + 1);
+	UndoEntry *undo = 0;
+	int nundo = 0, maxundo = 0, nframes = 0;
+	int i, j, k, s;
+
+	for (s = 0; s < ir->nslots; s++) cur[s] = -1;
+	for (i = 0; i < ir->nblocks; i++) child[i] = sibling[i] = -1;
+	for (i = ir->norder - 1; i > 0; i--) {
+		int b = ir->order[i], idom = ir->blocks[b].idom;
+		sibling[b] = child[idom];
+		child[idom] = b;
+	}
+
+	frames[nframes].block = 0;
+	frames[nframes++].exit = 0;
+	while (nframes) {
+		Frame frame = frames[--nframes];
+		IRBlock *block = &ir->blocks[frame.block];
+
+		if (frame.exit) {
+			while (nundo > frame.undo) {
+				nundo--;
+				cur[undo[nundo].slot] = undo[nundo].old;
+			}
+			continue;
+		}
+		frame.undo = nundo;
+
+		for (i = 0; i < block->nphis + block->ninsts; i++) {
+			IRInst *in = i < block->nphis ? 0 : &block->insts[i - block->nphis];
+			int slot = in ? in->dest : block->phis[i].slot;
+			int v;
+
+			if (in) {
+				/* The args of a CALL or CMOV are read too */
+				for (k = 0; k < 2 + (in->args ? in->argc : 0); k++) {
+					IROperand *opd = k < 2 ? &in->src[k] : &in->args[k - 2];
+					if (opd->kind != IRO_SLOT) continue;
+					if (cur[opd->u.i] == -1) opd->kind = IRO_UNDEF;
+					else {
+						opd->kind = IRO_VALUE;
+						opd->u.i = cur[opd->u.i];
+					}
+				}
+			}
+			if (slot < 0) continue;
+			v = NewValue(ir, frame.block);
+			if (nundo == maxundo)
+				undo = (UndoEntry *)GrowArray(arena, undo, &maxundo, sizeof(UndoEntry));
+			undo[nundo].slot = slot;
+			undo[nundo++].old = cur[slot];
+			cur[slot] = v;
+			if (in) in->dest = v;
+			else block->phis[i].dest = v;
+		}
+
+		for (k = 0; k < block->nsucc; k++) {
+			IRBlock *succ = &ir->blocks[block->succ[k]];
+			for (j = 0; j < succ->npreds; j++) {
+				if (succ->preds[j] == frame.block && succ->predslot[j] == k) break;
+			}
+			for (i = 0; i < succ->nphis; i++) {
+				IROperand *arg = &succ->phis[i].args[j];
+				int v = cur[succ->phis[i].slot];
+				if (v != -1) {
+					arg->kind = IRO_VALUE;
+					arg->u.i = v;
+				}
+			}
+		}
+
+		frame.exit = 1;
+		frames[nframes++] = frame;
+		for (i = child[frame.block]; i != -1; i = sibling[i]) {
+			frames[nframes].block = i;
+			frames[nframes++].exit = 0;
+		}
+	}
+}
+
+static IROperand Resolve(const IROperand *repl, IROperand opd)
+{
+	while (opd.kind == IRO_VALUE && repl[opd.u.i].kind != IRO_NONE)
+		opd = repl[opd.u.i];
+	return opd;
+}
+
+static int SameOperand(const IROperand *a, const IROperand *b)
+{
+	if (a->kind != b->kind) return 0;
+	if (a->kind == IRO_UNDEF) return 1;
+	return a->u.i == b->u.i;
+}
+
+/* Remove the phis whose arguments are all the same and the phis that
+ * are not used */
+void PrunePhis(IRUnit *ir)
+{
+	IROperand *repl = NEWARRAY(ir->arena, IROperand, ir->nvalues);
+	char *live = NEWARRAY(ir->arena, char, ir->nvalues);
+	int *work = NEWARRAY(ir->arena, int, ir->nvalues);
+	int i, j, k, n, nwork = 0, changed = 1;
+
+	while (changed) {
+		changed = 0;
+		for (i = 0; i < ir->norder; i++) {
+			IRBlock *block = &ir->blocks[ir->order[i]];
+			for (j = 0; j < block->nphis; j++) {
+				IRPhi *phi = &block->phis[j];
+				IROperand same, arg;
+
+				if (repl[phi->dest].kind != IRO_NONE) continue;
+				same.kind = IRO_NONE;
+				for (k = 0; k < block->npreds; k++) {
+					arg = Resolve(repl, phi->args[k]);
+					if (arg.kind == IRO_VALUE && arg.u.i == phi->dest) continue;
+					if (same.kind == IRO_NONE) same = arg;
+					else if (!SameOperand(&same, &arg)) break;
+				}
+				if (k < block->npreds) continue;
+				if (same.kind == IRO_NONE) same.kind = IRO_UNDEF;
+				repl[phi->dest] = same;
+				changed = 1;
+			}
+		}
+	}
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+		for (j = 0; j < block->nphis; j++) {
+			for (k = 0; k < block->npreds; k++)
+				block->phis[j].args[k] = Resolve(repl, block->phis[j].args[k]);
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			IRInst *in = &block->insts[j];
+			for (k = 0; k < 2; k++) {
+				in->src[k] = Resolve(repl, in->src[k]);
+				if (in->src[k].kind == IRO_VALUE && !live[in->src[k].u.i]) {
+					live[in->src[k].u.i] = 1;
+					work[nwork++] = in->src[k].u.i;
+				}
+			}
+			for (k = 0; k < in->argc; k++) {
+				in->args[k] = Resolve(repl, in->args[k]);
+				if (in->args[k].kind == IRO_VALUE && !live[in->args[k].u.i]) {
+					live[in->args[k].u.i] = 1;
+					work[nwork++] = in->args[k].u.i;
+				}
+			}
+		}
+	}
+
+	/* A phi is live if a live value uses it */
+	while (nwork) {
+		int v = work[--nwork];
+		IRBlock *block = &ir->blocks[ir->values[v].block];
+		for (j = 0; j < block->nphis; j++) {
+			if (block->phis[j].dest != v) continue;
+			for (k = 0; k < block->npreds; k++) {
+				IROperand *arg = &block->phis[j].args[k];
+				if (arg->kind == IRO_VALUE && !live[arg->u.i]) {
+					live[arg->u.i] = 1;
+					work[nwork++] = arg->u.i;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+		for (j = n = 0; j < block->nphis; j++) {
+			if (repl[block->phis[j].dest].kind == IRO_NONE && live[block->phis[j].dest])
+				block->phis[n++] = block->phis[j];
+		}
+		block->nphis = n;
+	}
+}
+
+IRUnit *BuildIR(Arena *arena, const Instruction *code, int size, const Profile *profile)
+{
+	IRUnit *ir;
+	char *leader = NEWARRAY(arena, char, size + 1);
+	int *blockof = NEWARRAY(arena, int, size + 1);
+	int addr, n;
+
+	if (!FindLeaders(code, size, leader)) return NULL;
+
+	ir = NEWARRAY(arena, IRUnit, 1);
+	ir->arena = arena;
+	for (addr = 0, n = 1; addr < size; addr++) {
+		if (leader[addr]) blockof[addr] = n++;
+	}
+	ir->nblocks = n;
+	ir->blocks = NEWARRAY(arena, IRBlock, n);
+	for (addr = 0; addr < size; addr++) {
+		if (leader[addr]) ir->blocks[blockof[addr]].addr = addr;
+	}
+	ir->profiled = profile != NULL;
+	if (!LiftBlocks(ir, code, size, leader, blockof, profile)) return NULL;
+
+	OrderBlocks(ir);
+	FindDominators(ir);
+	PlacePhis(ir);
+	Rename(ir);
+	PrunePhis(ir);
+	return ir;
+}
+
+/* The times edge k of the block was taken in the profile */
+long EdgeCount(const IRBlock *block, int k)
+{
+	if (block->nsucc < 2) return block->count;
+	return k ? block->count - block->taken : block->taken;
+}
+
+/* Recompute the order, predecessors and dominators after a pass changed
+ * the successors. Both edges from a block carry the same phi arguments,
+ * so the arguments follow the predecessor. A new edge into a block with
+ * phis must be given its arguments by the pass. */
+void UpdateCFG(IRUnit *ir)
+{
+	int **oldpreds = NEWARRAY(ir->arena, int *, ir->nblocks);
+	int *oldcount = NEWARRAY(ir->arena, int, ir->nblocks);
+	int b, i, j, k;
+
+	for (b = 0; b < ir->nblocks; b++) {
+		oldpreds[b] = ir->blocks[b].preds;
+		oldcount[b] = ir->blocks[b].npreds;
+	}
+	OrderBlocks(ir);
+	FindDominators(ir);
+	for (i = 0; i < ir->norder; i++) {
+		b = ir->order[i];
+		IRBlock *block = &ir->blocks[b];
+
+		for (j = 0; j < block->nphis; j++) {
+			IROperand *args = NEWARRAY(ir->arena, IROperand, block->npreds);
+			for (k = 0; k < block->npreds; k++) {
+				int old;
+				for (old = 0; old < oldcount[b] && oldpreds[b][old] != block->preds[k]; old++);
+				if (old < oldcount[b]) args[k] = block->phis[j].args[old];
+				else args[k].kind = IRO_UNDEF;
+			}
+			block->phis[j].args = args;
+		}
+	}
+	PrunePhis(ir);
+}
+
+/* Append a block that is only entered from the jump at the end of
+ * another to that block. Returns the number of blocks merged. */
+int MergeBlocks(IRUnit *ir)
+{
+	int merged = 0, i, j, k;
+
+	for (i = 0; i < ir->norder; i++) {
+		int b = ir->order[i], s;
+		IRBlock *block = &ir->blocks[b];
+
+		while ((block->insts[block->ninsts - 1].op & OPMASK) == JMP
+			&& (s = block->succ[0]) != b && s != 0 && ir->blocks[s].npreds == 1) {
+			IRBlock *succ = &ir->blocks[s];
+			IRInst *insts = NEWARRAY(ir->arena, IRInst, block->ninsts - 1 + succ->ninsts);
+
+			memcpy(insts, block->insts, (block->ninsts - 1) * sizeof(IRInst));
+			memcpy(insts + block->ninsts - 1, succ->insts, succ->ninsts * sizeof(IRInst));
+			for (j = 0; j < succ->ninsts; j++) {
+				if (succ->insts[j].dest >= 0) ir->values[succ->insts[j].dest].block = b;
+			}
+			block->insts = insts;
+			block->ninsts += succ->ninsts - 1;
+			block->nsucc = succ->nsucc;
+			block->taken = succ->taken;
+			/* The successors keep their phi arguments, see UpdateCFG */
+			for (k = 0; k < succ->nsucc; k++) {
+				IRBlock *next = &ir->blocks[succ->succ[k]];
+				block->succ[k] = succ->succ[k];
+				for (j = 0; j < next->npreds; j++) {
+					if (next->preds[j] == s) next->preds[j] = b;
+				}
+			}
+			succ->npreds = 0;
+			succ->nsucc = 0;
+			merged++;
+		}
+	}
+	if (merged) UpdateCFG(ir);
+	return merged;
+}
+
+static void DumpOperand(FILE *fp, const IROperand *opd)
+{
+	switch (opd->kind) {
+	case IRO_VALUE:
+		fprintf(fp, " v%d", opd->u.i);
+		break;
+	case IRO_INT:
+		fprintf(fp, " #%d", opd->u.i);
+		break;
+	case IRO_FLOAT:
+		fprintf(fp, " #%g", opd->u.f);
+		break;
+	case IRO_MEM:
+		fprintf(fp, " [%X]", opd->u.i);
+		break;
+	case IRO_UNDEF:
+		fprintf(fp, " undef");
+		break;
+	case IRO_SLOT:
+		fprintf(fp, " (%X)", opd->u.i);
+		break;
+	}
+}
+
+void DumpIR(FILE *fp, const IRUnit *ir)
+{
+	int i, j, k;
+
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[ir->order[i]];
+
+		fprintf(fp, "B%d [%4.4X] idom B%d preds", ir->order[i], block->addr,
+			block->idom);
+		for (j = 0; j < block->npreds; j++) fprintf(fp, " B%d", block->preds[j]);
+		fprintf(fp, "\n");
+		for (j = 0; j < block->nphis; j++) {
+			fprintf(fp, "\tv%d = phi", block->phis[j].dest);
+			for (k = 0; k < block->npreds; k++) DumpOperand(fp, &block->phis[j].args[k]);
+			fprintf(fp, "\n");
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+
+			fprintf(fp, "\t");
+			if (in->dest >= 0) fprintf(fp, "v%d = ", in->dest);
+			if (in->op & FLFLAG) fprintf(fp, "F");
+			if (in->op & STRFLAG) fprintf(fp, "S");
+			fprintf(fp, "%s", GetOpName(in->op));
+			for (k = 0; k < 2; k++) DumpOperand(fp, &in->src[k]);
+			for (k = 0; k < in->argc; k++) DumpOperand(fp, &in->args[k]);
+			for (k = 0; IsTerminator(in->op & OPMASK) && k < block->nsucc; k++)
+				fprintf(fp, " B%d", block->succ[k]);
+			fprintf(fp, "\n");
+		}
+	}
+}
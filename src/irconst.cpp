@@ -0,0 +1,484 @@
+/* irconst.cpp - Propagate and fold constants in the SSA form
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Sparse conditional constant propagation: a value is unknown until an
+ * executable definition gives it a constant, and varying once two
+ * constants meet. A phi only meets the edges found executable, a branch
+ * on constants makes only one of its edges executable. The blocks are
+ * swept in reverse post order until nothing changes.
+ *
+ * The folding does what the VM would do, in int or float by FLFLAG, and
+ * leaves anything that would stop the VM alone: a division by zero, a
+ * float that doesn't fit an int, a read of an undefined value. A pure
+ * builtin with constant params is evaluated by EvalPure like DoCall. */
+
+#include "ir.h"
+#include "funcdefs.h"
+
+enum {
+	UNDECIDED,
+	CONSTANT,
+	VARYING
+};
+
+typedef struct Cell {
+	int state;
+	IROperand c;		/* IRO_INT or IRO_FLOAT, the type the VM would tag */
+} Cell;
+
+/* The value as GetMemInt would read it */
+static int ReadInt(const IROperand *c, int *x)
+{
+	if (c->kind == IRO_INT) {
+		*x = c->u.i;
+		return 1;
+	}
+	if (!(c->u.f >= -2147483648.0f && c->u.f < 2147483648.0f)) return 0;
+	*x = (int)c->u.f;
+	return 1;
+}
+
+/* The value as GetMemFloat would read it */
+static float ReadFloat(const IROperand *c)
+{
+	return c->kind == IRO_INT ? (float)c->u.i : c->u.f;
+}
+
+static void SetInt(IROperand *res, int x)
+{
+	res->kind = IRO_INT;
+	res->u.i = x;
+}
+
+static void SetFloat(IROperand *res, float f)
+{
+	res->kind = IRO_FLOAT;
+	res->u.f = f;
+}
+
+static int FoldFloat(int op, float x, float y, IROperand *res)
+{
+	float param[PUREPARAMS];
+	int func;
+
+	switch (op) {
+	case ADD:		SetFloat(res, x + y); break;
+	case SUB:		SetFloat(res, x - y); break;
+	case MUL:		SetFloat(res, x * y); break;
+	case DIV:
+		if (y == 0) return 0;
+		SetFloat(res, x / y);
+		break;
+	case MOD:
+		if (y == 0) return 0;
+		SetFloat(res, (float)fmod(x, y));
+		break;
+	case NOTEQU:	SetInt(res, x != y); break;
+	case EQU:		SetInt(res, x == y); break;
+	case LESS:		SetInt(res, x < y); break;
+	case LE:		SetInt(res, x <= y); break;
+	case GREAT:		SetInt(res, x > y); break;
+	case GE:		SetInt(res, x >= y); break;
+	default:
+		/* An intrinsic folds as its builtin */
+		if ((func = IntrinsicFunc(op)) < 0) return 0;
+		param[0] = x;
+		param[1] = y;
+		SetFloat(res, EvalPure(func, param));
+	}
+	return 1;
+}
+
+static int FoldInt(int op, int x, int y, IROperand *res)
+{
+	unsigned ux = (unsigned)x, uy = (unsigned)y;
+
+	switch (op) {
+	case ADD:		SetInt(res, (int)(ux + uy)); break;
+	case SUB:		SetInt(res, (int)(ux - uy)); break;
+	case MUL:		SetInt(res, (int)(ux * uy)); break;
+	case DIV:
+		if (y == 0 || (x == INT_MIN && y == -1)) return 0;
+		SetInt(res, x / y);
+		break;
+	case MOD:
+		if (y == 0 || (x == INT_MIN && y == -1)) return 0;
+		SetInt(res, x % y);
+		break;
+	case OR:		SetInt(res, x | y); break;
+	case AND:		SetInt(res, x & y); break;
+	case XOR:		SetInt(res, x ^ y); break;
+	case SHL:
+		if (y < 0 || y > 31) return 0;
+		SetInt(res, (int)(ux << y));
+		break;
+	case SHR:
+		if (y < 0 || y > 31) return 0;
+		SetInt(res, x >> y);
+		break;
+	case NOTEQU:	SetInt(res, x != y); break;
+	case EQU:		SetInt(res, x == y); break;
+	case LESS:		SetInt(res, x < y); break;
+	case LE:		SetInt(res, x <= y); break;
+	case GREAT:		SetInt(res, x > y); break;
+	case GE:		SetInt(res, x >= y); break;
+	default:
+		return 0;
+	}
+	return 1;
+}
+
+/* Fold an instruction on constant operands, 0 if the VM must run it */
+int FoldInst(int op, const IROperand *a, const IROperand *b, IROperand *res)
+{
+	int x, y;
+
+	if (op & STRFLAG) return 0;
+	switch (op & OPMASK) {
+	case MOV:
+		*res = *a;
+		return 1;
+	case INC:
+	case DEC:
+		if (op & FLFLAG) {
+			SetFloat(res, ReadFloat(a) + ((op & OPMASK) == INC ? 1 : -1));
+			return 1;
+		}
+		if (!ReadInt(a, &x)) return 0;
+		SetInt(res, (int)((unsigned)x + ((op & OPMASK) == INC ? 1u : -1u)));
+		return 1;
+	case CNV:
+		if (op & FLFLAG) {
+			IROperand f;
+			SetFloat(&f, ReadFloat(a));
+			if (!ReadInt(&f, &x)) return 0;
+			SetInt(res, x);
+		}
+		else {
+			if (!ReadInt(a, &x)) return 0;
+			SetFloat(res, (float)x);
+		}
+		return 1;
+	case NOT:
+		if ((op & FLFLAG) || !ReadInt(a, &x)) return 0;
+		SetInt(res, ~x);
+		return 1;
+	}
+	if (op & FLFLAG) return FoldFloat(op & OPMASK, ReadFloat(a), ReadFloat(b), res);
+	if (!ReadInt(a, &x) || !ReadInt(b, &y)) return 0;
+	return FoldInt(op & OPMASK, x, y, res);
+}
+
+/* A branch on constants, 1 if taken, 0 if not, -1 if unknown */
+static int FoldBranch(int op, const IROperand *a, const IROperand *b)
+{
+	static const int compare[] = {EQU, NOTEQU, GREAT, LESS, LE, GE};
+	IROperand res;
+	int i;
+
+	switch (op & OPMASK) {
+	case JE:	i = 0; break;
+	case JNE:	i = 1; break;
+	case JG:	i = 2; break;
+	case JL:	i = 3; break;
+	case JLE:	i = 4; break;
+	default:	i = 5;
+	}
+	if (!FoldInst((op & ~OPMASK) | compare[i], a, b, &res)) return -1;
+	return res.u.i;
+}
+
+/* The constant as an operand of op, converted to the type op reads */
+static int Immediate(int op, const IROperand *c, IROperand *imm)
+{
+	int x;
+
+	if (op & STRFLAG) return 0;
+	switch (op & OPMASK) {
+	case MOV:
+	case RETU:
+		*imm = *c;
+		return 1;
+	case INC:
+	case DEC:
+		return 0;
+	}
+	if (op & FLFLAG) {
+		SetFloat(imm, ReadFloat(c));
+		return 1;
+	}
+	if (!ReadInt(c, &x)) return 0;
+	SetInt(imm, x);
+	return 1;
+}
+
+static Cell OperandCell(const Cell *cells, const IROperand *opd)
+{
+	Cell cell;
+
+	switch (opd->kind) {
+	case IRO_VALUE:
+		return cells[opd->u.i];
+	case IRO_INT:
+	case IRO_FLOAT:
+		cell.state = CONSTANT;
+		cell.c = *opd;
+		return cell;
+	}
+	/* Strings and undefined values */
+	cell.state = VARYING;
+	return cell;
+}
+
+static int SameConstant(const IROperand *a, const IROperand *b)
+{
+	return a->kind == b->kind && a->u.i == b->u.i;
+}
+
+/* Lower the cell of v, 1 if it changed */
+static int Meet(Cell *cells, int v, const Cell *cell)
+{
+	Cell *old = &cells[v];
+
+	if (cell->state == UNDECIDED || old->state == VARYING) return 0;
+	if (old->state == UNDECIDED) {
+		*old = *cell;
+		return 1;
+	}
+	if (cell->state == CONSTANT && SameConstant(&old->c, &cell->c)) return 0;
+	old->state = VARYING;
+	return 1;
+}
+
+/* A pure builtin reads its params as GetMemFloat does, with the count
+ * DoCall checks */
+static Cell EvalCall(const Cell *cells, const IRInst *in)
+{
+	const FuncInfo *func = &Function[in->src[0].u.i];
+	float param[PUREPARAMS];
+	Cell arg, cell;
+	int k;
+
+	cell.state = VARYING;
+	if (!func->pure || func->retval != T_FLOAT || in->argc != func->paramcnt
+		|| in->argc > PUREPARAMS)
+		return cell;
+	for (k = 0; k < in->argc; k++) {
+		arg = OperandCell(cells, &in->args[k]);
+		if (arg.state != CONSTANT) {
+			cell.state = arg.state;
+			return cell;
+		}
+		param[k] = ReadFloat(&arg.c);
+	}
+	cell.state = CONSTANT;
+	SetFloat(&cell.c, EvalPure(in->src[0].u.i, param));
+	return cell;
+}
+
+/* A CMOV on a constant condition is the side it picks */
+static Cell EvalSelect(const Cell *cells, const IRInst *in)
+{
+	Cell cond = OperandCell(cells, &in->args[0]), a, b;
+
+	if (cond.state == UNDECIDED) return cond;
+	a = OperandCell(cells, &in->src[0]);
+	b = OperandCell(cells, &in->src[1]);
+	if (cond.state == CONSTANT && cond.c.kind == IRO_INT) return cond.c.u.i ? a : b;
+	if (a.state == VARYING || b.state == VARYING) a.state = VARYING;
+	else if (b.state == UNDECIDED) a = b;
+	else if (a.state == CONSTANT && !SameConstant(&a.c, &b.c)) a.state = VARYING;
+	return a;
+}
+
+static Cell EvalInst(const Cell *cells, const IRInst *in)
+{
+	Cell a, b, cell;
+
+	cell.state = VARYING;
+	a = OperandCell(cells, &in->src[0]);
+	if (in->src[1].kind != IRO_NONE) b = OperandCell(cells, &in->src[1]);
+	else b = a;
+	if (a.state == VARYING || b.state == VARYING) return cell;
+	if (a.state == UNDECIDED || b.state == UNDECIDED) {
+		cell.state = UNDECIDED;
+		return cell;
+	}
+	if (FoldInst(in->op, &a.c, &b.c, &cell.c)) cell.state = CONSTANT;
+	return cell;
+}
+
+/* Mark the executable edges of a block, 1 if one is new */
+static int EvalBranch(const IRUnit *ir, const Cell *cells, int b, char *edges)
+{
+	const IRBlock *block = &ir->blocks[b];
+	const IRInst *in = &block->insts[block->ninsts - 1];
+	int taken = -1, changed = 0, k;
+	Cell x, y;
+
+	switch (in->op & OPMASK) {
+	case RET:
+		return 0;
+	case JE:
+	case JNE:
+	case JG:
+	case JL:
+	case JLE:
+	case JGE:
+		x = OperandCell(cells, &in->src[0]);
+		y = OperandCell(cells, &in->src[1]);
+		if (x.state == UNDECIDED || y.state == UNDECIDED) return 0;
+		if (x.state == CONSTANT && y.state == CONSTANT)
+			taken = FoldBranch(in->op, &x.c, &y.c);
+		break;
+	}
+	for (k = 0; k < block->nsucc; k++) {
+		/* succ[0] is the taken edge of a branch */
+		if (taken == 1 && k == 1) continue;
+		if (taken == 0 && k == 0) continue;
+		if (!edges[2 * b + k]) {
+			edges[2 * b + k] = 1;
+			changed = 1;
+		}
+	}
+	return changed;
+}
+
+static void Propagate(const IRUnit *ir, Cell *cells, char *edges, char *reached)
+{
+	int changed = 1, i, j, k;
+
+	reached[0] = 1;
+	while (changed) {
+		changed = 0;
+		for (i = 0; i < ir->norder; i++) {
+			int b = ir->order[i];
+			const IRBlock *block = &ir->blocks[b];
+
+			if (!reached[b]) {
+				for (k = 0; k < block->npreds; k++) {
+					if (edges[2 * block->preds[k] + block->predslot[k]]) reached[b] = 1;
+				}
+				if (!reached[b]) continue;
+			}
+			for (j = 0; j < block->nphis; j++) {
+				Cell cell, arg;
+
+				cell.state = UNDECIDED;
+				for (k = 0; k < block->npreds; k++) {
+					if (!edges[2 * block->preds[k] + block->predslot[k]]) continue;
+					arg = OperandCell(cells, &block->phis[j].args[k]);
+					if (arg.state == UNDECIDED) continue;
+					if (cell.state == UNDECIDED) cell = arg;
+					else if (arg.state == VARYING || !SameConstant(&cell.c, &arg.c))
+						cell.state = VARYING;
+				}
+				changed |= Meet(cells, block->phis[j].dest, &cell);
+			}
+			for (j = 0; j < block->ninsts; j++) {
+				Cell cell;
+				if (block->insts[j].dest < 0) continue;
+				if ((block->insts[j].op & OPMASK) == CALL)
+					cell = EvalCall(cells, &block->insts[j]);
+				else if ((block->insts[j].op & OPMASK) == CMOV)
+					cell = EvalSelect(cells, &block->insts[j]);
+				else cell = EvalInst(cells, &block->insts[j]);
+				changed |= Meet(cells, block->insts[j].dest, &cell);
+			}
+			changed |= EvalBranch(ir, cells, b, edges);
+		}
+	}
+}
+
+static void Substitute(const Cell *cells, int op, IROperand *opd)
+{
+	IROperand imm;
+
+	if (opd->kind != IRO_VALUE || cells[opd->u.i].state != CONSTANT) return;
+	if (Immediate(op, &cells[opd->u.i].c, &imm)) *opd = imm;
+}
+
+/* Returns the number of instructions folded and branches decided */
+int PropagateConstants(IRUnit *ir)
+{
+	Cell *cells = NEWARRAY(ir->arena, Cell, ir->nvalues);
+	char *edges = NEWARRAY(ir->arena, char, ir->nblocks * 2);
+	char *reached = NEWARRAY(ir->arena, char, ir->nblocks);
+	int folded = 0, cfg = 0, i, j, k;
+
+	Propagate(ir, cells, edges, reached);
+
+	for (i = 0; i < ir->norder; i++) {
+		int b = ir->order[i];
+		IRBlock *block = &ir->blocks[b];
+		IRInst *in;
+
+		if (!reached[b]) continue;
+		for (j = 0; j < block->nphis; j++) {
+			for (k = 0; k < block->npreds; k++)
+				Substitute(cells, MOV, &block->phis[j].args[k]);
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			in = &block->insts[j];
+			if (in->dest >= 0 && cells[in->dest].state == CONSTANT) {
+				const IROperand *c = &cells[in->dest].c;
+				if ((in->op & OPMASK) != MOV || !SameConstant(&in->src[0], c)) {
+					in->op = c->kind == IRO_FLOAT ? MOV|FLFLAG : MOV;
+					in->src[0] = *c;
+					in->src[1].kind = IRO_NONE;
+					in->argc = 0;
+					in->args = 0;
+					folded++;
+				}
+				continue;
+			}
+			if ((in->op & OPMASK) == CMOV) {
+				Substitute(cells, MOV, &in->src[0]);
+				Substitute(cells, MOV, &in->src[1]);
+				Substitute(cells, MOV, &in->args[0]);
+				if (in->args[0].kind == IRO_INT) {
+					in->src[0] = in->src[in->args[0].u.i ? 0 : 1];
+					in->op = in->src[0].kind == IRO_FLOAT ? MOV|FLFLAG : MOV;
+					in->src[1].kind = IRO_NONE;
+					in->argc = 0;
+					in->args = 0;
+					folded++;
+				}
+				continue;
+			}
+			Substitute(cells, in->op, &in->src[0]);
+			Substitute(cells, in->op, &in->src[1]);
+			for (k = 0; k < in->argc; k++) Substitute(cells, MOV, &in->args[k]);
+		}
+
+		/* A branch with one executable edge becomes a JMP */
+		in = &block->insts[block->ninsts - 1];
+		if (block->nsucc == 2 && edges[2 * b] != edges[2 * b + 1]) {
+			if (edges[2 * b + 1]) block->succ[0] = block->succ[1];
+			block->nsucc = 1;
+			in->op = JMP;
+			in->src[0].kind = in->src[1].kind = IRO_NONE;
+			cfg = 1;
+			folded++;
+		}
+	}
+	if (cfg) UpdateCFG(ir);
+	return folded;
+}
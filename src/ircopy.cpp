@@ -0,0 +1,76 @@
+/* ircopy.cpp - Propagate the copies in the SSA form
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The parser copies a variable into a temp for every read and the temp
+ * of every result into its variable. A value is never changed, so the
+ * uses of a MOV's dest can read its source instead, a string constant
+ * or an undefined value too, and the MOV is left to RemoveDeadCode.
+ * MemCopy copies the whole string, reading the source itself gives the
+ * same string without the copy. */
+
+#include "ir.h"
+
+static void Forward(const IROperand *repl, IROperand *opd)
+{
+	while (opd->kind == IRO_VALUE && repl[opd->u.i].kind != IRO_NONE)
+		*opd = repl[opd->u.i];
+}
+
+/* Returns the number of copies bypassed */
+int PropagateCopies(IRUnit *ir)
+{
+	IROperand *repl = NEWARRAY(ir->arena, IROperand, ir->nvalues);
+	int copies = 0, i, j, k;
+
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[ir->order[i]];
+
+		for (j = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+
+			if ((in->op & OPMASK) != MOV || in->dest < 0) continue;
+			switch (in->src[0].kind) {
+			case IRO_VALUE:
+			case IRO_MEM:
+			case IRO_UNDEF:
+				repl[in->dest] = in->src[0];
+				copies++;
+			}
+		}
+	}
+	if (!copies) return 0;
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+
+		for (j = 0; j < block->nphis; j++) {
+			for (k = 0; k < block->npreds; k++) Forward(repl, &block->phis[j].args[k]);
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			IRInst *in = &block->insts[j];
+
+			Forward(repl, &in->src[0]);
+			Forward(repl, &in->src[1]);
+			for (k = 0; k < in->argc; k++) Forward(repl, &in->args[k]);
+		}
+	}
+	PrunePhis(ir);
+	return copies;
+}
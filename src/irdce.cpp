@@ -0,0 +1,203 @@
+/* irdce.cpp - Remove the instructions whose values are never used
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ir.h"
+
+static int IsDefined(const IROperand *opd, const char *defined)
+{
+	switch (opd->kind) {
+	case IRO_VALUE:
+		return defined[opd->u.i];
+	case IRO_UNDEF:
+		return 0;
+	}
+	return 1;
+}
+
+/* Whether the value can't be T_NULL, assumed until shown otherwise */
+void FindDefined(const IRUnit *ir, char *defined)
+{
+	int changed = 1, i, j, k;
+
+	memset(defined, 1, ir->nvalues);
+	while (changed) {
+		changed = 0;
+		for (i = 0; i < ir->norder; i++) {
+			const IRBlock *block = &ir->blocks[ir->order[i]];
+
+			for (j = 0; j < block->nphis; j++) {
+				const IRPhi *phi = &block->phis[j];
+				if (!defined[phi->dest]) continue;
+				for (k = 0; k < block->npreds; k++) {
+					const IROperand *arg = &phi->args[k];
+					if (arg->kind == IRO_UNDEF
+						|| (arg->kind == IRO_VALUE && !defined[arg->u.i])) {
+						defined[phi->dest] = 0;
+						changed = 1;
+						break;
+					}
+				}
+			}
+			for (j = 0; j < block->ninsts; j++) {
+				const IRInst *in = &block->insts[j];
+				int op = in->op & OPMASK;
+				/* A string param or the value of a function may be undefined */
+				if (((op == PARAM && in->src[1].u.i == T_STRING) || op == CALLU)
+					&& defined[in->dest]) {
+					defined[in->dest] = 0;
+					changed = 1;
+					continue;
+				}
+				if ((op != MOV && op != CMOV) || !defined[in->dest]) continue;
+				if (!IsDefined(&in->src[0], defined)
+					|| (op == CMOV && !IsDefined(&in->src[1], defined))) {
+					defined[in->dest] = 0;
+					changed = 1;
+				}
+			}
+		}
+	}
+}
+
+/* An instruction that can't stop the VM or change anything but its
+ * dest. A MOV or CMOV copies whatever it finds, even an undefined
+ * value, the others must not read T_NULL and must not divide by zero.
+ * A pure builtin, called or intrinsic, reads any other type of its
+ * params as a number. A PARAM only reads the frame. */
+int IsPure(const IRInst *in, const char *defined)
+{
+	const IROperand *divisor = &in->src[1];
+	int k;
+
+	if ((in->op & OPMASK) == MOV || (in->op & OPMASK) == CMOV) return 1;
+	if ((in->op & STRFLAG) || !IsDefined(&in->src[0], defined)
+		|| !IsDefined(&in->src[1], defined))
+		return 0;
+	switch (in->op & OPMASK) {
+	case ADD:
+	case SUB:
+	case MUL:
+	case NOTEQU:
+	case EQU:
+	case LESS:
+	case LE:
+	case GREAT:
+	case GE:
+	case CNV:
+	case INC:
+	case DEC:
+		return 1;
+	case OR:
+	case AND:
+	case XOR:
+	case SHL:
+	case SHR:
+	case NOT:
+		return !(in->op & FLFLAG);
+	case PARAM:
+		return 1;
+	case CALL:
+		/* A builtin checks the count of its params */
+		if (!Function[in->src[0].u.i].pure || in->argc != Function[in->src[0].u.i].paramcnt)
+			return 0;
+		for (k = 0; k < in->argc; k++) {
+			if (!IsDefined(&in->args[k], defined)) return 0;
+		}
+		return 1;
+	case DIV:
+	case MOD:
+		/* INT_MIN / -1 traps too */
+		if (divisor->kind == IRO_FLOAT) return divisor->u.f != 0;
+		return divisor->kind == IRO_INT && divisor->u.i != 0 && divisor->u.i != -1;
+	}
+	return IntrinsicFunc(in->op) >= 0;
+}
+
+static void MarkOperand(const IROperand *opd, char *live, int *work, int *nwork)
+{
+	if (opd->kind == IRO_VALUE && !live[opd->u.i]) {
+		live[opd->u.i] = 1;
+		work[(*nwork)++] = opd->u.i;
+	}
+}
+
+/* Mark from the instructions that must run, then sweep. Returns the
+ * number of instructions removed. */
+int RemoveDeadCode(IRUnit *ir)
+{
+	char *live = NEWARRAY(ir->arena, char, ir->nvalues);
+	int *work = NEWARRAY(ir->arena, int, ir->nvalues);
+	const IRInst **def = NEWARRAY(ir->arena, const IRInst *, ir->nvalues);
+	const IRPhi **phidef = NEWARRAY(ir->arena, const IRPhi *, ir->nvalues);
+	int *phipreds = NEWARRAY(ir->arena, int, ir->nvalues);
+	char *defined = NEWARRAY(ir->arena, char, ir->nvalues);
+	int nwork = 0, removed = 0, i, j, k, n;
+
+	FindDefined(ir, defined);
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[ir->order[i]];
+
+		for (j = 0; j < block->nphis; j++) {
+			phidef[block->phis[j].dest] = &block->phis[j];
+			phipreds[block->phis[j].dest] = block->npreds;
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+
+			if (in->dest >= 0) def[in->dest] = in;
+			if (in->dest >= 0 && IsPure(in, defined)) continue;
+			for (k = 0; k < 2; k++) MarkOperand(&in->src[k], live, work, &nwork);
+			for (k = 0; k < in->argc; k++) MarkOperand(&in->args[k], live, work, &nwork);
+		}
+	}
+
+	while (nwork) {
+		int v = work[--nwork];
+
+		if (def[v]) {
+			for (k = 0; k < 2; k++) MarkOperand(&def[v]->src[k], live, work, &nwork);
+			for (k = 0; k < def[v]->argc; k++)
+				MarkOperand(&def[v]->args[k], live, work, &nwork);
+		}
+		else if (phidef[v]) {
+			for (k = 0; k < phipreds[v]; k++)
+				MarkOperand(&phidef[v]->args[k], live, work, &nwork);
+		}
+	}
+
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+
+		for (j = n = 0; j < block->nphis; j++) {
+			if (live[block->phis[j].dest]) block->phis[n++] = block->phis[j];
+		}
+		block->nphis = n;
+		for (j = n = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+			if (in->dest >= 0 && IsPure(in, defined) && !live[in->dest]) {
+				removed++;
+				continue;
+			}
+			block->insts[n++] = *in;
+		}
+		block->ninsts = n;
+	}
+	return removed;
+}
@@ -0,0 +1,661 @@
+/* irloop.cpp - Move the invariant code out of the loops, unroll the
+ * counted loops and reduce the strength of multiplies and divides
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* A loop is found from its back edges, the edges to a block that
+ * dominates their source. Its body is the header and the blocks that
+ * reach a back edge without passing the header. The loops of while and
+ * for jump back to the condition, which is the header.
+ *
+ * Every loop is given a preheader, a block that only jumps to the header
+ * and is its only predecessor from outside. The instructions of the body
+ * whose operands don't change in the loop are moved there, they are
+ * computed once before the loop instead of in every iteration. Only the
+ * pure instructions are moved, they may now run when the loop body
+ * wouldn't have. */
+
+#include "ir.h"
+
+typedef struct Loop {
+	int header;
+	int *body;			/* the blocks in reverse post order */
+	int size;
+} Loop;
+
+static int Dominates(const IRUnit *ir, int a, int b)
+{
+	while (b != a && b != 0) b = ir->blocks[b].idom;
+	return b == a;
+}
+
+static int CompareRPO(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+static int CompareSize(const void *a, const void *b)
+{
+	return ((const Loop *)a)->size - ((const Loop *)b)->size;
+}
+
+/* The loops in the order of their sizes, the inner loops first */
+static Loop *FindLoops(IRUnit *ir, int *nloops)
+{
+	int *work = NEWARRAY(ir->arena, int, ir->nblocks);
+	int *inloop = NEWARRAY(ir->arena, int, ir->nblocks);
+	Loop *loops = 0;
+	int maxloops = 0, n = 0, nwork, i, j, k;
+
+	for (i = 0; i < ir->norder; i++) {
+		int h = ir->order[i];
+		const IRBlock *header = &ir->blocks[h];
+		Loop *loop = 0;
+
+		for (j = 0; j < header->npreds; j++) {
+			int p = header->preds[j];
+			if (ir->blocks[p].rpo < i || !Dominates(ir, h, p)) continue;
+			if (!loop) {
+				if (n == maxloops)
+					loops = (Loop *)GrowArray(ir->arena, loops, &maxloops, sizeof(Loop));
+				loop = &loops[n++];
+				loop->header = h;
+				loop->size = 0;
+				work[loop->size++] = h;
+				inloop[h] = n;
+			}
+			nwork = loop->size;
+			if (inloop[p] != n) {
+				inloop[p] = n;
+				work[loop->size++] = p;
+			}
+			/* work[] holds the body, the blocks from nwork on are new */
+			while (nwork < loop->size) {
+				const IRBlock *block = &ir->blocks[work[nwork++]];
+				for (k = 0; k < block->npreds; k++) {
+					if (inloop[block->preds[k]] == n) continue;
+					inloop[block->preds[k]] = n;
+					work[loop->size++] = block->preds[k];
+				}
+			}
+		}
+		if (!loop) continue;
+		for (j = 0; j < loop->size; j++) work[j] = ir->blocks[work[j]].rpo;
+		qsort(work, loop->size, sizeof(int), CompareRPO);
+		loop->body = NEWARRAY(ir->arena, int, loop->size);
+		for (j = 0; j < loop->size; j++) loop->body[j] = ir->order[work[j]];
+	}
+
+	qsort(loops, n, sizeof(Loop), CompareSize);
+	*nloops = n;
+	return loops;
+}
+
+/* inloop[] is l for the blocks of loop l */
+static void MarkLoop(int *inloop, const Loop *loop, int l)
+{
+	int i;
+	for (i = 0; i < loop->size; i++) inloop[loop->body[i]] = l;
+}
+
+/* The only predecessor of the header from outside the loop, -1 if
+ * there are more. The loop must be marked. */
+static int OutsidePred(const IRUnit *ir, const int *inloop, const Loop *loop, int l)
+{
+	const IRBlock *header = &ir->blocks[loop->header];
+	int pred = -1, j;
+
+	for (j = 0; j < header->npreds; j++) {
+		int p = header->preds[j];
+		if (inloop[p] == l || p == pred) continue;
+		if (pred != -1) return -1;
+		pred = p;
+	}
+	return pred;
+}
+
+static int NeedsPreheader(const IRUnit *ir, int *inloop, const Loop *loop, int l)
+{
+	int p;
+
+	MarkLoop(inloop, loop, l);
+	p = OutsidePred(ir, inloop, loop, l);
+	return p == 0 || (p > 0 && ir->blocks[p].nsucc == 2);
+}
+
+/* A block of its own before the header when the code before the loop
+ * branches or is the entry. A header entered from more than one block
+ * outside is left alone. */
+static void AddPreheaders(IRUnit *ir)
+{
+	int *inloop = NEWARRAY(ir->arena, int, ir->nblocks);
+	Loop *loops;
+	IRBlock *blocks;
+	int nloops, added = 0, i, j, k;
+
+	loops = FindLoops(ir, &nloops);
+	for (i = 0; i < ir->nblocks; i++) inloop[i] = -1;
+	for (i = 0; i < nloops; i++) added += NeedsPreheader(ir, inloop, &loops[i], i);
+	if (!added) return;
+
+	blocks = NEWARRAY(ir->arena, IRBlock, ir->nblocks + added);
+	memcpy(blocks, ir->blocks, ir->nblocks * sizeof(IRBlock));
+	ir->blocks = blocks;
+	for (i = 0; i < nloops; i++) {
+		IRBlock *pred, *header, *block;
+		int p;
+
+		if (!NeedsPreheader(ir, inloop, &loops[i], i)) continue;
+		p = OutsidePred(ir, inloop, &loops[i], i);
+		pred = &ir->blocks[p];
+		header = &ir->blocks[loops[i].header];
+		block = &ir->blocks[ir->nblocks];
+		block->addr = -1;
+		block->insts = NEWARRAY(ir->arena, IRInst, 1);
+		block->insts[0].op = JMP;
+		block->insts[0].dest = -1;
+		block->ninsts = 1;
+		block->succ[0] = loops[i].header;
+		block->nsucc = 1;
+		block->count = 0;
+		for (k = 0; k < pred->nsucc; k++) {
+			if (pred->succ[k] != loops[i].header) continue;
+			pred->succ[k] = ir->nblocks;
+			block->count += EdgeCount(pred, k);
+		}
+		/* So that UpdateCFG gives the phi arguments to the new block */
+		for (j = 0; j < header->npreds; j++) {
+			if (header->preds[j] == p) header->preds[j] = ir->nblocks;
+		}
+		ir->nblocks++;
+	}
+	UpdateCFG(ir);
+}
+
+static int IsInvariant(const IRUnit *ir, const int *inloop, int l, const IROperand *opd)
+{
+	return opd->kind != IRO_VALUE || inloop[ir->values[opd->u.i].block] != l;
+}
+
+/* Put the instructions before the terminator of a block */
+static void InsertInsts(IRUnit *ir, int b, const IRInst *insts, int n)
+{
+	IRBlock *block = &ir->blocks[b];
+	IRInst *newinsts = NEWARRAY(ir->arena, IRInst, block->ninsts + n);
+	int last = block->ninsts - 1;
+
+	memcpy(newinsts, block->insts, last * sizeof(IRInst));
+	memcpy(newinsts + last, insts, n * sizeof(IRInst));
+	newinsts[last + n] = block->insts[last];
+	block->insts = newinsts;
+	block->ninsts += n;
+}
+
+/* Returns the number of instructions moved out of loops */
+int HoistInvariants(IRUnit *ir)
+{
+	char *defined;
+	int *inloop;
+	Loop *loops;
+	IRInst *hoisted = 0;
+	int maxhoisted = 0, moved = 0, nloops, l, i, j, k, n;
+
+	AddPreheaders(ir);
+	inloop = NEWARRAY(ir->arena, int, ir->nblocks);
+	loops = FindLoops(ir, &nloops);
+	for (i = 0; i < ir->nblocks; i++) inloop[i] = -1;
+	defined = NEWARRAY(ir->arena, char, ir->nvalues);
+	FindDefined(ir, defined);
+
+	/* An inner loop moves its code to its preheader in the outer loop,
+	 * the outer loop may then move it further */
+	for (l = 0; l < nloops; l++) {
+		const Loop *loop = &loops[l];
+		int pre, nhoisted = 0;
+
+		MarkLoop(inloop, loop, l);
+		pre = OutsidePred(ir, inloop, loop, l);
+		if (pre <= 0 || ir->blocks[pre].nsucc != 1) continue;
+		for (i = 0; i < loop->size; i++) {
+			IRBlock *block = &ir->blocks[loop->body[i]];
+
+			for (j = n = 0; j < block->ninsts; j++) {
+				const IRInst *in = &block->insts[j];
+				int invariant = IsInvariant(ir, inloop, l, &in->src[0])
+					&& IsInvariant(ir, inloop, l, &in->src[1]);
+
+				for (k = 0; invariant && k < in->argc; k++)
+					invariant = IsInvariant(ir, inloop, l, &in->args[k]);
+				if (in->dest >= 0 && invariant && IsPure(in, defined)) {
+					if (nhoisted == maxhoisted)
+						hoisted = (IRInst *)GrowArray(ir->arena, hoisted,
+							&maxhoisted, sizeof(IRInst));
+					hoisted[nhoisted++] = *in;
+					ir->values[in->dest].block = pre;
+					continue;
+				}
+				block->insts[n++] = *in;
+			}
+			block->ninsts = n;
+		}
+		if (nhoisted) InsertInsts(ir, pre, hoisted, nhoisted);
+		moved += nhoisted;
+	}
+	return moved;
+}
+
+/* The log2 of an immediate power of two from 2 to 2^30, -1 if it
+ * isn't one */
+static int Log2(const IROperand *opd)
+{
+	int k;
+
+	if (opd->kind != IRO_INT) return -1;
+	for (k = 1; k < 31; k++) {
+		if (opd->u.i == 1 << k) return k;
+	}
+	return -1;
+}
+
+static int IsNonNegative(const IROperand *opd, const char *nonneg)
+{
+	switch (opd->kind) {
+	case IRO_VALUE:
+		return nonneg[opd->u.i];
+	case IRO_INT:
+		return opd->u.i >= 0;
+	}
+	return 0;
+}
+
+/* Whether an integer value is never negative, assumed for the phis until
+ * shown otherwise. A compare gives 0 or 1, an AND with a non-negative
+ * operand and the quotient, remainder and shift of a non-negative value
+ * by a positive immediate are never negative either. */
+static void FindNonNegative(const IRUnit *ir, char *nonneg)
+{
+	int changed = 1, i, j, k;
+
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[ir->order[i]];
+		for (j = 0; j < block->nphis; j++) nonneg[block->phis[j].dest] = 1;
+	}
+	while (changed) {
+		changed = 0;
+		for (i = 0; i < ir->norder; i++) {
+			const IRBlock *block = &ir->blocks[ir->order[i]];
+
+			for (j = 0; j < block->nphis; j++) {
+				const IRPhi *phi = &block->phis[j];
+				if (!nonneg[phi->dest]) continue;
+				for (k = 0; k < block->npreds; k++) {
+					if (!IsNonNegative(&phi->args[k], nonneg)) {
+						nonneg[phi->dest] = 0;
+						changed = 1;
+						break;
+					}
+				}
+			}
+			for (j = 0; j < block->ninsts; j++) {
+				const IRInst *in = &block->insts[j];
+				const IROperand *a = &in->src[0], *b = &in->src[1];
+				int x = 0;
+
+				if (in->dest < 0 || (in->op & (FLFLAG|STRFLAG))) {
+					if (in->dest >= 0 && nonneg[in->dest]) {
+						nonneg[in->dest] = 0;
+						changed = 1;
+					}
+					continue;
+				}
+				switch (in->op & OPMASK) {
+				case MOV:
+					x = IsNonNegative(a, nonneg);
+					break;
+				case NOTEQU:
+				case EQU:
+				case LESS:
+				case LE:
+				case GREAT:
+				case GE:
+					x = 1;
+					break;
+				case AND:
+					x = IsNonNegative(a, nonneg) || IsNonNegative(b, nonneg);
+					break;
+				case DIV:
+				case MOD:
+				case SHR:
+					x = IsNonNegative(a, nonneg) && b->kind == IRO_INT && b->u.i > 0
+						&& ((in->op & OPMASK) != SHR || b->u.i < 32);
+					break;
+				}
+				if (x != nonneg[in->dest]) {
+					nonneg[in->dest] = x;
+					changed = 1;
+				}
+			}
+		}
+	}
+}
+
+/* An integer multiply by a power of two is a left shift. The divide and
+ * remainder round towards zero, they are a right shift and a mask only
+ * when the dividend isn't negative. Returns the number of instructions
+ * changed. */
+int ReduceStrength(IRUnit *ir)
+{
+	char *nonneg = NEWARRAY(ir->arena, char, ir->nvalues);
+	int reduced = 0, i, j, k;
+
+	FindNonNegative(ir, nonneg);
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+
+		for (j = 0; j < block->ninsts; j++) {
+			IRInst *in = &block->insts[j];
+
+			if (in->op & (FLFLAG|STRFLAG)) continue;
+			switch (in->op) {
+			case MUL:
+				if ((k = Log2(&in->src[1])) < 0 && (k = Log2(&in->src[0])) >= 0)
+					in->src[0] = in->src[1];
+				if (k < 0) continue;
+				in->op = SHL;
+				in->src[1].u.i = k;
+				break;
+			case DIV:
+			case MOD:
+				if ((k = Log2(&in->src[1])) < 0 || !IsNonNegative(&in->src[0], nonneg))
+					continue;
+				if (in->op == DIV) in->src[1].u.i = k;
+				else in->src[1].u.i = (1 << k) - 1;
+				in->op = in->op == DIV ? SHR : AND;
+				break;
+			default:
+				continue;
+			}
+			in->src[1].kind = IRO_INT;
+			reduced++;
+		}
+	}
+	return reduced;
+}
+
+/* A counted loop is a header with only a compare of a phi against an
+ * immediate and a body of one block that steps the phi by an immediate.
+ * The phi starts at an immediate, so the trip count is known. The body
+ * is copied factor - 1 times after itself and the header is tested once
+ * every factor trips. The remainder of the trip count is peeled off into
+ * copies of the body before the loop. */
+
+#define MAXUNROLLBODY 16	/* instructions in a body to unroll */
+
+/* With a profile only the loops that ran often are unrolled, and those
+ * even with a larger body */
+#define MINHOTTRIPS 64		/* times the header ran */
+#define MAXHOTBODY 64
+
+typedef struct Counted {
+	int loop;
+	int pre, body;
+	int trips;
+} Counted;
+
+static int Compare(int op, long long a, long long b)
+{
+	switch (op & OPMASK) {
+	case JE:	return a == b;
+	case JNE:	return a != b;
+	case JG:	return a > b;
+	case JL:	return a < b;
+	case JLE:	return a <= b;
+	}
+	return a >= b;
+}
+
+/* The step of the phi from the body, 0 if it isn't stepped by an
+ * immediate */
+static int FindStep(const IRBlock *body, int phi, const IROperand *arg)
+{
+	int j;
+
+	if (arg->kind != IRO_VALUE) return 0;
+	for (j = 0; j < body->ninsts; j++) {
+		const IRInst *in = &body->insts[j];
+		const IROperand *a = &in->src[0], *b = &in->src[1];
+
+		if (in->dest != arg->u.i) continue;
+		if (in->op & (FLFLAG|STRFLAG)) return 0;
+		if (a->kind == IRO_INT && in->op == ADD) {
+			a = &in->src[1];
+			b = &in->src[0];
+		}
+		if (a->kind != IRO_VALUE || a->u.i != phi) return 0;
+		switch (in->op) {
+		case INC:
+			return 1;
+		case DEC:
+			return -1;
+		case ADD:
+			return b->kind == IRO_INT && b->u.i != INT_MIN ? b->u.i : 0;
+		case SUB:
+			return b->kind == IRO_INT && b->u.i != INT_MIN ? -b->u.i : 0;
+		}
+		return 0;
+	}
+	return 0;
+}
+
+/* The number of times the body runs, -1 if unknown or if the phi would
+ * wrap around */
+static int TripCount(const IRUnit *ir, int h, int pre, int b)
+{
+	const IRBlock *header = &ir->blocks[h], *body = &ir->blocks[b];
+	const IRInst *test = &header->insts[0];
+	const IRPhi *phi = 0;
+	long long start, limit, step, lo, hi, mid, max;
+	int stay, j, k;
+
+	if (header->ninsts != 1 || !IsBranch(test->op) || (test->op & (FLFLAG|STRFLAG))
+		|| test->op == JE || test->op == JNE)
+		return -1;
+	for (k = 0; k < 2; k++) {
+		if (test->src[k].kind == IRO_VALUE && test->src[1 - k].kind == IRO_INT) break;
+	}
+	if (k == 2) return -1;
+	for (j = 0; j < header->nphis; j++) {
+		if (header->phis[j].dest == test->src[k].u.i) phi = &header->phis[j];
+	}
+	if (!phi) return -1;
+
+	limit = test->src[1 - k].u.i;
+	start = step = 0;
+	for (j = 0; j < header->npreds; j++) {
+		if (header->preds[j] == pre) {
+			if (phi->args[j].kind != IRO_INT) return -1;
+			start = phi->args[j].u.i;
+		}
+		else step = FindStep(body, phi->dest, &phi->args[j]);
+	}
+	if (!step) return -1;
+
+	/* The compare is monotonic in the trip, find where it leaves */
+	stay = header->succ[0] == b;
+#define STAYS(t) (Compare(test->op, k ? limit : start + (t) * step, \
+	k ? start + (t) * step : limit) == stay)
+	if (!STAYS(0)) return 0;
+	max = step > 0 ? (INT_MAX - start) / step : (start - INT_MIN) / -step;
+	if (STAYS(max)) return -1;
+	for (lo = 0, hi = max; hi - lo > 1; ) {
+		mid = lo + (hi - lo) / 2;
+		if (STAYS(mid)) lo = mid;
+		else hi = mid;
+	}
+#undef STAYS
+	return hi > INT_MAX ? -1 : (int)hi;
+}
+
+static void MapOperand(const IROperand *map, int nmap, IROperand *opd)
+{
+	if (opd->kind == IRO_VALUE && opd->u.i < nmap && map[opd->u.i].kind != IRO_NONE)
+		*opd = map[opd->u.i];
+}
+
+/* Copy the body into block to, with the phis of the header read from
+ * cur[], which is then set to the values the phis get after the copy */
+static void CopyBody(IRUnit *ir, IROperand *map, int nmap, int h, int latch,
+	int body, int to, IROperand *cur)
+{
+	IRBlock *header = &ir->blocks[h], *from = &ir->blocks[body];
+	IRBlock *block = &ir->blocks[to];
+	int j, k;
+
+	for (j = 0; j < header->nphis; j++) map[header->phis[j].dest] = cur[j];
+	block->addr = -1;
+	block->insts = NEWARRAY(ir->arena, IRInst, from->ninsts);
+	block->ninsts = from->ninsts;
+	block->succ[0] = h;
+	block->nsucc = 1;
+	block->count = from->count;
+	block->taken = 0;
+	for (j = 0; j < from->ninsts; j++) {
+		IRInst *in = &block->insts[j];
+
+		*in = from->insts[j];
+		MapOperand(map, nmap, &in->src[0]);
+		MapOperand(map, nmap, &in->src[1]);
+		if (in->argc) {
+			in->args = NEWARRAY(ir->arena, IROperand, in->argc);
+			for (k = 0; k < in->argc; k++) {
+				in->args[k] = from->insts[j].args[k];
+				MapOperand(map, nmap, &in->args[k]);
+			}
+		}
+		if (in->dest >= 0) {
+			in->dest = NewValue(ir, to);
+			map[from->insts[j].dest].kind = IRO_VALUE;
+			map[from->insts[j].dest].u.i = in->dest;
+		}
+	}
+	for (j = 0; j < header->nphis; j++) {
+		cur[j] = header->phis[j].args[latch];
+		MapOperand(map, nmap, &cur[j]);
+	}
+}
+
+/* Copy the body n times into the blocks from first on, starting from the
+ * phi arguments of edge e of the header. The copies replace that edge. */
+static void CopyChain(IRUnit *ir, IROperand *map, int nmap, int h, int latch,
+	int body, int e, int first, int n)
+{
+	IRBlock *header = &ir->blocks[h];
+	IROperand *cur = NEWARRAY(ir->arena, IROperand, header->nphis);
+	int j;
+
+	for (j = 0; j < header->nphis; j++) cur[j] = header->phis[j].args[e];
+	for (j = 0; j < n; j++) {
+		CopyBody(ir, map, nmap, h, latch, body, first + j, cur);
+		if (j) ir->blocks[first + j - 1].succ[0] = first + j;
+	}
+	for (j = 0; j < header->nphis; j++) header->phis[j].args[e] = cur[j];
+}
+
+static void Redirect(IRBlock *block, int from, int to)
+{
+	int k;
+	for (k = 0; k < block->nsucc; k++) {
+		if (block->succ[k] == from) block->succ[k] = to;
+	}
+}
+
+/* Returns the number of loops unrolled */
+int UnrollLoops(IRUnit *ir, int factor)
+{
+	IROperand *map;
+	IRBlock *blocks;
+	Counted *counted;
+	Loop *loops;
+	int *inloop, nloops, ncounted = 0, added = 0, nmap, maxbody, i, j;
+
+	if (factor < 2) return 0;
+	loops = FindLoops(ir, &nloops);
+	inloop = NEWARRAY(ir->arena, int, ir->nblocks);
+	counted = NEWARRAY(ir->arena, Counted, nloops);
+	for (i = 0; i < ir->nblocks; i++) inloop[i] = -1;
+	maxbody = ir->profiled ? MAXHOTBODY : MAXUNROLLBODY;
+	for (i = 0; i < nloops; i++) {
+		Counted *c = &counted[ncounted];
+		const IRBlock *header = &ir->blocks[loops[i].header];
+
+		if (loops[i].size != 2) continue;
+		if (ir->profiled && header->count < MINHOTTRIPS) continue;
+		MarkLoop(inloop, &loops[i], i);
+		c->loop = i;
+		c->pre = OutsidePred(ir, inloop, &loops[i], i);
+		c->body = loops[i].body[0] == loops[i].header ? loops[i].body[1] : loops[i].body[0];
+		if (c->pre < 0 || header->npreds != 2 || ir->blocks[c->body].npreds != 1
+			|| ir->blocks[c->body].nsucc != 1
+			|| ir->blocks[c->body].ninsts > maxbody)
+			continue;
+		c->trips = TripCount(ir, loops[i].header, c->pre, c->body);
+		if (c->trips < factor) continue;
+		added += factor - 1 + c->trips % factor;
+		ncounted++;
+	}
+	if (!ncounted) return 0;
+
+	blocks = NEWARRAY(ir->arena, IRBlock, ir->nblocks + added);
+	memcpy(blocks, ir->blocks, ir->nblocks * sizeof(IRBlock));
+	ir->blocks = blocks;
+	nmap = ir->nvalues;
+	map = NEWARRAY(ir->arena, IROperand, nmap);
+	for (i = 0; i < ncounted; i++) {
+		const Counted *c = &counted[i];
+		int h = loops[c->loop].header, peel = c->trips % factor, pre, latch;
+		IRBlock *header = &ir->blocks[h];
+
+		pre = header->preds[0] == c->pre ? 0 : 1;
+		latch = 1 - pre;
+
+		/* The remainder before the loop, first while the phis still
+		 * take the values of the body */
+		if (peel) {
+			CopyChain(ir, map, nmap, h, latch, c->body, pre, ir->nblocks, peel);
+			Redirect(&ir->blocks[c->pre], h, ir->nblocks);
+			header->preds[pre] = ir->nblocks + peel - 1;
+			ir->nblocks += peel;
+		}
+
+		/* The copies of the body in the loop */
+		CopyChain(ir, map, nmap, h, latch, c->body, latch, ir->nblocks, factor - 1);
+		ir->blocks[c->body].succ[0] = ir->nblocks;
+		header->preds[latch] = ir->nblocks + factor - 2;
+		ir->nblocks += factor - 1;
+
+		for (j = 0; j < header->nphis; j++) map[header->phis[j].dest].kind = IRO_NONE;
+		for (j = 0; j < ir->blocks[c->body].ninsts; j++) {
+			if (ir->blocks[c->body].insts[j].dest >= 0)
+				map[ir->blocks[c->body].insts[j].dest].kind = IRO_NONE;
+		}
+	}
+	UpdateCFG(ir);
+	MergeBlocks(ir);
+	return ncounted;
+}
@@ -0,0 +1,1001 @@
+/* irlower.cpp - Assign memory slots to SSA values and generate VMCode
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The values are coloured greedily in reverse post order, which visits
+ * the definition of a value before all of its uses. Two values get the
+ * same slot only if they are never live at the same time, so the slots
+ * needed are as many as the values live at one point. A MOV prefers the
+ * slot of its source and a phi the slot of its arguments, such copies
+ * are then left out. A CMOV finds its condition in its dest, so it
+ * prefers the slot of the condition, but never gets one of its sides.
+ * A string made by a builtin prefers a free slot that held one before,
+ * and other values avoid those, so the VM keeps reusing the string in
+ * the slot instead of freeing it and making another.
+ *
+ * The phis become MOVs at the end of the predecessors, in a block of
+ * their own if the predecessor has two successors.
+ *
+ * A switch is a chain of blocks that each test one value for equality
+ * with a key, which PlanDispatch makes a table of.
+ *
+ * With a profile the blocks are chained so that the frequent edges fall
+ * through, and a chain of tests too short for a table tests its keys in
+ * the order of how often they matched. */
+
+#include "ir.h"
+#include "funcdefs.h"
+
+#define MAXTESTSIZE 3		/* instructions in a test copied into a jump */
+
+typedef struct Copy {
+	int op;				/* MOV with FLAG1 and FLFLAG for an immediate */
+	int dest;
+	int src;
+} Copy;
+
+typedef struct EdgeCode {
+	Instruction *code;
+	int n;
+	int block;			/* the block made for the edge, -1 if none */
+} EdgeCode;
+
+typedef struct Lower {
+	IRUnit *ir;
+	Arena *arena;
+	IntList *livein, *liveout;
+	int *group;			/* affinity of copies and phis */
+	int *groupslot;
+	char *strslot;		/* last held a string */
+	int nslots;
+	int nullslot;		/* never written, read for an undefined value */
+	int scratch;		/* breaks a cycle of phi copies */
+	EdgeCode *edges;	/* two for each block */
+	int *forward;		/* where a block that only jumps on leads */
+	int *cases;			/* tests in the switch from a block, -1 inside one */
+	Instruction *code;
+	int size, maxsize;
+	int *fixups;		/* jumps with a block in dest */
+	int nfixups, maxfixups;
+} Lower;
+
+/* Collect the uses of every value, coded as 2*block for an instruction
+ * and 2*pred+1 for a phi argument coming from pred. */
+static void CollectUses(const IRUnit *ir, int **first, int **uses)
+{
+	int *count = NEWARRAY(ir->arena, int, ir->nvalues + 1);
+	int i, j, k, pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < ir->norder; i++) {
+			int b = ir->order[i];
+			const IRBlock *block = &ir->blocks[b];
+
+			for (j = 0; j < block->nphis; j++) {
+				for (k = 0; k < block->npreds; k++) {
+					const IROperand *arg = &block->phis[j].args[k];
+					if (arg->kind != IRO_VALUE) continue;
+					if (pass) (*uses)[count[arg->u.i]++] = 2 * block->preds[k] + 1;
+					else count[arg->u.i + 1]++;
+				}
+			}
+			for (j = 0; j < block->ninsts; j++) {
+				const IRInst *in = &block->insts[j];
+				for (k = 0; k < 2 + in->argc; k++) {
+					const IROperand *opd = k < 2 ? &in->src[k] : &in->args[k - 2];
+					if (opd->kind != IRO_VALUE) continue;
+					if (pass) (*uses)[count[opd->u.i]++] = 2 * b;
+					else count[opd->u.i + 1]++;
+				}
+			}
+		}
+		if (!pass) {
+			for (i = 0; i < ir->nvalues; i++) count[i + 1] += count[i];
+			*first = NEWARRAY(ir->arena, int, ir->nvalues + 1);
+			memcpy(*first, count, (ir->nvalues + 1) * sizeof(int));
+			*uses = NEWARRAY(ir->arena, int, count[ir->nvalues]);
+		}
+	}
+}
+
+/* Walk up from every use to the definition of the value */
+static void Liveness(Lower *lw)
+{
+	IRUnit *ir = lw->ir;
+	int *instamp = NEWARRAY(lw->arena, int, ir->nblocks);
+	int *outstamp = NEWARRAY(lw->arena, int, ir->nblocks);
+	int *stack = NEWARRAY(lw->arena, int, ir->nblocks);
+	int *first = 0, *uses = 0;
+	int v, i, j, b, sp;
+
+	CollectUses(ir, &first, &uses);
+	lw->livein = NEWARRAY(lw->arena, IntList, ir->nblocks);
+	lw->liveout = NEWARRAY(lw->arena, IntList, ir->nblocks);
+	for (b = 0; b < ir->nblocks; b++) instamp[b] = outstamp[b] = -1;
+
+	for (v = 0; v < ir->nvalues; v++) {
+		int def = ir->values[v].block;
+
+		for (i = first[v]; i < first[v + 1]; i++) {
+			b = uses[i] >> 1;
+			if (uses[i] & 1) {
+				if (outstamp[b] != v) {
+					outstamp[b] = v;
+					ListAdd(lw->arena, &lw->liveout[b], v);
+				}
+			}
+			if (b == def || instamp[b] == v) continue;
+			instamp[b] = v;
+			ListAdd(lw->arena, &lw->livein[b], v);
+			stack[0] = b;
+			sp = 1;
+			while (sp) {
+				const IRBlock *block = &ir->blocks[stack[--sp]];
+				for (j = 0; j < block->npreds; j++) {
+					int p = block->preds[j];
+					if (outstamp[p] != v) {
+						outstamp[p] = v;
+						ListAdd(lw->arena, &lw->liveout[p], v);
+					}
+					if (p != def && instamp[p] != v) {
+						instamp[p] = v;
+						ListAdd(lw->arena, &lw->livein[p], v);
+						stack[sp++] = p;
+					}
+				}
+			}
+		}
+	}
+}
+
+static int FindGroup(int *group, int v)
+{
+	while (group[v] != v) {
+		group[v] = group[group[v]];
+		v = group[v];
+	}
+	return v;
+}
+
+static void JoinGroups(int *group, int v1, int v2)
+{
+	group[FindGroup(group, v1)] = FindGroup(group, v2);
+}
+
+static int SlotOf(const Lower *lw, const IROperand *opd)
+{
+	return opd->kind == IRO_VALUE ? lw->ir->values[opd->u.i].slot : -1;
+}
+
+/* A free slot, the hint if possible, -1 if there is none */
+static int ChooseSlot(Lower *lw, const int *owner, int maxslots, int v, int hint, int str)
+{
+	int root = FindGroup(lw->group, v), slot, other = -1;
+
+	if (hint >= 0 && owner[hint] == -1) slot = hint;
+	else if (lw->groupslot[root] >= 0 && owner[lw->groupslot[root]] == -1)
+		slot = lw->groupslot[root];
+	else {
+		for (slot = 0; slot < maxslots; slot++) {
+			if (owner[slot] != -1) continue;
+			if (lw->strslot[slot] == str || slot >= lw->nslots) break;
+			if (other < 0) other = slot;
+		}
+		if (slot >= maxslots) slot = other;
+		if (slot < 0) return -1;
+	}
+	if (lw->groupslot[root] < 0) lw->groupslot[root] = slot;
+	if (slot >= lw->nslots) lw->nslots = slot + 1;
+	lw->strslot[slot] = (char)str;
+	return slot;
+}
+
+static int MakesString(const IRInst *in)
+{
+	switch (in->op & OPMASK) {
+	case CALL:
+		return Function[in->src[0].u.i].retval == T_STRING;
+	case PARAM:
+		return in->src[1].u.i == T_STRING;
+	}
+	return 0;
+}
+
+/* Free the slot of a value used for the last time by instruction j of b */
+static void Release(const Lower *lw, int *owner, const int *lastuse,
+	const int *outmark, int b, int j, const IROperand *opd)
+{
+	int v = opd->kind == IRO_VALUE ? opd->u.i : -1;
+
+	if (v >= 0 && lastuse[v] == j && outmark[v] != b
+		&& owner[lw->ir->values[v].slot] == v)
+		owner[lw->ir->values[v].slot] = -1;
+}
+
+static int AssignSlots(Lower *lw)
+{
+	IRUnit *ir = lw->ir;
+	int room = HEAPSTART - 2 - ir->slotbase;
+	int maxslots = ir->nvalues < room ? ir->nvalues : room;
+	int *owner = NEWARRAY(lw->arena, int, maxslots + 1);
+	int *outmark = NEWARRAY(lw->arena, int, ir->nvalues);
+	int *lastblock = NEWARRAY(lw->arena, int, ir->nvalues);
+	int *lastuse = NEWARRAY(lw->arena, int, ir->nvalues);
+	int i, j, k, s, v;
+
+	lw->group = NEWARRAY(lw->arena, int, ir->nvalues);
+	lw->groupslot = NEWARRAY(lw->arena, int, ir->nvalues);
+	lw->strslot = NEWARRAY(lw->arena, char, maxslots + 1);
+	for (s = 0; s <= maxslots; s++) lw->strslot[s] = 0;
+	for (v = 0; v < ir->nvalues; v++) {
+		lw->group[v] = v;
+		lw->groupslot[v] = -1;
+		outmark[v] = lastblock[v] = -1;
+	}
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[ir->order[i]];
+		for (j = 0; j < block->nphis; j++) {
+			for (k = 0; k < block->npreds; k++) {
+				if (block->phis[j].args[k].kind == IRO_VALUE)
+					JoinGroups(lw->group, block->phis[j].dest,
+						block->phis[j].args[k].u.i);
+			}
+		}
+		for (j = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+			if ((in->op & OPMASK) == MOV && in->dest >= 0
+				&& in->src[0].kind == IRO_VALUE)
+				JoinGroups(lw->group, in->dest, in->src[0].u.i);
+		}
+	}
+
+	for (s = 0; s <= maxslots; s++) owner[s] = -1;
+	for (i = 0; i < ir->norder; i++) {
+		int b = ir->order[i];
+		IRBlock *block = &ir->blocks[b];
+
+		for (s = 0; s < lw->nslots; s++) owner[s] = -1;
+		for (j = 0; j < lw->livein[b].n; j++) {
+			v = lw->livein[b].data[j];
+			owner[ir->values[v].slot] = v;
+		}
+		for (j = 0; j < lw->liveout[b].n; j++) outmark[lw->liveout[b].data[j]] = b;
+		for (j = block->ninsts - 1; j >= 0; j--) {
+			const IRInst *in = &block->insts[j];
+			for (k = 0; k < 2 + in->argc; k++) {
+				const IROperand *opd = k < 2 ? &in->src[k] : &in->args[k - 2];
+				if (opd->kind == IRO_VALUE && lastblock[opd->u.i] != b) {
+					lastblock[opd->u.i] = b;
+					lastuse[opd->u.i] = j;
+				}
+			}
+		}
+
+		for (j = 0; j < block->nphis; j++) {
+			v = block->phis[j].dest;
+			if ((s = ChooseSlot(lw, owner, maxslots, v, -1, 0)) < 0) return 0;
+			ir->values[v].slot = s;
+			owner[s] = v;
+		}
+		for (j = 0; j < block->nphis; j++) {
+			v = block->phis[j].dest;
+			if (lastblock[v] != b && outmark[v] != b) owner[ir->values[v].slot] = -1;
+		}
+
+		for (j = 0; j < block->ninsts; j++) {
+			const IRInst *in = &block->insts[j];
+			/* A CMOV reads its sides after its dest got the condition */
+			int late = (in->op & OPMASK) == CMOV ? 2 : 0;
+			int hint = -1;
+
+			for (k = late; k < 2 + in->argc; k++) {
+				Release(lw, owner, lastuse, outmark, b, j,
+					k < 2 ? &in->src[k] : &in->args[k - 2]);
+			}
+			if ((v = in->dest) < 0) continue;
+			switch (in->op & OPMASK) {
+			case MOV:
+			case INC:
+			case DEC:
+				hint = SlotOf(lw, &in->src[0]);
+				break;
+			case CMOV:
+				hint = SlotOf(lw, &in->args[0]);
+			}
+			if ((s = ChooseSlot(lw, owner, maxslots, v, hint, MakesString(in))) < 0) return 0;
+			ir->values[v].slot = s;
+			if (lastblock[v] == b || outmark[v] == b) owner[s] = v;
+			for (k = 0; k < late; k++) Release(lw, owner, lastuse, outmark, b, j, &in->src[k]);
+		}
+	}
+	/* The slots of a function go after those of the units before it */
+	for (v = 0; v < ir->nvalues; v++) {
+		if (ir->values[v].slot >= 0) ir->values[v].slot += ir->slotbase;
+	}
+	lw->nullslot = ir->slotbase + lw->nslots;
+	lw->scratch = ir->slotbase + lw->nslots + 1;
+	ir->usedslots = lw->nslots + 2;
+	return 1;
+}
+
+static void Emit(Lower *lw, int op, int dest, int src1, int src2)
+{
+	Instruction *inst;
+
+	if (lw->size == lw->maxsize)
+		lw->code = (Instruction *)GrowArray(lw->arena, lw->code,
+			&lw->maxsize, sizeof(Instruction));
+	inst = &lw->code[lw->size++];
+	inst->op = op;
+	inst->dest = dest;
+	inst->src1.i = src1;
+	inst->src2.i = src2;
+}
+
+static void EmitJump(Lower *lw, int op, int block, int src1, int src2)
+{
+	if (lw->nfixups == lw->maxfixups)
+		lw->fixups = (int *)GrowArray(lw->arena, lw->fixups,
+			&lw->maxfixups, sizeof(int));
+	lw->fixups[lw->nfixups++] = lw->size;
+	Emit(lw, op|FLAG3, block, src1, src2);
+}
+
+/* The operand as src1 or src2, returns the flag for an immediate */
+static int Encode(const Lower *lw, const IROperand *opd, int flag, int *src)
+{
+	switch (opd->kind) {
+	case IRO_VALUE:
+		*src = lw->ir->values[opd->u.i].slot;
+		return 0;
+	case IRO_INT:
+	case IRO_FLOAT:
+		*src = opd->u.i;
+		return flag;
+	case IRO_MEM:
+		*src = opd->u.i;
+		return 0;
+	case IRO_UNDEF:
+		*src = lw->nullslot;
+		return 0;
+	}
+	*src = 0;
+	return 0;
+}
+
+static void MakeCopy(const Lower *lw, const IROperand *opd, int dest, Copy *copy)
+{
+	copy->op = MOV | Encode(lw, opd, FLAG1, &copy->src);
+	if (opd->kind == IRO_FLOAT) copy->op |= FLFLAG;
+	copy->dest = dest;
+}
+
+/* Order a parallel copy so that no slot is written before it is read */
+static void EmitCopies(Lower *lw, Copy *copies, int n)
+{
+	int i, j;
+
+	while (n) {
+		for (i = 0; i < n; i++) {
+			for (j = 0; j < n; j++) {
+				if (j != i && copies[j].op == MOV && copies[j].src == copies[i].dest)
+					break;
+			}
+			if (j == n) break;
+		}
+		if (i < n) {
+			Emit(lw, copies[i].op, copies[i].dest, copies[i].src, 0);
+			copies[i] = copies[--n];
+			continue;
+		}
+		/* Every destination is still to be read, save one */
+		Emit(lw, MOV, lw->scratch, copies[0].dest, 0);
+		for (j = 0; j < n; j++) {
+			if (copies[j].op == MOV && copies[j].src == copies[0].dest)
+				copies[j].src = lw->scratch;
+		}
+	}
+}
+
+/* The phi copies of every edge, generated aside */
+static void ResolvePhis(Lower *lw, int *nblocks)
+{
+	IRUnit *ir = lw->ir;
+	int i, j, k, n;
+
+	lw->edges = NEWARRAY(lw->arena, EdgeCode, ir->nblocks * 2);
+	for (i = 0; i < ir->nblocks * 2; i++) lw->edges[i].block = -1;
+	for (i = 0; i < ir->norder; i++) {
+		IRBlock *block = &ir->blocks[ir->order[i]];
+		Copy *copies;
+
+		if (!block->nphis) continue;
+		copies = NEWARRAY(lw->arena, Copy, block->nphis);
+		for (k = 0; k < block->npreds; k++) {
+			int p = block->preds[k];
+			EdgeCode *edge = &lw->edges[2 * p + block->predslot[k]];
+			Instruction *saved = lw->code;
+			int savedsize = lw->size, savedmax = lw->maxsize;
+
+			for (j = n = 0; j < block->nphis; j++) {
+				IRPhi *phi = &block->phis[j];
+				MakeCopy(lw, &phi->args[k], ir->values[phi->dest].slot, &copies[n]);
+				if (copies[n].op != MOV || copies[n].src != copies[n].dest) n++;
+			}
+			if (!n) continue;
+			lw->code = 0;
+			lw->size = lw->maxsize = 0;
+			EmitCopies(lw, copies, n);
+			edge->code = lw->code;
+			edge->n = lw->size;
+			if (ir->blocks[p].nsucc > 1) edge->block = (*nblocks)++;
+			lw->code = saved;
+			lw->size = savedsize;
+			lw->maxsize = savedmax;
+		}
+	}
+}
+
+/* Where the edge goes, the block made for it if any */
+static int EdgeTarget(const Lower *lw, int b, int k)
+{
+	const EdgeCode *edge = &lw->edges[2 * b + k];
+	return edge->block >= 0 ? edge->block : lw->forward[lw->ir->blocks[b].succ[k]];
+}
+
+static int IsEmpty(const Lower *lw, int b)
+{
+	const IRBlock *block = &lw->ir->blocks[b];
+	return b && block->ninsts == 1 && (block->insts[0].op & OPMASK) == JMP
+		&& !lw->edges[2 * b].n;
+}
+
+/* A jump to a block that only jumps on goes to the end of the chain, the
+ * block itself is left out. A chain that loops is kept. */
+static void ForwardJumps(Lower *lw)
+{
+	IRUnit *ir = lw->ir;
+	int b, t, n;
+
+	lw->forward = NEWARRAY(lw->arena, int, ir->nblocks);
+	for (b = 0; b < ir->nblocks; b++) {
+		lw->forward[b] = b;
+		if (ir->blocks[b].rpo < 0 || !IsEmpty(lw, b)) continue;
+		for (t = b, n = 0; IsEmpty(lw, t) && n < ir->nblocks; n++)
+			t = ir->blocks[t].succ[0];
+		if (!IsEmpty(lw, t)) lw->forward[b] = t;
+	}
+}
+
+/* A test of the value in src[0] for an integer or a string key */
+static int IsCase(const IRInst *in)
+{
+	if ((in->op & ~STRFLAG) != JE || in->src[0].kind != IRO_VALUE) return 0;
+	return in->src[1].kind == ((in->op & STRFLAG) ? IRO_MEM : IRO_INT);
+}
+
+/* A test falls through to the next one of the chain if that one is all
+ * of its block, which is reached from nowhere else */
+static int NextCase(const Lower *lw, int b)
+{
+	const IRBlock *block = &lw->ir->blocks[b], *next;
+	const IRInst *in = &block->insts[block->ninsts - 1];
+	int t = EdgeTarget(lw, b, 1);
+
+	if (t >= lw->ir->nblocks || t == b) return -1;
+	next = &lw->ir->blocks[t];
+	if (next->npreds != 1 || next->nphis || next->ninsts != 1 || lw->cases[t]
+		|| !IsCase(&next->insts[0]) || next->insts[0].op != in->op
+		|| next->insts[0].src[0].u.i != in->src[0].u.i)
+		return -1;
+	return t;
+}
+
+static void FindSwitches(Lower *lw)
+{
+	IRUnit *ir = lw->ir;
+	int i, b, t, n;
+
+	lw->cases = NEWARRAY(lw->arena, int, ir->nblocks);
+	for (i = 0; i < ir->norder; i++) {
+		const IRBlock *block = &ir->blocks[b = ir->order[i]];
+
+		if (lw->cases[b] || lw->forward[b] != b
+			|| !IsCase(&block->insts[block->ninsts - 1]))
+			continue;
+		for (t = b, n = 1; (t = NextCase(lw, t)) >= 0 && t != b; n++);
+		if (n < (ir->profiled ? 2 : MINCASES)) continue;
+		for (t = b; (t = NextCase(lw, t)) >= 0 && t != b; ) lw->cases[t] = -1;
+		lw->cases[b] = n;
+	}
+}
+
+/* Where a switch goes when no key matches */
+static int SwitchDefault(const Lower *lw, int b)
+{
+	int n = lw->cases[b], k;
+
+	for (k = 1; k < n; k++) b = EdgeTarget(lw, b, 1);
+	return EdgeTarget(lw, b, 1);
+}
+
+static void EmitInst(Lower *lw, const IRInst *in)
+{
+	int op = in->op & OPMASK, dest, src1, src2, flags, i;
+
+	dest = in->dest >= 0 ? lw->ir->values[in->dest].slot : 0;
+	switch (op) {
+	case MOV:
+		flags = Encode(lw, &in->src[0], FLAG1, &src1);
+		if (!flags && src1 == dest) return;
+		/* An immediate is stored with its own type */
+		if (flags) flags |= in->src[0].kind == IRO_FLOAT ? FLFLAG : 0;
+		Emit(lw, (flags ? MOV : in->op) | flags, dest, src1, 0);
+		return;
+	case INC:
+	case DEC:
+		flags = Encode(lw, &in->src[0], FLAG1, &src1);
+		if (flags || src1 != dest) {
+			Emit(lw, MOV | flags | (in->src[0].kind == IRO_FLOAT ? FLFLAG : 0),
+				dest, src1, 0);
+		}
+		Emit(lw, in->op, dest, 0, 0);
+		return;
+	case CMOV:
+		flags = Encode(lw, &in->args[0], FLAG1, &src1);
+		if (flags || src1 != dest) {
+			Emit(lw, MOV | flags | (in->args[0].kind == IRO_FLOAT ? FLFLAG : 0),
+				dest, src1, 0);
+		}
+		flags = Encode(lw, &in->src[0], FLAG1, &src1);
+		flags |= Encode(lw, &in->src[1], FLAG2, &src2);
+		/* The immediates share FLFLAG, one of another type goes aside */
+		if (flags == (FLAG1|FLAG2) && in->src[0].kind != in->src[1].kind) {
+			Emit(lw, MOV|FLAG1 | (in->src[1].kind == IRO_FLOAT ? FLFLAG : 0),
+				lw->scratch, src2, 0);
+			flags = FLAG1;
+			src2 = lw->scratch;
+		}
+		if (((flags & FLAG1) && in->src[0].kind == IRO_FLOAT)
+			|| ((flags & FLAG2) && in->src[1].kind == IRO_FLOAT))
+			flags |= FLFLAG;
+		Emit(lw, CMOV | flags, dest, src1, src2);
+		return;
+	case CALL:
+	case CALLU:
+		Emit(lw, op|FLAG1|FLAG2, dest, in->src[0].u.i, in->argc);
+		for (i = 0; i < in->argc; i++) {
+			flags = Encode(lw, &in->args[i], FLAG1, &src1);
+			if (in->args[i].kind == IRO_FLOAT) flags |= FLFLAG;
+			Emit(lw, ARG | flags, -1, src1, 0);
+		}
+		return;
+	}
+	flags = Encode(lw, &in->src[0], FLAG1, &src1);
+	flags |= Encode(lw, &in->src[1], FLAG2, &src2);
+	Emit(lw, in->op | flags, dest, src1, src2);
+}
+
+/* The jump taken when op isn't, -1 if there is none: a float compare
+ * with a NaN is false both ways */
+static int InverseJump(int op)
+{
+	switch (op & OPMASK) {
+	case JE:	return JNE;
+	case JNE:	return JE;
+	}
+	if (op & FLFLAG) return -1;
+	switch (op & OPMASK) {
+	case JG:	return JLE;
+	case JL:	return JGE;
+	case JLE:	return JG;
+	case JGE:	return JL;
+	}
+	return -1;
+}
+
+static int IsReturn(const Lower *lw, int b)
+{
+	return b < lw->ir->nblocks && lw->ir->blocks[b].ninsts == 1
+		&& (lw->ir->blocks[b].insts[0].op & OPMASK) == RET;
+}
+
+/* A small block ending with a compare and jump, the test of a loop */
+static int IsTest(const Lower *lw, int b)
+{
+	const IRBlock *block = &lw->ir->blocks[b];
+	return b < lw->ir->nblocks && block->ninsts <= MAXTESTSIZE && !lw->cases[b]
+		&& IsBranch(block->insts[block->ninsts - 1].op & OPMASK);
+}
+
+static void EmitTerminator(Lower *lw, int b, const IRInst *in, int next);
+
+/* A jump to a return is a return. A jump to a test is a copy of the
+ * test, so a loop whose test is at the top runs one jump per iteration
+ * instead of two, as if it were rotated to test at the bottom. */
+static void EmitGoto(Lower *lw, int target, int next)
+{
+	const IRBlock *block = &lw->ir->blocks[target];
+	int k;
+
+	if (target == next) return;
+	if (IsReturn(lw, target)) Emit(lw, RET|FLAG1|FLAG2|FLAG3, 0, 0, 0);
+	else if (IsTest(lw, target)) {
+		for (k = 0; k < block->ninsts - 1; k++) EmitInst(lw, &block->insts[k]);
+		EmitTerminator(lw, target, &block->insts[block->ninsts - 1], next);
+	}
+	else EmitJump(lw, JMP, target, 0, 0);
+}
+
+/* The tests of the chain as VMCode jumps to blocks, then the table */
+static void EmitSwitch(Lower *lw, int b, int next)
+{
+	int n = lw->cases[b], def = SwitchDefault(lw, b), size, i, t;
+	Instruction *tests = NEWARRAY(lw->arena, Instruction, n);
+	Instruction *table = NEWARRAY(lw->arena, Instruction, DISPATCHSIZE(n));
+	long *taken = NEWARRAY(lw->arena, long, n);
+	Instruction test;
+	long count;
+	int j;
+
+	for (i = 0, t = b; i < n; i++, t = EdgeTarget(lw, t, 1)) {
+		const IRBlock *block = &lw->ir->blocks[t];
+		const IRInst *in = &block->insts[block->ninsts - 1];
+
+		tests[i].op = in->op | FLAG3 | Encode(lw, &in->src[1], FLAG2, &tests[i].src2.i);
+		Encode(lw, &in->src[0], FLAG1, &tests[i].src1.i);
+		tests[i].dest = EdgeTarget(lw, t, 0);
+		taken[i] = block->taken;
+	}
+	size = PlanDispatch(lw->arena, tests, n, table);
+	if (!size) {
+		/* The keys differ, but for repeats that never match, so they
+		 * may be tested in any order. The sort is stable. */
+		for (i = 1; lw->ir->profiled && i < n; i++) {
+			test = tests[i];
+			count = taken[i];
+			for (j = i; j > 0 && taken[j - 1] < count; j--) {
+				tests[j] = tests[j - 1];
+				taken[j] = taken[j - 1];
+			}
+			tests[j] = test;
+			taken[j] = count;
+		}
+		table = tests;
+		size = n;
+	}
+	for (i = 0; i < size; i++) {
+		if ((table[i].op & OPMASK) == JE)
+			EmitJump(lw, table[i].op, table[i].dest < 0 ? def : table[i].dest,
+				table[i].src1.i, table[i].src2.i);
+		else Emit(lw, table[i].op, table[i].dest, table[i].src1.i, table[i].src2.i);
+	}
+	EmitGoto(lw, def, next);
+}
+
+static void EmitTerminator(Lower *lw, int b, const IRInst *in, int next)
+{
+	int op = in->op & OPMASK, taken, fall, flags, src1, src2;
+
+	switch (op) {
+	case RET:
+		Emit(lw, RET|FLAG1|FLAG2|FLAG3, 0, 0, 0);
+		return;
+	case RETU:
+		/* The type is kept in dest */
+		flags = Encode(lw, &in->src[0], FLAG1, &src1);
+		if (flags && in->src[0].kind == IRO_FLOAT) flags |= FLFLAG;
+		Emit(lw, RETU|FLAG2|FLAG3 | flags, in->src[1].u.i, src1, 0);
+		return;
+	case JMP:
+		EmitGoto(lw, EdgeTarget(lw, b, 0), next);
+		return;
+	}
+	if (lw->cases[b] > 0) {
+		EmitSwitch(lw, b, next);
+		return;
+	}
+	taken = EdgeTarget(lw, b, 0);
+	fall = EdgeTarget(lw, b, 1);
+	flags = Encode(lw, &in->src[0], FLAG1, &src1);
+	flags |= Encode(lw, &in->src[1], FLAG2, &src2);
+	if (taken == next && fall != next && InverseJump(in->op) != -1) {
+		EmitJump(lw, (in->op ^ op) | InverseJump(in->op) | flags, fall, src1, src2);
+		return;
+	}
+	EmitJump(lw, in->op | flags, taken, src1, src2);
+	if (fall != next) EmitJump(lw, JMP, fall, 0, 0);
+}
+
+static void EmitEdge(Lower *lw, const EdgeCode *edge)
+{
+	int i;
+
+	for (i = 0; i < edge->n; i++) {
+		Emit(lw, edge->code[i].op, edge->code[i].dest,
+			edge->code[i].src1.i, edge->code[i].src2.i);
+	}
+}
+
+/* Where an edge block goes, a block goes to itself */
+static int Destination(const Lower *lw, const int *edgeof, int b)
+{
+	int j;
+
+	if (b < lw->ir->nblocks) return b;
+	j = edgeof[b - lw->ir->nblocks];
+	return lw->forward[lw->ir->blocks[j / 2].succ[j % 2]];
+}
+
+/* The block to lay out after b, -1 if none. A branch is followed by the
+ * successor that comes first in the code. */
+static int Follow(const Lower *lw, const int *edgeof, const char *placed, int b)
+{
+	const IRUnit *ir = lw->ir;
+	int t0, t1;
+
+	if (b >= ir->nblocks) t0 = t1 = Destination(lw, edgeof, b);
+	else {
+		switch (ir->blocks[b].insts[ir->blocks[b].ninsts - 1].op & OPMASK) {
+		case RET:
+		case RETU:
+			return -1;
+		case JMP:
+			t0 = t1 = EdgeTarget(lw, b, 0);
+			break;
+		default:
+			if (lw->cases[b]) {
+				t0 = t1 = SwitchDefault(lw, b);
+				break;
+			}
+			t0 = EdgeTarget(lw, b, 0);
+			t1 = EdgeTarget(lw, b, 1);
+			if (Destination(lw, edgeof, t0) > Destination(lw, edgeof, t1)) {
+				int t = t0;
+				t0 = t1;
+				t1 = t;
+			}
+		}
+	}
+	if (!placed[t0]) return t0;
+	return placed[t1] ? -1 : t1;
+}
+
+/* The times block b ran, an edge block as often as its edge */
+static long BlockCount(const Lower *lw, const int *edgeof, int b)
+{
+	int j;
+
+	if (b < lw->ir->nblocks) return lw->ir->blocks[b].count;
+	j = edgeof[b - lw->ir->nblocks];
+	return EdgeCount(&lw->ir->blocks[j / 2], j % 2);
+}
+
+/* Where b may fall through to, as Follow sees it, and how often it went
+ * there. Returns the number of them. */
+static int Successors(const Lower *lw, const int *edgeof, int b, int *succ, long *count)
+{
+	const IRBlock *block;
+	int k, t;
+
+	if (b >= lw->ir->nblocks) {
+		succ[0] = Destination(lw, edgeof, b);
+		count[0] = BlockCount(lw, edgeof, b);
+		return 1;
+	}
+	block = &lw->ir->blocks[b];
+	switch (block->insts[block->ninsts - 1].op & OPMASK) {
+	case RET:
+	case RETU:
+		return 0;
+	case JMP:
+		succ[0] = EdgeTarget(lw, b, 0);
+		count[0] = block->count;
+		return 1;
+	}
+	if (lw->cases[b]) {
+		for (k = 1, t = b; k < lw->cases[b]; k++) t = EdgeTarget(lw, t, 1);
+		succ[0] = SwitchDefault(lw, b);
+		count[0] = EdgeCount(&lw->ir->blocks[t], 1);
+		return 1;
+	}
+	for (k = 0; k < 2; k++) {
+		succ[k] = EdgeTarget(lw, b, k);
+		count[k] = EdgeCount(block, k);
+	}
+	return 2;
+}
+
+/* An edge from one block to another, or a chain from its head */
+typedef struct Arc {
+	long count;
+	int index;
+	int from, to;
+} Arc;
+
+/* The most frequent first, else in the order they came */
+static int CompareArc(const void *a, const void *b)
+{
+	const Arc *a1 = (const Arc *)a, *a2 = (const Arc *)b;
+
+	if (a1->count != a2->count) return a1->count < a2->count ? 1 : -1;
+	return a1->index - a2->index;
+}
+
+/* With a profile the blocks are chained along their most frequent edges
+ * first, so that the hot paths fall through, then the chains are laid
+ * out the hottest first, after the one of the entry. Returns the number
+ * of blocks laid out. */
+static int ChainBlocks(Lower *lw, const int *edgeof, const int *blocks, int n,
+	int nblocks, int *layout)
+{
+	Arc *arcs = NEWARRAY(lw->arena, Arc, 2 * n);
+	Arc *chains = NEWARRAY(lw->arena, Arc, n);
+	int *next = NEWARRAY(lw->arena, int, nblocks);
+	int *prev = NEWARRAY(lw->arena, int, nblocks);
+	int *chain = NEWARRAY(lw->arena, int, nblocks);
+	long *heat = NEWARRAY(lw->arena, long, nblocks);
+	int succ[2], narcs = 0, nchains = 0, nlayout = 0, i, k, m, b;
+	long count[2];
+
+	for (b = 0; b < nblocks; b++) {
+		next[b] = prev[b] = -1;
+		chain[b] = b;
+		heat[b] = -1;
+	}
+	for (i = 0; i < n; i++) heat[blocks[i]] = 0;
+	for (i = 0; i < n; i++) {
+		m = Successors(lw, edgeof, blocks[i], succ, count);
+		for (k = 0; k < m; k++) {
+			arcs[narcs].count = count[k];
+			arcs[narcs].index = narcs;
+			arcs[narcs].from = blocks[i];
+			arcs[narcs].to = succ[k];
+			narcs++;
+		}
+	}
+	qsort(arcs, narcs, sizeof(Arc), CompareArc);
+	for (i = 0; i < narcs; i++) {
+		int from = arcs[i].from, to = arcs[i].to;
+
+		if (next[from] >= 0 || prev[to] >= 0 || to == 0 || heat[to] < 0
+			|| FindGroup(chain, from) == FindGroup(chain, to))
+			continue;
+		next[from] = to;
+		prev[to] = from;
+		JoinGroups(chain, from, to);
+	}
+
+	for (i = 0; i < n; i++) {
+		long *h = &heat[FindGroup(chain, blocks[i])];
+		if (BlockCount(lw, edgeof, blocks[i]) > *h) *h = BlockCount(lw, edgeof, blocks[i]);
+	}
+	for (i = 0; i < n; i++) {
+		if (prev[b = blocks[i]] >= 0) continue;
+		chains[nchains].count = heat[FindGroup(chain, b)];
+		chains[nchains].index = i;
+		chains[nchains].from = b;
+		nchains++;
+	}
+	/* The entry is blocks[0] and heads its chain */
+	qsort(chains + 1, nchains - 1, sizeof(Arc), CompareArc);
+	for (i = 0; i < nchains; i++) {
+		for (b = chains[i].from; b >= 0; b = next[b]) layout[nlayout++] = b;
+	}
+	return nlayout;
+}
+
+/* The times a jump of the layout to a block other than the next runs by
+ * the profile. A goto to a return or a test is copied, which costs
+ * nothing. */
+static long LayoutCost(const Lower *lw, const int *edgeof, const int *layout, int nlayout)
+{
+	int succ[2], next, i;
+	long count[2], cost = 0;
+
+	for (i = 0; i < nlayout; i++) {
+		next = i + 1 < nlayout ? layout[i + 1] : -1;
+		switch (Successors(lw, edgeof, layout[i], succ, count)) {
+		case 1:
+			if (succ[0] != next && !IsReturn(lw, succ[0]) && !IsTest(lw, succ[0]))
+				cost += count[0];
+			break;
+		case 2:
+			if (succ[0] != next && succ[1] != next) cost += count[1];
+			break;
+		}
+	}
+	return cost;
+}
+
+int LowerIR(IRUnit *ir, Instruction *code, int maxsize)
+{
+	Lower lower, *lw = &lower;
+	IRBlock *block;
+	int *layout, *addr, *edgeof, *blocks, nblocks = ir->nblocks, nlayout = 0;
+	char *placed;
+	int i, j, k, b, n = 0;
+
+	memset(lw, 0, sizeof(Lower));
+	lw->ir = ir;
+	lw->arena = ir->arena;
+	Liveness(lw);
+	if (!AssignSlots(lw)) return -1;
+	ResolvePhis(lw, &nblocks);
+	ForwardJumps(lw);
+	FindSwitches(lw);
+
+	/* The blocks keep their order, the edge blocks go last, but a block
+	 * is followed by where it jumps or falls through to if that isn't
+	 * laid out yet */
+	layout = NEWARRAY(lw->arena, int, nblocks);
+	blocks = NEWARRAY(lw->arena, int, nblocks);
+	placed = NEWARRAY(lw->arena, char, nblocks);
+	edgeof = NEWARRAY(lw->arena, int, nblocks - ir->nblocks);
+	for (b = 0; b < ir->nblocks; b++) {
+		if (ir->blocks[b].rpo >= 0 && lw->forward[b] == b && lw->cases[b] >= 0)
+			blocks[n++] = b;
+	}
+	for (i = 0; i < ir->nblocks * 2; i++) {
+		if ((b = lw->edges[i].block) < 0) continue;
+		blocks[n++] = b;
+		edgeof[b - ir->nblocks] = i;
+	}
+	for (i = 0; i < n; i++) {
+		for (b = blocks[i]; b >= 0 && !placed[b]; b = Follow(lw, edgeof, placed, b)) {
+			placed[b] = 1;
+			layout[nlayout++] = b;
+		}
+	}
+	/* The chains of a profile are laid out instead if they run fewer jumps */
+	if (ir->profiled) {
+		int *chained = NEWARRAY(lw->arena, int, nblocks);
+		int nchained = ChainBlocks(lw, edgeof, blocks, n, nblocks, chained);
+
+		if (LayoutCost(lw, edgeof, chained, nchained)
+			< LayoutCost(lw, edgeof, layout, nlayout)) {
+			layout = chained;
+			nlayout = nchained;
+		}
+	}
+
+	addr = NEWARRAY(lw->arena, int, nblocks);
+	for (i = 0; i < nlayout; i++) {
+		int next = i + 1 < nlayout ? layout[i + 1] : -1;
+
+		b = layout[i];
+		addr[b] = lw->size;
+		if (b >= ir->nblocks) {
+			j = edgeof[b - ir->nblocks];
+			EmitEdge(lw, &lw->edges[j]);
+			EmitGoto(lw, lw->forward[ir->blocks[j / 2].succ[j % 2]], next);
+			continue;
+		}
+		block = &ir->blocks[b];
+		for (k = 0; k < block->ninsts - 1; k++) EmitInst(lw, &block->insts[k]);
+		if (block->nsucc == 1) EmitEdge(lw, &lw->edges[2 * b]);
+		EmitTerminator(lw, b, &block->insts[block->ninsts - 1], next);
+	}
+
+	if (lw->size > maxsize) return -1;
+	for (i = 0; i < lw->nfixups; i++)
+		lw->code[lw->fixups[i]].dest = addr[lw->code[lw->fixups[i]].dest];
+	memcpy(code, lw->code, lw->size * sizeof(Instruction));
+	return lw->size;
+}
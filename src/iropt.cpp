@@ -0,0 +1,170 @@
+/* iropt.cpp - Optimize VMCode through the SSA form
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ir.h"
+
+/* Optimize a unit of code into out, with its slots from slotbase on.
+ * Returns the size, or -1 if it can't be, and the slots it used. */
+static int OptimizeUnit(Arena *arena, const Instruction *code, int size, int unroll,
+	const Profile *profile, int slotbase, Instruction *out, int maxsize, int *used)
+{
+	IRUnit *ir;
+
+	if (!(ir = BuildIR(arena, code, size, profile))) return -1;
+	ir->slotbase = slotbase;
+	PropagateConstants(ir);
+	PropagateCopies(ir);
+	if (NumberValues(ir)) PropagateCopies(ir);
+	RemoveDeadCode(ir);
+	MergeBlocks(ir);
+	HoistInvariants(ir);
+	UnrollLoops(ir, unroll);
+	ReduceStrength(ir);
+	size = LowerIR(ir, out, maxsize);
+	*used = ir->usedslots;
+	return size;
+}
+
+/* The counts of a unit, whose instruction k was at from[k] */
+static Profile *UnitProfile(Arena *arena, const Profile *profile, const int *from, int size)
+{
+	Profile *unit;
+	int k;
+
+	if (!profile) return NULL;
+	unit = NEWARRAY(arena, Profile, 1);
+	unit->count = NEWARRAY(arena, long, size + 1);
+	unit->taken = NEWARRAY(arena, long, size + 1);
+	unit->size = size;
+	for (k = 0; k < size; k++) {
+		unit->count[k] = profile->count[from[k]];
+		unit->taken[k] = profile->taken[from[k]];
+	}
+	return unit;
+}
+
+static int IsJump(int op)
+{
+	return (op & OPMASK) == JMP || IsBranch(op & OPMASK);
+}
+
+/* Each function, from its ENTER to the end in its dest, is a unit of its
+ * own, the rest of the code is the main unit. They are linked back with
+ * the main unit first, each function after its ENTER, and the slots of a
+ * unit after those of the units before it. Returns -1 if a unit can't be
+ * optimized or a jump leaves its unit. */
+static int OptimizeFunctions(Arena *arena, Instruction *code, int size, int unroll,
+	const Profile *profile)
+{
+	int *unitof = NEWARRAY(arena, int, size + 1);
+	int *pos = NEWARRAY(arena, int, size + 1);
+	int *from = NEWARRAY(arena, int, size + 1);
+	int *funcs = NEWARRAY(arena, int, size + 1);
+	int *entry = NEWARRAY(arena, int, size + 1);
+	Instruction *unit = NEWARRAY(arena, Instruction, size + 1);
+	Instruction *out = NEWARRAY(arena, Instruction, CODESIZE);
+	int nfuncs = 0, n = 0, base = 0, total, used, addr, f, k;
+
+	for (addr = 0; addr < size; addr++) {
+		if ((code[addr].op & OPMASK) != ENTER) continue;
+		if (code[addr].dest <= addr || code[addr].dest > size) return -1;
+		funcs[nfuncs++] = addr;
+		for (k = addr; k < code[addr].dest; k++) {
+			unitof[k] = nfuncs;
+			pos[k] = k - addr - 1;
+		}
+		addr = code[addr].dest - 1;
+	}
+	for (addr = 0; addr <= size; addr++) {
+		if (addr < size && unitof[addr]) continue;
+		pos[addr] = n;
+		from[n++] = addr;
+	}
+
+	/* The main unit */
+	for (k = 0; k < n - 1; k++) {
+		unit[k] = code[from[k]];
+		if (!IsJump(unit[k].op)) continue;
+		if (!(unit[k].op & FLAG3) || unit[k].dest < 0 || unit[k].dest > size
+			|| (unit[k].dest < size && unitof[unit[k].dest]))
+			return -1;
+		unit[k].dest = pos[unit[k].dest];
+	}
+	total = OptimizeUnit(arena, unit, n - 1, unroll, UnitProfile(arena, profile, from, n - 1),
+		base, out, CODESIZE, &used);
+	if (total < 0) return -1;
+	base += used;
+
+	for (f = 0; f < nfuncs; f++) {
+		int enter = funcs[f], end = code[enter].dest, fsize;
+
+		for (k = 0, addr = enter + 1; addr < end; k++, addr++) {
+			unit[k] = code[addr];
+			from[k] = addr;
+			if (!IsJump(unit[k].op)) continue;
+			if (!(unit[k].op & FLAG3) || unit[k].dest <= enter || unit[k].dest >= end)
+				return -1;
+			unit[k].dest = pos[unit[k].dest];
+		}
+		if (total >= CODESIZE) return -1;
+		fsize = OptimizeUnit(arena, unit, k, unroll, UnitProfile(arena, profile, from, k),
+			base, out + total + 1, CODESIZE - total - 1, &used);
+		if (fsize < 0 || base + used > HEAPSTART) return -1;
+		for (k = total + 1; k < total + 1 + fsize; k++) {
+			if (IsJump(out[k].op)) out[k].dest += total + 1;
+		}
+		out[total] = code[enter];
+		out[total].src1.i = base;
+		out[total].src2.i = used;
+		out[total].dest = total + 1 + fsize;
+		entry[f] = total;
+		base += used;
+		total += 1 + fsize;
+	}
+
+	for (k = 0; k < total; k++) {
+		if ((out[k].op & OPMASK) != CALLU) continue;
+		addr = out[k].src1.i;
+		if (addr < 0 || addr >= size || (code[addr].op & OPMASK) != ENTER) return -1;
+		out[k].src1.i = entry[unitof[addr] - 1];
+	}
+	memcpy(code, out, total * sizeof(Instruction));
+	return total;
+}
+
+/* Level 0 leaves the code as it is. The code that can't be lifted is
+ * only compacted, and left as it is when a jump goes nowhere, e.g. a
+ * goto to a label that is never defined.
+ * The counted loops are unrolled by the factor unroll, 1 doesn't.
+ * A profile of the code, which may be NULL, guides the unrolling and
+ * the layout of the blocks. */
+int OptimizeCode(Arena *arena, Instruction *code, int size, int level, int unroll,
+	const Profile *profile)
+{
+	int newsize, used, addr;
+
+	if (level <= 0) return size;
+	for (addr = 0; addr < size && (code[addr].op & OPMASK) != ENTER; addr++);
+	if (addr < size) newsize = OptimizeFunctions(arena, code, size, unroll, profile);
+	else newsize = OptimizeUnit(arena, code, size, unroll, profile, 0, code, CODESIZE, &used);
+	return newsize < 0 ? CompactCode(arena, code, size) : newsize;
+}
@@ -0,0 +1,189 @@
+/* irvn.cpp - Number the values and reuse the computations done before
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* An instruction computes the same value as one with the same opcode and
+ * operands in a dominating block, or before it in its own block. In the
+ * SSA form an assignment, INC or DEC of a variable defines a new value,
+ * so the operands are the same only if nothing changed them in between.
+ * The later one becomes a MOV of the first one's value for
+ * PropagateCopies and RemoveDeadCode. If the first one stopped the VM,
+ * the later one isn't reached, so only the side effects matter: the
+ * CALLs of the builtins that aren't pure and of the user functions are
+ * left alone. */
+
+#include "ir.h"
+#include "funcdefs.h"
+
+#define HASHSIZE 4096
+
+typedef struct Expr {
+	const IRInst *in;
+	IROperand src[2];		/* in the order of the key */
+	unsigned hash;
+	struct Expr *next;
+} Expr;
+
+static int Numbered(const IRInst *in)
+{
+	switch (in->op & OPMASK) {
+	case MOV:
+		return 0;
+	case CALL:
+		return in->dest >= 0 && Function[in->src[0].u.i].pure;
+	case CALLU:
+		return 0;
+	}
+	return in->dest >= 0 && !IsTerminator(in->op & OPMASK);
+}
+
+static int Commutative(int op)
+{
+	if (op & STRFLAG) return 0;
+	switch (op & OPMASK) {
+	case ADD:
+	case MUL:
+	case EQU:
+	case NOTEQU:
+		return 1;
+	case AND:
+	case OR:
+	case XOR:
+		return !(op & FLFLAG);
+	}
+	return 0;
+}
+
+/* Floats are compared by their bits, so -0 isn't 0 and a NaN is itself */
+static int SameOperand(const IROperand *a, const IROperand *b)
+{
+	return a->kind == b->kind && (a->kind == IRO_NONE || a->u.i == b->u.i);
+}
+
+static int Less(const IROperand *a, const IROperand *b)
+{
+	return a->kind < b->kind || (a->kind == b->kind && a->u.i < b->u.i);
+}
+
+static unsigned HashOperand(unsigned h, const IROperand *opd)
+{
+	h = h * 31 + opd->kind;
+	return h * 31 + (opd->kind == IRO_NONE ? 0 : (unsigned)opd->u.i);
+}
+
+static void MakeKey(const IRInst *in, Expr *e)
+{
+	int k;
+
+	e->in = in;
+	e->src[0] = in->src[0];
+	e->src[1] = in->src[1];
+	if (Commutative(in->op) && Less(&e->src[1], &e->src[0])) {
+		e->src[0] = in->src[1];
+		e->src[1] = in->src[0];
+	}
+	e->hash = (unsigned)in->op * 31 + in->argc;
+	e->hash = HashOperand(e->hash, &e->src[0]);
+	e->hash = HashOperand(e->hash, &e->src[1]);
+	for (k = 0; k < in->argc; k++) e->hash = HashOperand(e->hash, &in->args[k]);
+}
+
+static int SameExpr(const Expr *a, const Expr *b)
+{
+	int k;
+
+	if (a->hash != b->hash || a->in->op != b->in->op
+		|| a->in->argc != b->in->argc || !SameOperand(&a->src[0], &b->src[0])
+		|| !SameOperand(&a->src[1], &b->src[1]))
+		return 0;
+	for (k = 0; k < a->in->argc; k++) {
+		if (!SameOperand(&a->in->args[k], &b->in->args[k])) return 0;
+	}
+	return 1;
+}
+
+static void Enter(IRUnit *ir, IRBlock *block, Expr **table, IntList *undo,
+	int *replaced)
+{
+	int j;
+
+	for (j = 0; j < block->ninsts; j++) {
+		IRInst *in = &block->insts[j];
+		Expr *e, *found;
+
+		if (!Numbered(in)) continue;
+		e = NEWARRAY(ir->arena, Expr, 1);
+		MakeKey(in, e);
+		for (found = table[e->hash % HASHSIZE]; found; found = found->next) {
+			if (SameExpr(found, e)) break;
+		}
+		if (found) {
+			in->op = MOV;
+			in->src[0].kind = IRO_VALUE;
+			in->src[0].u.i = found->in->dest;
+			in->src[1].kind = IRO_NONE;
+			in->argc = 0;
+			in->args = 0;
+			(*replaced)++;
+			continue;
+		}
+		e->next = table[e->hash % HASHSIZE];
+		table[e->hash % HASHSIZE] = e;
+		ListAdd(ir->arena, undo, e->hash % HASHSIZE);
+	}
+}
+
+/* Walks the dominator tree, the expressions of a block are taken off
+ * the table when its subtree is done. Returns the number of
+ * instructions replaced. */
+int NumberValues(IRUnit *ir)
+{
+	Expr **table = NEWARRAY(ir->arena, Expr *, HASHSIZE);
+	IntList *children = NEWARRAY(ir->arena, IntList, ir->nblocks);
+	int *stack = NEWARRAY(ir->arena, int, ir->nblocks);
+	int *child = NEWARRAY(ir->arena, int, ir->nblocks);
+	int *mark = NEWARRAY(ir->arena, int, ir->nblocks);
+	IntList undo = {0, 0, 0};
+	int nstack = 0, replaced = 0, i;
+
+	for (i = 1; i < ir->norder; i++) {
+		int b = ir->order[i];
+		ListAdd(ir->arena, &children[ir->blocks[b].idom], b);
+	}
+	stack[nstack++] = 0;
+	Enter(ir, &ir->blocks[0], table, &undo, &replaced);
+	while (nstack) {
+		int b = stack[nstack - 1];
+
+		if (child[b] < children[b].n) {
+			int c = children[b].data[child[b]++];
+
+			mark[c] = undo.n;
+			stack[nstack++] = c;
+			Enter(ir, &ir->blocks[c], table, &undo, &replaced);
+			continue;
+		}
+		while (undo.n > mark[b]) {
+			int h = undo.data[--undo.n];
+			table[h] = table[h]->next;
+		}
+		nstack--;
+	}
+	return replaced;
+}
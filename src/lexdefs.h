@@ -0,0 +1,69 @@
+/* lexdefs.h - keyword and symbol lists of the lexis analyzer
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LEXDEFS_H
+#define __LEXDEFS_H
+
+/* Both lists are expanded by element.h/element.c and by lexgen, which
+ * generates the DFA and keyword hash tables in lextab.h at build time.
+ * Keep the order: keyword ids and symbol ids are the indexes here. */
+
+#define MYL_KEYWORDS(X) \
+	X("if") X("else") X("for") X("while") X("do") \
+	X("continue") X("break") X("switch") X("case") \
+	X("default") X("goto") X("return") \
+	/* Types */ \
+	X("integer") X("float") X("string") X("list")
+
+#define MYL_SYMBOLS(X) \
+	X(S_SET, "=") \
+	X(S_ADDSET, "+=") X(S_SUBSET, "-=") X(S_LSSET, "<<=") \
+	X(S_RSSET, ">>=") X(S_XORSET, "^=") \
+	X(S_MULSET, "*=") X(S_DIVSET, "/=") X(S_MODSET, "%=") \
+	X(S_ORSET, "|=") X(S_ANDSET, "&=") \
+	X(S_SELECT, "?") X(S_COLON, ":") \
+	X(S_LOGNOT, "!") \
+	X(S_LOGOR, "||") \
+	X(S_LOGAND, "&&") \
+	X(S_BITOR, "|") \
+	X(S_BITAND, "&") \
+	X(S_NOTEQU, "!=") X(S_EQU, "==") \
+	X(S_LESS, "<") X(S_LE, "<=") X(S_GREAT, ">") X(S_GE, ">=") \
+	X(S_LSHIFT, "<<") X(S_RSHIFT, ">>") \
+	X(S_ADD, "+") X(S_SUB, "-") \
+	X(S_MUL, "*") X(S_DIV, "/") X(S_MOD, "%") \
+	X(S_NOT, "~") X(S_INC, "++") X(S_DEC, "--") \
+	X(S_LPARA, "(") X(S_RPARA, ")") \
+	X(S_LBRACKET, "{") X(S_RBRACKET, "}") \
+	X(S_QUOTE, "\"") X(S_COMMA, ",") X(S_SEMICOLON, ";") \
+	X(S_POINT, ".") X(S_BITXOR, "^")
+
+/* Character classes, indexed by ch+1 so that EOF maps to slot 0 */
+enum {
+	LEX_EOF, LEX_BLANK, LEX_ALPHA, LEX_DIGIT, LEX_SYMBOL, LEX_QUOTE,
+	LEX_APOS, LEX_OTHER
+};
+
+/* Accept codes of the symbol DFA beyond the symbol ids */
+#define LEX_NOACCEPT	-1
+#define LEX_COMMENT		-2
+
+#endif
+
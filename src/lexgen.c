@@ -0,0 +1,167 @@
+/* lexgen.c - generate the lexis analyzer tables
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Runs at build time and prints lextab.h on stdout:
+ *   LexCharClass - class of every character, indexed by ch+1
+ *   LexSymClass, LexSymNext, LexSymAccept - the symbol DFA, a trie
+ *     over the symbol list plus the comment opener
+ *   LexKwSlot - a collision free hash table of the keywords */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexdefs.h"
+
+#define TABLE_SIZE(__x) ((int)(sizeof(__x)/sizeof(__x[0])))
+#define MAXSTATES 64
+#define MAXCLASSES 32
+
+#define KEYWORD_TEXT(__text) __text,
+static const char *Keywords[] = { MYL_KEYWORDS(KEYWORD_TEXT) };
+
+#define SYMBOL_TEXT(__id, __text) __text,
+static const char *Symbols[] = { MYL_SYMBOLS(SYMBOL_TEXT) };
+
+static int SymClass[257];
+static int ClassCount = 1;		/* class 0: not part of any symbol */
+static int Next[MAXSTATES][MAXCLASSES];
+static int Accept[MAXSTATES];
+static int StateCount = 1;		/* state 0: start */
+
+static void Fail(const char *msg)
+{
+	fprintf(stderr, "lexgen: %s\n", msg);
+	exit(1);
+}
+
+static void AddString(const char *text, int accept)
+{
+	int state = 0;
+	const unsigned char *p;
+
+	for (p = (const unsigned char *)text; *p; p++) {
+		int cls = SymClass[*p + 1];
+
+		if (!cls) {
+			if (ClassCount == MAXCLASSES) Fail("too many symbol classes");
+			cls = SymClass[*p + 1] = ClassCount++;
+		}
+		if (!Next[state][cls]) {
+			if (StateCount == MAXSTATES) Fail("too many states");
+			Accept[StateCount] = LEX_NOACCEPT;
+			Next[state][cls] = StateCount++;
+		}
+		state = Next[state][cls];
+	}
+	Accept[state] = accept;
+}
+
+static int CharClass(int ch)
+{
+	int i;
+
+	if (ch == EOF) return LEX_EOF;
+	if (ch == ' ' || ch == '\t' || ch == '\n') return LEX_BLANK;
+	if (isalpha(ch)) return LEX_ALPHA;
+	if (isdigit(ch)) return LEX_DIGIT;
+	if (ch == '\"') return LEX_QUOTE;
+	if (ch == '\'') return LEX_APOS;
+	for (i = 0; i < TABLE_SIZE(Symbols); i++) {
+		if (strchr(Symbols[i], ch) && ch) return LEX_SYMBOL;
+	}
+	return LEX_OTHER;
+}
+
+static unsigned KeywordHash(const char *s, unsigned k1, unsigned k2, unsigned mask)
+{
+	int len = strlen(s);
+
+	return ((unsigned char)s[0] * k1 + (unsigned char)s[len - 1] * k2 + len) & mask;
+}
+
+static void PrintTable(const char *decl, const int *data, int count)
+{
+	int i;
+
+	printf("%s = {", decl);
+	for (i = 0; i < count; i++) {
+		printf("%s%d,", i % 16 ? " " : "\n\t", data[i]);
+	}
+	printf("\n};\n\n");
+}
+
+int main()
+{
+	int i, ch;
+	int classes[257];
+	int slot[256];
+	unsigned size, k1, k2;
+
+	/* Symbol DFA. The quote opens a string and is handled by the caller */
+	Accept[0] = LEX_NOACCEPT;
+	for (i = 0; i < TABLE_SIZE(Symbols); i++) {
+		if (strcmp(Symbols[i], "\"")) AddString(Symbols[i], i);
+	}
+	AddString("/*", LEX_COMMENT);
+	for (i = 1; i < StateCount; i++) {
+		/* Every prefix must be a token, so the DFA never backtracks */
+		if (Accept[i] == LEX_NOACCEPT) Fail("symbol prefix is not a symbol");
+	}
+
+	/* Keyword hash: smallest power of two table without collisions */
+	for (size = 1; size < (unsigned)TABLE_SIZE(Keywords); size <<= 1);
+	for (; size <= 256; size <<= 1) {
+		for (k1 = 1; k1 < 256; k1++) {
+			for (k2 = 1; k2 < 256; k2++) {
+				for (i = 0; i < (int)size; i++) slot[i] = -1;
+				for (i = 0; i < TABLE_SIZE(Keywords); i++) {
+					unsigned h = KeywordHash(Keywords[i], k1, k2, size - 1);
+					if (slot[h] != -1) break;
+					slot[h] = i;
+				}
+				if (i == TABLE_SIZE(Keywords)) goto found;
+			}
+		}
+	}
+	Fail("no perfect hash for the keywords");
+found:
+
+	printf("/* lextab.h - generated by lexgen from lexdefs.h, do not edit */\n\n");
+	for (ch = -1; ch < 256; ch++) classes[ch + 1] = CharClass(ch);
+	PrintTable("static const unsigned char LexCharClass[257]", classes, 257);
+	PrintTable("static const unsigned char LexSymClass[257]", SymClass, 257);
+	printf("#define LEX_SYMSTATES %d\n#define LEX_SYMCLASSES %d\n\n",
+		StateCount, ClassCount);
+	printf("static const unsigned char LexSymNext[LEX_SYMSTATES][LEX_SYMCLASSES] = {\n");
+	for (i = 0; i < StateCount; i++) {
+		int c;
+		printf("\t{");
+		for (c = 0; c < ClassCount; c++) printf("%s%d", c ? ", " : "", Next[i][c]);
+		printf("},\n");
+	}
+	printf("};\n\n");
+	PrintTable("static const signed char LexSymAccept[LEX_SYMSTATES]", Accept, StateCount);
+	printf("#define LEX_KW_SIZE %u\n#define LEX_KW_K1 %u\n#define LEX_KW_K2 %u\n\n",
+		size, k1, k2);
+	PrintTable("static const signed char LexKwSlot[LEX_KW_SIZE]", slot, size);
+	return 0;
+}
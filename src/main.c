@@ -20,20 +20,53 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 #include "myl.h"
 #include "fileio.h"
+#include "output.h"
 
 int main(int argc, char* argv[])
 {
 	MYLParser *parser = NULL;
 	InputStream *stream = NULL;
+	int frontend = MYL_PARSER_YACC;
+	int optlevel = 1, unroll = 4, stats = 0;
+	const char *profileout = NULL, *profilein = NULL;
+	int arg;
 
-	if (argc != 2) {
-		printf("usage::=myl <infile>\n");
+	for (arg = 1; arg < argc - 1; arg++) {
+		if (!strcmp(argv[arg], "--parser=yacc"))
+			frontend = MYL_PARSER_YACC;
+		else if (!strcmp(argv[arg], "--parser=rd"))
+			frontend = MYL_PARSER_RD;
+		else if (!strcmp(argv[arg], "-O0"))
+			optlevel = 0;
+		else if (!strcmp(argv[arg], "-O1"))
+			optlevel = 1;
+		else if (!strncmp(argv[arg], "--unroll=", 9) && atoi(argv[arg] + 9) > 0)
+			unroll = atoi(argv[arg] + 9);
+		else if (!strcmp(argv[arg], "--stats"))
+			stats = 1;
+		else if (!strncmp(argv[arg], "--profile-out=", 14) && argv[arg][14])
+			profileout = argv[arg] + 14;
+		else if (!strncmp(argv[arg], "--profile-in=", 13) && argv[arg][13])
+			profilein = argv[arg] + 13;
+		else if (!strncmp(argv[arg], "--outbuf=", 9) && isdigit((unsigned char)argv[arg][9]))
+			SetOutputSize(atoi(argv[arg] + 9));
+		else if (!strncmp(argv[arg], "--load=", 7) && argv[arg][7]) {
+			if (!LoadExtension(argv[arg] + 7)) return 4;
+		}
+		else break;
+	}
+	if (arg != argc - 1) {
+		printf("usage::=myl [--parser=yacc|rd] [-O0|-O1] [--unroll=N] [--stats]\n"
+			"\t[--profile-out=FILE|--profile-in=FILE] [--outbuf=N] [--load=LIB...] <infile>\n");
 		return 1;
 	}
-	stream = CreateFileStream(argv[1]);
+	stream = CreateFileStream(argv[arg]);
 
 	if (!stream) {
 		printf("Can't open file.\n");
@@ -45,6 +78,12 @@ int main(int argc, char* argv[])
 		printf("Can't create parser.\n");
 		return 3;
 	} else {
+		SelectParser(parser, frontend);
+		SetOptLevel(parser, optlevel);
+		SetUnroll(parser, unroll);
+		SetStats(parser, stats);
+		SetProfileOut(parser, profileout);
+		SetProfileIn(parser, profilein);
 		Process(parser);
 	}
 
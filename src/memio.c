@@ -0,0 +1,93 @@
+/* memio.c - utilities to read a memory buffer as a stream
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memio.h"
+
+typedef struct MemInputStream {
+	InputStream stream;
+	const unsigned char *buf;
+	int len;
+	int pos;
+	int line;
+	int col;
+} MemInputStream;
+
+static int ReadMemStream(InputStream *s)
+{
+	MemInputStream *stream = (MemInputStream *)s;
+	int ch;
+
+	if (stream->pos >= stream->len) {
+		return EOF;
+	}
+	ch = stream->buf[stream->pos++];
+
+	if (ch == '\n') {
+		stream->line++;
+		stream->col=0;
+	} else {
+		stream->col++;
+	}
+
+	return ch;
+}
+
+static int GetCurLine(const InputStream *s)
+{
+	MemInputStream *stream = (MemInputStream *)s;
+
+	return stream->line;
+}
+
+static int GetCurCol(const InputStream *s)
+{
+	MemInputStream *stream = (MemInputStream *)s;
+
+	return stream->col;
+}
+
+InputStream *CreateMemStream(const char *buf, int len)
+{
+	MemInputStream *stream = (MemInputStream *)malloc(sizeof(MemInputStream));
+	InputStream *s = (InputStream *)stream;
+
+	if (!stream) {
+		return NULL;
+	}
+
+	s->getChar = ReadMemStream;
+	s->curLine = GetCurLine;
+	s->curCol = GetCurCol;
+	stream->buf = (const unsigned char *)buf;
+	stream->len = len;
+	stream->pos = 0;
+	stream->line = 1;
+	stream->col = 0;
+
+	return (InputStream *)stream;
+}
+
+void CloseMemStream(InputStream *s)
+{
+	free(s);
+}
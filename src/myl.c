@@ -31,19 +31,64 @@ MYLParser *CreateMYLParser(InputStream *stream)
 		return NULL;
 	}
 
-	parser->elemParser = CreateElementParser(stream);
+	parser->arena = CreateArena(ARENA_BLOCKSIZE);
+	if (!parser->arena) {
+		free(parser);
+		return NULL;
+	}
+
+	parser->elemParser = CreateElementParser(stream, parser->arena);
 	if (!parser->elemParser) {
+		CloseArena(parser->arena);
 		free(parser);
 		return NULL;
 	}
 
 	parser->stream = stream;
+	parser->frontend = MYL_PARSER_YACC;
+	parser->optlevel = 1;
+	parser->unroll = 4;
+	parser->stats = 0;
+	parser->profileout = NULL;
+	parser->profilein = NULL;
+	parser->errline = parser->errcol = -1;
 	return parser;
 }
 
+void SelectParser(MYLParser *parser, int frontend)
+{
+	parser->frontend = frontend;
+}
+
+void SetOptLevel(MYLParser *parser, int level)
+{
+	parser->optlevel = level;
+}
+
+void SetUnroll(MYLParser *parser, int factor)
+{
+	parser->unroll = factor;
+}
+
+void SetStats(MYLParser *parser, int stats)
+{
+	parser->stats = stats;
+}
+
+void SetProfileOut(MYLParser *parser, const char *path)
+{
+	parser->profileout = path;
+}
+
+void SetProfileIn(MYLParser *parser, const char *path)
+{
+	parser->profilein = path;
+}
+
 void CloseMYLParser(MYLParser *parser)
 {
 	CloseElementParser(parser->elemParser);
+	CloseArena(parser->arena);
 	free(parser);
 }
 
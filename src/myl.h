@@ -33,6 +33,30 @@ typedef struct MYLParser MYLParser;
 MYLParser *CreateMYLParser(InputStream *stream);
 void CloseMYLParser(MYLParser *parser);
 
+/* Parsers, both generate the same code */
+enum {
+	MYL_PARSER_YACC,		/* gram.y, the default */
+	MYL_PARSER_RD			/* hand-written recursive descent */
+};
+void SelectParser(MYLParser *parser, int frontend);
+/* 0 keeps the code of the parser, 1 (the default) optimizes it */
+void SetOptLevel(MYLParser *parser, int level);
+/* Unroll the loops with a known trip count by factor, 1 doesn't */
+void SetUnroll(MYLParser *parser, int factor);
+/* Print the code size and the instructions executed to stderr */
+void SetStats(MYLParser *parser, int stats);
+/* Run the code of the parser and write how often each instruction ran
+ * to path, or optimize with the profile read from path. NULL doesn't. */
+void SetProfileOut(MYLParser *parser, const char *path);
+void SetProfileIn(MYLParser *parser, const char *path);
+
+/* Add the builtins of the extension at path to those of every parser,
+ * see mylext.h. Returns 0 and prints why if it can't be loaded. */
+int LoadExtension(const char *path);
+
+/* Compile the whole stream into VMCode, return the code size */
+int Compile(MYLParser *parser);
+/* Compile, dump the code to out.asm and run it */
 void Process(MYLParser *parser);
 
 #ifdef __cplusplus
@@ -24,14 +24,27 @@
 
 #include "myl.h"
 #include "element.h"
+#include "arena.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define ARENA_BLOCKSIZE 65536
+
 struct MYLParser {
 	InputStream *stream;
 	ElementParser *elemParser;
+	Arena *arena;			/* compiler data, freed with the parser */
+	int frontend;			/* MYL_PARSER_YACC or MYL_PARSER_RD */
+	int optlevel;
+	int unroll;				/* loop unrolling factor */
+	int stats;
+	const char *profileout;	/* profile written by Process */
+	const char *profilein;	/* profile the code is optimized with */
+	int parsedsize;			/* code size before the optimization */
+	int errline, errcol;	/* where a compile error is reported, -1 for
+							 * where the stream is */
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,68 @@
+/* mylext.h - Interface of the native extensions that add builtins
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* An extension is a shared library exporting MYLEXT_INIT, which is called
+ * once when the library is loaded and registers each of its builtins with
+ * reg. A builtin is called with its params read from their places, and
+ * sets ret to a value of the type it was registered with. It returns 0,
+ * or a message that stops the program as a VM error. What it writes to
+ * stdout may come before what print wrote, which is buffered. */
+
+#ifndef __MYLEXT_H
+#define __MYLEXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The types of the params and values, the same as T_INTEGER... of the VM */
+enum {
+	MYLEXT_NULL, MYLEXT_INTEGER, MYLEXT_FLOAT, MYLEXT_STRING
+};
+
+typedef struct MYLExtValue {
+	int type;
+	union {
+		int i;
+		float f;
+		const char *s;		/* a param is valid during the call, a value
+							 * is copied after it */
+	} u;
+} MYLExtValue;
+
+typedef const char *(*MYLExtFunc)(const MYLExtValue *params, int paramcnt,
+	MYLExtValue *ret);
+
+/* paramcnt is -1 for any number of params, up to MYLEXT_MAXPARAMS, and
+ * rettype MYLEXT_NULL for none. Returns 0 if the name is taken or there
+ * is no room for it. */
+typedef int (*MYLExtRegister)(const char *name, int paramcnt, int rettype,
+	MYLExtFunc func);
+
+#define MYLEXT_MAXPARAMS 64
+#define MYLEXT_INIT "myl_ext_init"
+/* Returns 0 if the extension can't be used */
+typedef int (*MYLExtInit)(MYLExtRegister reg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
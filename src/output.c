@@ -0,0 +1,191 @@
+/* output.c - Buffered output of print and the formatting of numbers
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The numbers are formatted straight into the buffer. An integer takes
+ * two digits at a time from a table. A float is m*2^e with a mantissa of
+ * 24 bits, so its value times 10^6 fits 64 bits as an integer and is
+ * rounded to the nearest, half to even, the way printf rounds the exact
+ * value: the result is the same as "%f" to the last digit. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "output.h"
+
+static char DefaultBuf[OUTPUTSIZE];
+static char *Buf = DefaultBuf;
+static int Size = OUTPUTSIZE;
+static int Len;
+static int EachLine;		/* size 0 */
+static int Registered;
+
+static const char Digits[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/* Through stdio to the file, as stdout is fully buffered to a pipe */
+void FlushOutput()
+{
+	if (Len) fwrite(Buf, 1, Len, stdout);
+	Len = 0;
+	fflush(stdout);
+}
+
+/* Room for len more bytes, the buffer is at least 64 long */
+static char *Reserve(int len)
+{
+	if (!Registered) {
+		/* exit() from anywhere in the VM still writes what is left */
+		atexit(FlushOutput);
+		Registered = 1;
+	}
+	if (Len + len > Size) FlushOutput();
+	return Buf + Len;
+}
+
+void SetOutputSize(int size)
+{
+	char *buf;
+
+	FlushOutput();
+	EachLine = size <= 0;
+	if (size < 64) size = 64;
+	if (size == Size) return;
+	if (!(buf = (char *)malloc(size))) return;
+	if (Buf != DefaultBuf) free(Buf);
+	Buf = buf;
+	Size = size;
+}
+
+void OutputString(const char *str, int len)
+{
+	if (len > Size) {
+		FlushOutput();
+		fwrite(str, 1, len, stdout);
+		return;
+	}
+	memcpy(Reserve(len), str, len);
+	Len += len;
+}
+
+/* The digits of num end at end, returns where they start */
+static char *FormatUnsigned(char *end, unsigned long long num)
+{
+	while (num >= 100) {
+		int pair = (int)(num % 100) * 2;
+		num /= 100;
+		*--end = Digits[pair + 1];
+		*--end = Digits[pair];
+	}
+	if (num >= 10) {
+		*--end = Digits[num * 2 + 1];
+		*--end = Digits[num * 2];
+	}
+	else *--end = (char)('0' + num);
+	return end;
+}
+
+/* The text of num ends at end, returns where it starts */
+static char *FormatInt(char *end, int num)
+{
+	char *p = FormatUnsigned(end, num < 0 ? 0U - (unsigned)num : (unsigned)num);
+
+	if (num < 0) *--p = '-';
+	return p;
+}
+
+static char *FormatFloat(char *end, float num)
+{
+	union { float f; unsigned u; } v;
+	unsigned long long m, whole, scaled, rem, half;
+	int exp, k, frac, i;
+	char *p;
+
+	v.f = num;
+	exp = (v.u >> 23) & 0xFF;
+	m = v.u & 0x7FFFFF;
+	if (exp == 0xFF || exp - 150 > 39) {
+		/* inf, nan, and numbers too large for 64 bits */
+		char tmp[NUMBERSIZE];
+		int len = snprintf(tmp, sizeof(tmp), "%f", num);
+		return (char *)memcpy(end - len, tmp, len);
+	}
+	if (exp) m |= 0x800000;
+	else exp = 1;
+	exp -= 150;			/* num is m*2^exp */
+	if (exp >= 0) {
+		whole = m << exp;
+		frac = 0;
+	}
+	else {
+		k = -exp;
+		scaled = m * 1000000;
+		if (k >= 64) scaled = 0;
+		else {
+			rem = scaled & ((1ULL << k) - 1);
+			half = 1ULL << (k - 1);
+			scaled >>= k;
+			if (rem > half || (rem == half && (scaled & 1))) scaled++;
+		}
+		whole = scaled / 1000000;
+		frac = (int)(scaled % 1000000);
+	}
+	p = end;
+	for (i = 0; i < 6; i += 2, frac /= 100) {
+		*--p = Digits[frac % 100 * 2 + 1];
+		*--p = Digits[frac % 100 * 2];
+	}
+	*--p = '.';
+	p = FormatUnsigned(p, whole);
+	if (v.u >> 31) *--p = '-';
+	return p;
+}
+
+int FormatNumber(char *buf, int isfloat, int inum, float fnum)
+{
+	char tmp[NUMBERSIZE], *end = tmp + sizeof(tmp);
+	char *p = isfloat ? FormatFloat(end, fnum) : FormatInt(end, inum);
+
+	memcpy(buf, p, end - p);
+	return (int)(end - p);
+}
+
+void OutputInt(int num)
+{
+	char tmp[NUMBERSIZE], *end = tmp + sizeof(tmp), *p = FormatInt(end, num);
+
+	OutputString(p, (int)(end - p));
+}
+
+void OutputFloat(float num)
+{
+	char tmp[NUMBERSIZE], *end = tmp + sizeof(tmp), *p = FormatFloat(end, num);
+
+	OutputString(p, (int)(end - p));
+}
+
+void OutputLine()
+{
+	*Reserve(1) = '\n';
+	Len++;
+	if (EachLine) FlushOutput();
+}
@@ -0,0 +1,49 @@
+/* output.h - The buffer print writes to
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __OUTPUT_H
+#define __OUTPUT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* print formats into one buffer of the VM, which goes to stdout when it
+ * is full, when a run ends, before dos and before an error is printed.
+ * A size of 0 writes each line when it ends. */
+#define OUTPUTSIZE 65536
+#define NUMBERSIZE 64		/* the longest number formatted */
+
+void SetOutputSize(int size);
+void OutputString(const char *str, int len);
+void OutputInt(int num);
+/* The same as printf("%f") */
+void OutputFloat(float num);
+void OutputLine();
+void FlushOutput();
+
+/* Format a number into buf the same way, returns its length */
+int FormatNumber(char *buf, int isfloat, int inum, float fnum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/* profile.cpp - Read and write the execution counts of a run
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The file is text: a header with the size and a hash of the code it was
+ * taken of, then the address, count and taken jumps of each instruction
+ * that ran. A profile of other code, such as an older version of the
+ * program, is refused. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "profile.h"
+
+#define MAGIC "myl-profile"
+
+/* FNV-1a over the fields of the instructions */
+static unsigned HashCode(const Instruction *code, int size)
+{
+	unsigned hash = 2166136261u;
+	int i, k;
+
+	for (i = 0; i < size; i++) {
+		unsigned fields[4] = {(unsigned)code[i].op, (unsigned)code[i].dest,
+			(unsigned)code[i].src1.i, (unsigned)code[i].src2.i};
+		for (k = 0; k < 4; k++) {
+			hash ^= fields[k];
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+Profile *CreateProfile(const Instruction *code, int size)
+{
+	Profile *profile = (Profile *)malloc(sizeof(Profile));
+
+	if (!profile) return NULL;
+	/* A run may stray past the code */
+	profile->count = (long *)calloc(CODESIZE, sizeof(long));
+	profile->taken = (long *)calloc(CODESIZE, sizeof(long));
+	profile->size = size;
+	profile->hash = HashCode(code, size);
+	if (!profile->count || !profile->taken) {
+		CloseProfile(profile);
+		return NULL;
+	}
+	return profile;
+}
+
+void CloseProfile(Profile *profile)
+{
+	if (!profile) return;
+	free(profile->count);
+	free(profile->taken);
+	free(profile);
+}
+
+Profile *ReadProfile(const char *path, const Instruction *code, int size)
+{
+	FILE *fp = fopen(path, "r");
+	Profile *profile;
+	unsigned hash;
+	long count, taken;
+	int n, addr;
+
+	if (!fp) {
+		fprintf(stderr, "Can't open profile %s.\n", path);
+		return NULL;
+	}
+	if (!(profile = CreateProfile(code, size))) {
+		fclose(fp);
+		return NULL;
+	}
+	if (fscanf(fp, MAGIC " %d %x", &n, &hash) != 2
+		|| n != size || hash != profile->hash) {
+		fprintf(stderr, "Profile %s is of other code, ignored.\n", path);
+		CloseProfile(profile);
+		fclose(fp);
+		return NULL;
+	}
+	while (fscanf(fp, "%d %ld %ld", &addr, &count, &taken) == 3) {
+		if (addr < 0 || addr >= size) continue;
+		profile->count[addr] = count;
+		profile->taken[addr] = taken;
+	}
+	fclose(fp);
+	return profile;
+}
+
+int WriteProfile(const Profile *profile, const char *path)
+{
+	FILE *fp = fopen(path, "w");
+	int addr;
+
+	if (!fp) {
+		fprintf(stderr, "Can't write profile %s.\n", path);
+		return 0;
+	}
+	fprintf(fp, MAGIC " %d %x\n", profile->size, profile->hash);
+	for (addr = 0; addr < profile->size; addr++) {
+		if (profile->count[addr])
+			fprintf(fp, "%d %ld %ld\n", addr, profile->count[addr], profile->taken[addr]);
+	}
+	return fclose(fp) == 0;
+}
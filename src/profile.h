@@ -0,0 +1,44 @@
+/* profile.h - Execution counts of the code from a run, to optimize with
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include "vmachine.h"
+
+/* A profile is taken of the code of the parser, before it is optimized,
+ * so that it is found again by address when the same program is
+ * compiled with it. */
+typedef struct Profile {
+	long *count;		/* times each instruction ran */
+	long *taken;		/* times each jump went to its dest */
+	int size;
+	unsigned hash;		/* of the code, taken before it ran */
+} Profile;
+
+Profile *CreateProfile(const Instruction *code, int size);
+void CloseProfile(Profile *profile);
+
+/* NULL if the file can't be read or was written for other code */
+Profile *ReadProfile(const char *path, const Instruction *code, int size);
+/* 0 if the file can't be written */
+int WriteProfile(const Profile *profile, const char *path);
+
+#endif
@@ -0,0 +1,616 @@
+/* rdparse.cpp - Recursive descent parser
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The same language as gram.y without the LALR tables. Statements are
+ * parsed top down, binary operators by precedence climbing over the
+ * levels of gram.y:
+ *
+ *	1	|| &&
+ *	2	== != < <= > >=
+ *	3	| & ^
+ *	4	<< >>
+ *	5	+ -
+ *	6	* / %
+ *
+ * All of them are left associative. A unary operator applies to a factor
+ * and only starts a term, so the right operand of * / % is a factor.
+ * An identifier is told apart by the token after it: '=' starts an
+ * assignment, ':' a label, '(' a call and '++' or '--' a postfix
+ * operation. The code generators are called where gram.y reduces the
+ * matching rule, which keeps the generated code the same. gram.y reduces
+ * a call, a declaration or a param right after lexing its last token,
+ * where this parser has read one more, so the errors of those are
+ * reported where the stream was after their last token. */
+
+#include "myl_internal.h"
+#include "element.h"
+#include "vmachine.h"
+#include "codegen.h"
+
+typedef struct RDParser {
+	MYLParser *parser;
+	int token;				/* current token */
+	Element elem;
+	int line, col;			/* of the stream after the current token */
+	int lastline, lastcol;	/* and after the one before */
+	int needed;				/* the current token ended what was parsed */
+	int ahead;				/* the token after it, -1 if not read yet */
+	Element aheadelem;
+	int aheadline, aheadcol;
+} RDParser;
+
+static void ParseStatement(RDParser *rd, Intval *res);
+static void ParseExpression(RDParser *rd, Expval *res);
+
+static void Advance(RDParser *rd)
+{
+	InputStream *stream=rd->parser->stream;
+
+	rd->lastline=rd->line;
+	rd->lastcol=rd->col;
+	rd->needed=0;
+	if (rd->ahead!=-1) {
+		rd->token=rd->ahead;
+		rd->elem=rd->aheadelem;
+		rd->line=rd->aheadline;
+		rd->col=rd->aheadcol;
+		rd->ahead=-1;
+	}
+	else {
+		rd->token=NextToken(rd->parser, &rd->elem);
+		rd->line=stream->curLine(stream);
+		rd->col=stream->curCol(stream);
+	}
+}
+
+static int Peek(RDParser *rd)
+{
+	InputStream *stream=rd->parser->stream;
+
+	if (rd->ahead==-1) {
+		rd->ahead=NextToken(rd->parser, &rd->aheadelem);
+		rd->aheadline=stream->curLine(stream);
+		rd->aheadcol=stream->curCol(stream);
+	}
+	return rd->ahead;
+}
+
+/* The errors until ReportHere are reported after the current token */
+static void ReportAfter(RDParser *rd)
+{
+	rd->parser->errline=rd->line;
+	rd->parser->errcol=rd->col;
+}
+
+/* Or after the last token of what was parsed, which is the one before
+ * unless it was needed to see the end, as for an if without else */
+static void ReportAfterLast(RDParser *rd)
+{
+	if (rd->needed) ReportAfter(rd);
+	else {
+		rd->parser->errline=rd->lastline;
+		rd->parser->errcol=rd->lastcol;
+	}
+}
+
+static void ReportHere(RDParser *rd)
+{
+	rd->parser->errline=rd->parser->errcol=-1;
+}
+
+static void SyntaxError(RDParser *rd)
+{
+	CompileError(rd->parser, "syntax error");
+}
+
+static void Expect(RDParser *rd, int token)
+{
+	if (rd->token!=token) SyntaxError(rd);
+	Advance(rd);
+}
+
+/* The last token of what gram.y reduces, whose errors are reported after
+ * it until ReportHere */
+static void ExpectLast(RDParser *rd, int token)
+{
+	if (rd->token!=token) SyntaxError(rd);
+	ReportAfter(rd);
+	Advance(rd);
+}
+
+/* Statements up to '}' or the end of the stream */
+static void ParseStatements(RDParser *rd, Intval *res, int end)
+{
+	Intval stmt, list;
+
+	ParseStatement(rd, res);
+	while (rd->token!=end) {
+		ParseStatement(rd, &stmt);
+		list=*res;
+		JoinStatements(res, &list, &stmt);
+	}
+}
+
+static void ParseCondition(RDParser *rd, Expval *res)
+{
+	Expect(rd, TK_LPARA);
+	ParseExpression(rd, res);
+	Expect(rd, TK_RPARA);
+}
+
+static void ParseIf(RDParser *rd, Intval *res)
+{
+	Expval cond;
+	Intval pre, body, elsepre;
+
+	ParseCondition(rd, &cond);
+	BeginIf(rd->parser, &pre, &cond);
+	ParseStatement(rd, &body);
+	if (rd->token==TK_KEYELSE) {
+		Advance(rd);
+		BeginElse(&elsepre, &pre, &body);
+		ParseStatement(rd, &body);
+		EndIf(res, &elsepre, &body);
+	}
+	else {
+		rd->needed=1;
+		EndIf(res, &pre, &body);
+	}
+}
+
+static void ParseWhile(RDParser *rd, Intval *res)
+{
+	Expval cond;
+	Intval pre, body;
+
+	ParseCondition(rd, &cond);
+	BeginWhile(rd->parser, &pre, &cond);
+	ParseStatement(rd, &body);
+	EndWhile(res, &pre, &body);
+}
+
+static void ParseFor(RDParser *rd, Intval *res)
+{
+	Expval exp, cond;
+	Intval init, act, body;
+
+	Expect(rd, TK_LPARA);
+	ParseExpression(rd, &exp);
+	Expect(rd, TK_SEMICOLON);
+	ForInit(&init, &exp);
+	ParseExpression(rd, &exp);
+	Expect(rd, TK_SEMICOLON);
+	ForCondition(rd->parser, &cond, &exp);
+	ParseExpression(rd, &exp);
+	Expect(rd, TK_RPARA);
+	ForAction(rd->parser, &act, &exp);
+	ParseStatement(rd, &body);
+	EndFor(rd->parser, res, &init, &cond, &act, &body);
+}
+
+static void ParseDo(RDParser *rd, Intval *res)
+{
+	Expval cond;
+	Intval body;
+
+	BeginDo(rd->parser);
+	ParseStatement(rd, &body);
+	Expect(rd, TK_KEYWHILE);
+	ParseCondition(rd, &cond);
+	Expect(rd, TK_SEMICOLON);
+	EndDoWhile(rd->parser, res, &body, &cond);
+}
+
+static void ParseSwitch(RDParser *rd, Intval *res)
+{
+	Expval exp, pre;
+	Intval body;
+
+	ParseCondition(rd, &exp);
+	BeginSwitch(rd->parser, &pre, &exp);
+	ParseStatement(rd, &body);
+	EndSwitch(rd->parser, res, &pre, &body);
+}
+
+/* The name of a function is followed by its params in parentheses */
+static void ParseFunction(RDParser *rd, Intval *res, int type, int name)
+{
+	Expval pre;
+	Intval funcpre, body;
+	int ptype;
+
+	pre.type=type;
+	BeginFunction(rd->parser, &funcpre, &pre, name);
+	Advance(rd);
+	while (rd->token!=TK_RPARA) {
+		if (rd->token!=TK_KEYTYPE) SyntaxError(rd);
+		ptype=rd->elem.id-FIRSTTYPE+1;
+		Advance(rd);
+		if (rd->token!=TK_IDENT) SyntaxError(rd);
+		ReportAfter(rd);
+		DeclareParam(rd->parser, ptype, rd->elem.id);
+		ReportHere(rd);
+		Advance(rd);
+		if (rd->token!=TK_COMMA) break;
+		Advance(rd);
+		if (rd->token!=TK_KEYTYPE) SyntaxError(rd);
+	}
+	Expect(rd, TK_RPARA);
+	ParseStatement(rd, &body);
+	ReportAfterLast(rd);
+	EndFunction(rd->parser, res, &funcpre, &body);
+	ReportHere(rd);
+}
+
+static void ParseDeclaration(RDParser *rd, Intval *res)
+{
+	int type=rd->elem.id-FIRSTTYPE+1, name;
+
+	Advance(rd);
+	for (;;) {
+		if (rd->token!=TK_IDENT) SyntaxError(rd);
+		name=rd->elem.id;
+		Advance(rd);
+		if (rd->token==TK_LPARA) {
+			ParseFunction(rd, res, type, name);
+			return;
+		}
+		if (rd->token!=TK_COMMA) break;
+		ReportAfter(rd);
+		Advance(rd);
+		DeclareVar(rd->parser, name, type);
+		ReportHere(rd);
+	}
+	ExpectLast(rd, TK_SEMICOLON);
+	EmptyStatement(res);
+	DeclareVar(rd->parser, name, type);
+	ReportHere(rd);
+}
+
+static void ParseCase(RDParser *rd)
+{
+	int type;
+
+	switch (rd->token) {
+	case TK_CNTINT:
+		type=T_INTEGER;
+		break;
+	case TK_FLT:
+		type=T_FLOAT;
+		break;
+	case TK_STR:
+		type=T_STRING;
+		break;
+	default:
+		SyntaxError(rd);
+		return;
+	}
+	Peek(rd);
+	if (rd->ahead!=TK_COLON) SyntaxError(rd);
+	DefineCase(rd->parser, type, rd->elem.id);
+	Advance(rd);
+	Advance(rd);
+}
+
+static void ParseStatement(RDParser *rd, Intval *res)
+{
+	Expval exp;
+	int name;
+
+	switch (rd->token) {
+	case TK_KEYIF:
+		Advance(rd);
+		ParseIf(rd, res);
+		break;
+	case TK_KEYWHILE:
+		Advance(rd);
+		ParseWhile(rd, res);
+		break;
+	case TK_KEYFOR:
+		Advance(rd);
+		ParseFor(rd, res);
+		break;
+	case TK_KEYDO:
+		Advance(rd);
+		ParseDo(rd, res);
+		break;
+	case TK_KEYSWITCH:
+		Advance(rd);
+		ParseSwitch(rd, res);
+		break;
+	case TK_KEYCONT:
+		Advance(rd);
+		ExpectLast(rd, TK_SEMICOLON);
+		ContinueStatement(rd->parser, res);
+		ReportHere(rd);
+		break;
+	case TK_KEYBREAK:
+		Advance(rd);
+		ExpectLast(rd, TK_SEMICOLON);
+		BreakStatement(rd->parser, res);
+		ReportHere(rd);
+		break;
+	case TK_KEYGOTO:
+		Advance(rd);
+		if (rd->token!=TK_IDENT) SyntaxError(rd);
+		name=rd->elem.id;
+		Advance(rd);
+		Expect(rd, TK_SEMICOLON);
+		GotoStatement(rd->parser, res, name);
+		break;
+	case TK_KEYRETURN:
+		Advance(rd);
+		ParseExpression(rd, &exp);
+		ExpectLast(rd, TK_SEMICOLON);
+		ReturnStatement(rd->parser, res, &exp);
+		ReportHere(rd);
+		break;
+	case TK_LBRACKET:
+		Advance(rd);
+		if (rd->token==TK_RBRACKET) EmptyStatement(res);
+		else ParseStatements(rd, res, TK_RBRACKET);
+		Expect(rd, TK_RBRACKET);
+		break;
+	case TK_SEMICOLON:
+		Advance(rd);
+		EmptyStatement(res);
+		break;
+	case TK_KEYTYPE:
+		ParseDeclaration(rd, res);
+		break;
+	case TK_KEYCASE:
+		Advance(rd);
+		ParseCase(rd);
+		ParseStatement(rd, res);
+		break;
+	case TK_KEYDEFAULT:
+		Advance(rd);
+		ExpectLast(rd, TK_COLON);
+		DefineDefault(rd->parser);
+		ReportHere(rd);
+		ParseStatement(rd, res);
+		break;
+	case TK_IDENT:
+		if (Peek(rd)==TK_COLON) {
+			DefineLabel(rd->parser, rd->elem.id);
+			Advance(rd);
+			Advance(rd);
+			ParseStatement(rd, res);
+			break;
+		}
+		/* fall through */
+	default:
+		ParseExpression(rd, &exp);
+		Expect(rd, TK_SEMICOLON);
+		ExprStatement(res, &exp);
+		break;
+	}
+}
+
+static void ParseCall(RDParser *rd, Expval *res)
+{
+	int name=rd->elem.id;
+	Paraval params, list;
+	Expval exp;
+
+	Advance(rd);
+	Advance(rd);
+	if (rd->token==TK_RPARA) NoParameter(&params);
+	else {
+		ParseExpression(rd, &exp);
+		PushParameter(&params, NULL, &exp);
+		while (rd->token==TK_COMMA) {
+			Advance(rd);
+			ParseExpression(rd, &exp);
+			list=params;
+			PushParameter(&params, &list, &exp);
+		}
+	}
+	ExpectLast(rd, TK_RPARA);
+	CallFunction(rd->parser, res, name, &params);
+	ReportHere(rd);
+}
+
+static void ParseFactor(RDParser *rd, Expval *res)
+{
+	Varval lres;
+	int op;
+
+	switch (rd->token) {
+	case TK_CNTINT:
+		IntConstant(rd->parser, res, rd->elem.id);
+		Advance(rd);
+		break;
+	case TK_FLT:
+		FloatConstant(rd->parser, res, rd->elem.id);
+		Advance(rd);
+		break;
+	case TK_STR:
+		StringConstant(rd->parser, res, rd->elem.id);
+		Advance(rd);
+		break;
+	case TK_INCOPS:
+	case TK_DECOPS:
+		op=rd->elem.id;
+		Advance(rd);
+		if (rd->token!=TK_IDENT) SyntaxError(rd);
+		LValue(rd->parser, &lres, rd->elem.id);
+		Advance(rd);
+		PreIncDec(rd->parser, res, op, &lres);
+		break;
+	case TK_IDENT:
+		switch (Peek(rd)) {
+		case TK_LPARA:
+			ParseCall(rd, res);
+			break;
+		case TK_INCOPS:
+		case TK_DECOPS:
+			LValue(rd->parser, &lres, rd->elem.id);
+			Advance(rd);
+			op=rd->elem.id;
+			Advance(rd);
+			PostIncDec(rd->parser, res, &lres, op);
+			break;
+		default:
+			VarFactor(rd->parser, res, rd->elem.id);
+			Advance(rd);
+			break;
+		}
+		break;
+	case TK_LPARA:
+		Advance(rd);
+		ParseExpression(rd, res);
+		Expect(rd, TK_RPARA);
+		break;
+	default:
+		SyntaxError(rd);
+	}
+}
+
+static void ParseUnary(RDParser *rd, Expval *res)
+{
+	Expval exp;
+	int op=rd->elem.id;
+
+	switch (rd->token) {
+	case TK_ADDOPS:
+		Advance(rd);
+		ParseFactor(rd, &exp);
+		Negate(rd->parser, res, op, &exp);
+		break;
+	case TK_BOOLNOT:
+		Advance(rd);
+		ParseFactor(rd, &exp);
+		LogicalNot(rd->parser, res, &exp);
+		break;
+	case TK_BITNOT:
+		Advance(rd);
+		ParseFactor(rd, &exp);
+		BitwiseNot(rd->parser, res, op, &exp);
+		break;
+	default:
+		ParseFactor(rd, res);
+	}
+}
+
+static int Precedence(int token)
+{
+	switch (token) {
+	case TK_BOOLOR:
+	case TK_BOOLAND:
+		return 1;
+	case TK_BOOLOPS:
+		return 2;
+	case TK_BITOPS:
+		return 3;
+	case TK_SHIFTOPS:
+		return 4;
+	case TK_ADDOPS:
+		return 5;
+	case TK_MULOPS:
+		return 6;
+	}
+	return 0;
+}
+
+static void ParseBinary(RDParser *rd, Expval *res, int level)
+{
+	Expval left, pre, right;
+	int token, op, prec;
+
+	ParseUnary(rd, &left);
+	while ((prec=Precedence(rd->token))>=level) {
+		token=rd->token;
+		op=rd->elem.id;
+		Advance(rd);
+		if (token==TK_BOOLOR || token==TK_BOOLAND)
+			BoolOperand(rd->parser, &pre, &left);
+		else if (token==TK_BITOPS || token==TK_SHIFTOPS)
+			IntOperand(rd->parser, &pre, &left, op);
+		else Operand(&pre, &left, op);
+
+		if (token==TK_MULOPS) ParseFactor(rd, &right);
+		else ParseBinary(rd, &right, prec+1);
+
+		switch (token) {
+		case TK_BOOLOR:
+			EndBoolOr(rd->parser, &left, &pre, &right);
+			break;
+		case TK_BOOLAND:
+			EndBoolAnd(rd->parser, &left, &pre, &right);
+			break;
+		case TK_BOOLOPS:
+			EndCompare(rd->parser, &left, &pre, &right);
+			break;
+		case TK_BITOPS:
+		case TK_SHIFTOPS:
+			EndIntOp(rd->parser, &left, &pre, &right);
+			break;
+		default:
+			EndArith(rd->parser, &left, &pre, &right);
+		}
+	}
+	*res=left;
+}
+
+static void ParseExpression(RDParser *rd, Expval *res)
+{
+	Expval cond, sel, mid, colon, exp;
+	Varval lres;
+	int op;
+
+	if (rd->token==TK_IDENT && Peek(rd)==TK_SETOPS) {
+		LValue(rd->parser, &lres, rd->elem.id);
+		Advance(rd);
+		op=rd->elem.id;
+		Advance(rd);
+		ParseExpression(rd, &exp);
+		Assign(rd->parser, res, &lres, op, &exp);
+		return;
+	}
+	ParseBinary(rd, &cond, 1);
+	if (rd->token!=TK_SELECT) {
+		*res=cond;
+		return;
+	}
+	/* The branches are full expressions, so ?: is right associative */
+	Advance(rd);
+	BeginSelect(rd->parser, &sel, &cond);
+	ParseExpression(rd, &mid);
+	Expect(rd, TK_COLON);
+	SelectColon(&colon, &mid);
+	ParseExpression(rd, &exp);
+	EndSelect(rd->parser, res, &sel, &colon, &exp);
+}
+
+int RDParse(MYLParser *parser)
+{
+	RDParser rd;
+	Intval myl;
+
+	rd.parser=parser;
+	rd.line=rd.col=0;
+	rd.needed=0;
+	rd.ahead=-1;
+	Advance(&rd);
+	ParseStatements(&rd, &myl, TK_EOF);
+	EndUnit(parser, &myl);
+	return 0;
+}
@@ -24,16 +24,17 @@
 
 #include "stackitem.h"
 
-void Push(StackItem **s, int data)
+void Push(Arena *arena, StackItem **s, int data)
 {
-	StackItem *p = (StackItem *)malloc(sizeof(StackItem));
+	StackItem *p = (*s)->next;
+
+	/* Items popped earlier are kept linked behind the top and reused */
 	if (!p) {
-		fprintf(stderr, "Out of memory\n");
-		exit(4);
+		p = (StackItem *)ArenaAlloc(arena, sizeof(StackItem));
+		p->next = 0;
 	}
 
 	p->data = data;
-	p->next = 0;
 	p->prev = (*s);
 	(*s)->next = p;
 	(*s) = p;
@@ -51,9 +52,7 @@ int Pop(StackItem **s)
 		exit(4);
 	}
 	
-	(*s)->next = 0;
 	temp = p->data;
-	free(p);
 	return temp;
 }
 
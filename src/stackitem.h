@@ -22,6 +22,8 @@
 #ifndef __STACKITEM_H
 #define __STACKITEM_H
 
+#include "arena.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,7 +36,7 @@ typedef struct StackItem {
 
 #define IsStackEmpty(s) (!((s)->prev))
 
-void Push(StackItem **s, int data);
+void Push(Arena *arena, StackItem **s, int data);
 int Pop(StackItem **s);
 
 #ifdef __cplusplus
@@ -0,0 +1,175 @@
+/* strops.c - Scans over the bytes of the strings of the builtins
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The substrings are found by memchr and memmem of the C library, which
+ * compare 16 or 32 bytes at a time. Counting a single byte, skipping the
+ * fields split at one, replacing one by another and changing the case
+ * take 16 bytes at a time with SSE2 where it is there. */
+
+#define _GNU_SOURCE
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "strops.h"
+
+long StrFind(const char *s, size_t n, const char *sub, size_t m, size_t from)
+{
+	const char *p;
+
+	if (from > n || m > n - from) return -1;
+	if (m == 0) return (long)from;
+	if (m == 1) p = (const char *)memchr(s + from, sub[0], n - from);
+	else p = (const char *)memmem(s + from, n - from, sub, m);
+	return p ? (long)(p - s) : -1;
+}
+
+static size_t CountByte(const char *s, size_t n, char c)
+{
+	size_t count = 0, i = 0;
+
+#ifdef __SSE2__
+	const __m128i key = _mm_set1_epi8(c);
+
+	while (i + 16 <= n) {
+		/* Each byte of sums counts up to 255 matches of its lane */
+		__m128i sums = _mm_setzero_si128();
+		size_t end = i + 255 * 16 < n ? i + 255 * 16 : n;
+
+		for (; i + 16 <= end; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+			sums = _mm_sub_epi8(sums, _mm_cmpeq_epi8(v, key));
+		}
+		sums = _mm_sad_epu8(sums, _mm_setzero_si128());
+		count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+	}
+#endif
+	for (; i < n; i++) count += s[i] == c;
+	return count;
+}
+
+/* Past the k-th c in s, NULL if there are fewer */
+static const char *SkipBytes(const char *s, size_t n, char c, long k)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i key = _mm_set1_epi8(c);
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+		unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, key));
+
+		for (; mask; mask &= mask - 1) {
+			if (--k == 0) return s + i + __builtin_ctz(mask) + 1;
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		if (s[i] == c && --k == 0) return s + i + 1;
+	}
+	return NULL;
+}
+
+size_t StrCount(const char *s, size_t n, const char *sub, size_t m)
+{
+	size_t count = 0;
+	long at = 0;
+
+	if (m == 0) return 0;
+	if (m == 1) return CountByte(s, n, sub[0]);
+	while ((at = StrFind(s, n, sub, m, at)) >= 0) {
+		count++;
+		at += m;
+	}
+	return count;
+}
+
+const char *StrField(const char *s, size_t n, const char *sep, size_t m,
+	long k, size_t *len)
+{
+	long start = 0, end;
+
+	if (m == 0 || k < 0) return NULL;
+	if (m == 1 && k > 0) {
+		const char *p = SkipBytes(s, n, sep[0], k);
+		if (!p) return NULL;
+		start = p - s;
+	}
+	for (; m > 1 && k > 0; k--) {
+		if ((start = StrFind(s, n, sep, m, start)) < 0) return NULL;
+		start += m;
+	}
+	if ((end = StrFind(s, n, sep, m, start)) < 0) end = (long)n;
+	*len = end - start;
+	return s + start;
+}
+
+void StrReplaceByte(char *dest, const char *src, size_t n, char from, char to)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i key = _mm_set1_epi8(from), with = _mm_set1_epi8(to);
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i hit = _mm_cmpeq_epi8(v, key);
+		v = _mm_or_si128(_mm_andnot_si128(hit, v), _mm_and_si128(hit, with));
+		_mm_storeu_si128((__m128i *)(dest + i), v);
+	}
+#endif
+	for (; i < n; i++) dest[i] = src[i] == from ? to : src[i];
+}
+
+/* Flip the case of the bytes from first to first+25 */
+static void MapCase(char *dest, const char *src, size_t n, char first)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	/* first..first+25 move to -128..-103, the signed bytes below -102 */
+	const __m128i shift = _mm_set1_epi8((char)(-128 - first));
+	const __m128i limit = _mm_set1_epi8(-128 + 26);
+	const __m128i flip = _mm_set1_epi8(0x20);
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i in = _mm_cmplt_epi8(_mm_add_epi8(v, shift), limit);
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_xor_si128(v, _mm_and_si128(in, flip)));
+	}
+#endif
+	for (; i < n; i++) {
+		char c = src[i];
+		dest[i] = (unsigned char)(c - first) < 26 ? c ^ 0x20 : c;
+	}
+}
+
+void StrUpper(char *dest, const char *src, size_t n)
+{
+	MapCase(dest, src, n, 'a');
+}
+
+void StrLower(char *dest, const char *src, size_t n)
+{
+	MapCase(dest, src, n, 'A');
+}
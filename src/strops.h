@@ -0,0 +1,48 @@
+/* strops.h - Scans over the bytes of the strings of the builtins
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STROPS_H
+#define __STROPS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Where sub is found in s from from on, -1 if it isn't. An empty sub
+ * is found at from. */
+long StrFind(const char *s, size_t n, const char *sub, size_t m, size_t from);
+/* The times sub is found in s without overlapping, 0 for an empty sub */
+size_t StrCount(const char *s, size_t n, const char *sub, size_t m);
+/* Field k of s split at each sep, from 0. NULL if s has k fields or
+ * fewer, or sep is empty. */
+const char *StrField(const char *s, size_t n, const char *sep, size_t m,
+	long k, size_t *len);
+/* dest may be src */
+void StrReplaceByte(char *dest, const char *src, size_t n, char from, char to);
+void StrUpper(char *dest, const char *src, size_t n);
+void StrLower(char *dest, const char *src, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,8 +20,10 @@
  */
 
 #include "vmachine.h"
+#include "output.h"
 
 int SP, IP;
+int HeapTop=HEAPSTART;
 Instruction VMCode[CODESIZE];
 MemUnit VMStack[STACKSIZE];
 
@@ -32,11 +34,33 @@ static const char *opname[]={
 	"NOTEQU", "EQU", "LESS", "LE", "GREAT",	"GE",
 	"PUSH","POP", "JMP", "CALL","RET",
 	"JE",  "JG",  "JL", "SHL", "SHR", "NOT", "INC", "DEC",
-	"JNE", "CNV",
+	"JNE", "CNV", "JLE", "JGE", "FORPREP", "FORLOOP", "CMOV",
+	"JTAB", "JBIN", "JHASH",
+	"SQRTF", "FABSF", "FLOORF", "CEILF", "SINF", "COSF", "EXPF", "POWF", "ARG",
+	"CALLU", "RETU", "PARAM", "ENTER",
 	};
 
+/* A CALLU makes a frame on the stack, from SP down:
+ *
+ *	BP+k	param k, which PARAM k reads
+ *	BP-1	the address to return to
+ *	BP-2	the slot the value goes to
+ *	BP-3	BP of the caller
+ *	BP-4	the ENTER of the function
+ *	BP-5	the count of the params
+ *	below	the slots of the function if it runs already
+ *
+ * The code of a function uses its slots at the fixed places its ENTER
+ * gives, so only a call that recurses keeps the slots of the calls
+ * before it in its frame, which RETU moves back. */
+#define FRAMEHEAD 5
+
+static int BP=STACKSIZE;
+static char Running[HEAPSTART];	/* by the first slot of a function */
+
 void VMError(int lineno, const char *msg)
 {
+	FlushOutput();
 	fprintf (stderr, "VM error@(%d):%s\n",lineno,msg);
 	exit(0);
 }
@@ -52,6 +76,20 @@ static void MemCopy(int src, int dest)
 	}
 }
 
+/* Leaves src T_NULL without freeing its string, which dest owns now */
+static void MoveMem(int src, int dest)
+{
+	DestroyMem(dest);
+	VMStack[dest]=VMStack[src];
+	VMStack[src].tag=T_NULL;
+	VMMEM(src).str=0;
+}
+
+const char *GetOpName(int op)
+{
+	return opname[op & OPMASK];
+}
+
 void PrintDisasm(FILE *fp, int addr, const Instruction *code)
 {
 	const char *fmt_int="0x%X", *fmt_float="%g";
@@ -107,6 +145,37 @@ void Run(int addr)
 {
 	IP=addr;
 	while (Step());
+	FlushOutput();
+}
+
+long RunProfile(int addr, long *count, long *taken)
+{
+	long steps=0;
+	int at;
+
+	IP=addr;
+	for (;;) {
+		at=IP;
+		steps++;
+		if (at<0 || at>=CODESIZE) {	/* strayed, run on as Run does */
+			if (!Step()) break;
+			continue;
+		}
+		count[at]++;
+		if (!Step()) break;
+		switch (VMCode[at].op&OPMASK) {
+		case JMP:
+		case JE:
+		case JNE:
+		case JG:
+		case JL:
+		case JLE:
+		case JGE:
+			if (IP==VMCode[at].dest) taken[at]++;
+		}
+	}
+	FlushOutput();
+	return steps;
 }
 
 void PrepareMem(int addr)
@@ -182,6 +251,227 @@ void SetMemStr(int addr, const StringType &str)
 	*VMMEM(addr).str=str;
 }
 
+/* The capacity of the string in the slot is kept */
+void SetMemChars(int addr, const char *str, size_t len)
+{
+	if (VMStack[addr].tag!=T_STRING)
+		PrepareMem(addr);
+	VMMEM(addr).str->assign(str, len);
+}
+
+/* FNV-1a, the switch picks its seeds when it is compiled */
+unsigned HashString(const StringType &str)
+{
+	unsigned hash=2166136261u;
+	size_t i;
+
+	for (i=0; i<str.size(); i++) hash=(hash^(unsigned char)str[i])*16777619u;
+	return hash;
+}
+
+unsigned HashSlot(unsigned hash, int seed)
+{
+	hash^=(unsigned)seed*0x9E3779B9u;
+	hash^=hash>>16;
+	hash*=0x85EBCA6Bu;
+	hash^=hash>>13;
+	hash*=0xC2B2AE35u;
+	return hash^(hash>>16);
+}
+
+/* A builtin on the operands of the instruction, without the stack */
+static void Intrinsic(int func)
+{
+	float param[PUREPARAMS];
+
+	PrepareFloat(VMCode[IP].op|FLAG2, &param[0], &param[1]);
+	if (Function[func].paramcnt>1 && !(VMCode[IP].op&FLAG2))
+		param[1]=GetMemFloat(VMCode[IP].src2.i);
+	SetMemFloat(VMCode[IP].dest, EvalPure(func, param));
+	IP++;
+}
+
+/* Copy src to dest as a value of the type */
+static void CopyAs(int type, int src, int dest)
+{
+	switch (type) {
+	case T_INTEGER:
+		SetMemInt(dest, GetMemInt(src));
+		break;
+	case T_FLOAT:
+		SetMemFloat(dest, GetMemFloat(src));
+		break;
+	default:
+		MemCopy(src, dest);
+	}
+}
+
+/* The params are copied before the slots are saved, since they may be
+ * the slots of the same function */
+static void CallUser()
+{
+	const Instruction *inst=&VMCode[IP], *arg;
+	const Instruction *enter=&VMCode[inst->src1.i];
+	int argc=inst->src2.i, lo=enter->src1.i, size=enter->src2.i;
+	int base=SP-argc, k;
+
+	/* RETU takes the value aside just below SP */
+	if (base-FRAMEHEAD-size-1<HeapTop) VMError(__LINE__, "Stack overflow.");
+	for (k=0; k<argc; k++) {
+		arg=&inst[1+k];
+		if (!(arg->op&FLAG1)) MemCopy(arg->src1.i, base+k);
+		else if (arg->op&FLFLAG) SetMemFloat(base+k, arg->src1.f);
+		else SetMemInt(base+k, arg->src1.i);
+	}
+	SetMemInt(base-1, IP+1+argc);
+	SetMemInt(base-2, inst->dest);
+	SetMemInt(base-3, BP);
+	SetMemInt(base-4, inst->src1.i);
+	SetMemInt(base-5, argc);
+	SP=base-FRAMEHEAD;
+	if (size && Running[lo]) {
+		SP-=size;
+		for (k=0; k<size; k++) MoveMem(lo+k, SP+k);
+	}
+	if (size) Running[lo]=1;
+	BP=base;
+	IP=inst->src1.i+1;
+}
+
+static void ReturnUser()
+{
+	const Instruction *inst=&VMCode[IP], *enter=&VMCode[VMMEM(BP-4).i];
+	int lo=enter->src1.i, size=enter->src2.i, argc=VMMEM(BP-5).i;
+	int frame=BP, value=SP-1, dest, k;
+
+	/* The value may be in the slots put back */
+	if (!(inst->op&FLAG1)) CopyAs(inst->dest, inst->src1.i, value);
+	else if (inst->dest==T_FLOAT)
+		SetMemFloat(value, inst->op&FLFLAG ? inst->src1.f : (float)inst->src1.i);
+	else SetMemInt(value, inst->op&FLFLAG ? (int)inst->src1.f : inst->src1.i);
+	if (SP<frame-FRAMEHEAD) {
+		for (k=0; k<size; k++) MoveMem(SP+k, lo+k);
+	}
+	else if (size) Running[lo]=0;
+	IP=VMMEM(frame-1).i;
+	dest=VMMEM(frame-2).i;
+	BP=VMMEM(frame-3).i;
+	for (k=frame-FRAMEHEAD; k<frame+argc; k++) DestroyMem(k);
+	SP=frame+argc;
+	MoveMem(value, dest);
+}
+
+/* Take the JE that the switch value would match, or go past them */
+static void JumpTable()
+{
+	const Instruction *inst=&VMCode[IP], *tests;
+	int n=inst->dest, lo, hi, mid, value;
+	unsigned hash, k;
+
+	switch (inst->op & OPMASK) {
+	case JTAB:
+		tests=inst+1;
+		k=(unsigned)GetMemInt(inst->src1.i)-(unsigned)inst->src2.i;
+		if (k<(unsigned)n) {
+			IP=tests[k].dest;
+			return;
+		}
+		break;
+	case JBIN:
+		tests=inst+1;
+		value=GetMemInt(inst->src1.i);
+		for (lo=0, hi=n; lo<hi; ) {
+			mid=(lo+hi)/2;
+			if (tests[mid].src2.i<value) lo=mid+1;
+			else hi=mid;
+		}
+		if (lo<n && tests[lo].src2.i==value) {
+			IP=tests[lo].dest;
+			return;
+		}
+		break;
+	default:
+		if (VMStack[inst->src1.i].tag!=T_STRING)
+			VMError(__LINE__, "Access violation.");
+		tests=inst+1+inst->src2.i;
+		hash=HashString(*VMMEM(inst->src1.i).str);
+		k=HashSlot(hash, inst[1+hash%inst->src2.i].src1.i)%n;
+		if (*VMMEM(inst->src1.i).str==*VMMEM(tests[k].src2.i).str) {
+			IP=tests[k].dest;
+			return;
+		}
+	}
+	IP=tests+n-VMCode;
+}
+
+/* Jump if the order of src1 and src2 is the one of the opcode */
+static void JumpCompare()
+{
+	float srcfloat1, srcfloat2;
+	int srcint1, srcint2, order, taken;
+
+	if (VMCode[IP].op&FLFLAG) {
+		PrepareFloat(VMCode[IP].op, &srcfloat1, &srcfloat2);
+		/* An unordered NaN makes every compare false */
+		if (srcfloat1<srcfloat2) order=-1;
+		else if (srcfloat1>srcfloat2) order=1;
+		else if (srcfloat1==srcfloat2) order=0;
+		else {
+			IP++;
+			return;
+		}
+	}
+	else if (VMCode[IP].op&STRFLAG) {
+		order=VMMEM(VMCode[IP].src1.i).str->compare(*VMMEM(VMCode[IP].src2.i).str);
+	}
+	else {
+		PrepareInt(VMCode[IP].op, &srcint1, &srcint2);
+		order=srcint1<srcint2 ? -1 : srcint1>srcint2;
+	}
+	switch (VMCode[IP].op & OPMASK) {
+	case JG:
+		taken=order>0;
+		break;
+	case JL:
+		taken=order<0;
+		break;
+	case JLE:
+		taken=order<=0;
+		break;
+	default:
+		taken=order>=0;
+	}
+	if (!taken) IP++;
+	else if (VMCode[IP].op&FLAG3) IP=VMCode[IP].dest;
+	else IP=VMMEM(VMCode[IP].dest).i;
+}
+
+/* The compare after a FORLOOP. The counter and the bound were checked
+ * to be integers by its FORPREP, and the body doesn't assign them. */
+static void ForCompare()
+{
+	int count, bound, taken;
+
+	count=VMMEM(VMCode[IP].src1.i).i;
+	if (VMCode[IP].op&FLAG2) bound=VMCode[IP].src2.i;
+	else bound=VMMEM(VMCode[IP].src2.i).i;
+	switch (VMCode[IP].op & OPMASK) {
+	case JG:
+		taken=count>bound;
+		break;
+	case JL:
+		taken=count<bound;
+		break;
+	case JLE:
+		taken=count<=bound;
+		break;
+	default:
+		taken=count>=bound;
+	}
+	if (taken) IP=VMCode[IP].dest;
+	else IP++;
+}
+
 int Step()
 {
 	float srcfloat1, srcfloat2;
@@ -481,7 +771,79 @@ int Step()
 			else IP++;
 		}
 		break;
-/*  JG,  JL */
+	case JG:
+	case JL:
+	case JLE:
+	case JGE:
+		JumpCompare();
+		break;
+	case FORPREP:
+		/* The first test of a counted loop checks the types */
+		IP++;
+		JumpCompare();
+		break;
+	case FORLOOP:
+		/* Added unsigned, a counter past a bound near INT_MAX or INT_MIN
+		 * wraps around as the INC or ADD of the loop did */
+		VMMEM(VMCode[IP].dest).i=(int)((unsigned)VMMEM(VMCode[IP].dest).i
+			+(unsigned)VMCode[IP].src2.i);
+		IP++;
+		ForCompare();
+		break;
+	case JTAB:
+	case JBIN:
+	case JHASH:
+		JumpTable();
+		break;
+	case SQRTF:
+		Intrinsic(SQRT);
+		break;
+	case FABSF:
+		Intrinsic(FABS);
+		break;
+	case FLOORF:
+		Intrinsic(FLOOR);
+		break;
+	case CEILF:
+		Intrinsic(CEIL);
+		break;
+	case SINF:
+		Intrinsic(SIN);
+		break;
+	case COSF:
+		Intrinsic(COS);
+		break;
+	case EXPF:
+		Intrinsic(EXP);
+		break;
+	case POWF:
+		Intrinsic(POW);
+		break;
+	case CALLU:
+		CallUser();
+		break;
+	case RETU:
+		ReturnUser();
+		break;
+	case PARAM:
+		CopyAs(VMCode[IP].src2.i, BP+VMCode[IP].src1.i, VMCode[IP].dest);
+		IP++;
+		break;
+	case CMOV:
+		/* The pick is a data move, not a jump the host must predict */
+		{
+			int pick=VMMEM(VMCode[IP].dest).i==0;
+			const Instruction::UData *src=pick ? &VMCode[IP].src2 : &VMCode[IP].src1;
+
+			if (!(VMCode[IP].op&(FLAG1<<pick)))
+				MemCopy(src->i, VMCode[IP].dest);
+			else if (VMCode[IP].op&FLFLAG)
+				SetMemFloat(VMCode[IP].dest, src->f);
+			else
+				SetMemInt(VMCode[IP].dest, src->i);
+		}
+		IP++;
+		break;
 	case JNE:
 		if (VMCode[IP].op&FLFLAG) {
 			PrepareFloat(VMCode[IP].op, &srcfloat1, &srcfloat2);
@@ -543,6 +905,7 @@ int Step()
 		IP++;
 		break;
 	default:
+		FlushOutput();
 		printf ("Instruction %d(0x%X) at 0x%X can't be handled.\n",
 			VMCode[IP].op,VMCode[IP].op,IP);
 		return 0;
@@ -555,8 +918,12 @@ void ResetVM()
 	int i;
 	SP=STACKSIZE;
 	IP=0;
+	BP=STACKSIZE;
+	HeapTop=HEAPSTART;
+	memset(Running, 0, sizeof(Running));
 	for (i=0; i<STACKSIZE; i++) {
-		VMStack[i].tag=T_NULL;
+		/* Strings left by a previous program */
+		DestroyMem(i);
 		VMMEM(i).str=0;
 	}
 }
@@ -40,9 +40,9 @@ using namespace std;
 
 #include "funcdefs.h"
 
-#define CODESIZE 4096
-#define STACKSIZE 4096
-#define HEAPSTART 2048
+#define CODESIZE 262144
+#define STACKSIZE 65536
+#define HEAPSTART 32768
 #define FLAG1 0x0100
 #define FLAG2 0x0200
 #define FLAG3 0x0400
@@ -54,8 +54,28 @@ enum {
 	MOV, ADD, SUB, MUL, DIV, MOD, OR,  AND, XOR,
 	NOTEQU, EQU, LESS, LE, GREAT, GE,
 	PUSH, POP, JMP, CALL, RET, JE,  JG,  JL, SHL, SHR,
-	NOT, INC, DEC, JNE, CNV
+	NOT, INC, DEC, JNE, CNV, JLE, JGE, FORPREP, FORLOOP, CMOV,
+	JTAB, JBIN, JHASH,
+	SQRTF, FABSF, FLOORF, CEILF, SINF, COSF, EXPF, POWF, ARG,
+	CALLU, RETU, PARAM, ENTER
 };
+/* FORPREP and FORLOOP (add src2 to dest) run the compare that follows
+ * them in the same step. CMOV copies src1 to dest if dest isn't 0,
+ * else src2, FLFLAG is the type of its immediates.
+ * JTAB, JBIN and JHASH take the JE among the dest ones after them that
+ * src1 would match, or go on after them: JTAB indexes the keys that
+ * follow from src2, JBIN searches the sorted keys and JHASH hashes the
+ * string with the src2 seeds that come first.
+ * SQRTF to POWF run the builtin of the same name on src1 (and src2 for
+ * POWF) as CALL would, they always have FLFLAG.
+ * CALL src1 is followed by src2 ARG, one for each param in order, which
+ * the builtin reads in place. ARG isn't run, CALL goes on after them.
+ * CALLU calls the user function whose ENTER is at src1 with the src2
+ * ARG after it. RETU returns src1 as the type in dest to the dest of
+ * that CALLU, PARAM copies param src1 of the running function to dest
+ * as the type in src2. ENTER isn't run, it tells CALLU that the slots
+ * of the function are src1 up to src1+src2, and where its code ends,
+ * at dest. */
 /* For new opcode, don't change any order. Just append after the last one,
  * and change vmachine.cpp and OprCode() in .y accordinglly */
 
@@ -89,18 +109,24 @@ extern "C" {
 #endif
 
 extern int SP,IP;
+extern int HeapTop;		/* the constants are below it, the frames above */
 extern Instruction VMCode[CODESIZE];
 extern MemUnit VMStack[STACKSIZE];
 
 /* This function is for debug */
 void PrintDisasm(FILE *fp, int addr, const Instruction *code);
+const char *GetOpName(int op);
 
 void Run(int addr);
+/* Run, counting the steps of each instruction and the jumps that went
+ * to their dest, returns the steps */
+long RunProfile(int addr, long *count, long *taken);
 int Step();
 void ResetVM();
 void PrepareMem(int addr);
 void DestroyMem(int addr);
 void SetMemStr(int addr, const StringType &str);
+void SetMemChars(int addr, const char *str, size_t len);
 void SetMemFloat(int addr, float num);
 void SetMemInt(int addr, int num);
 
@@ -109,6 +135,8 @@ void PrepareInt(int op, int *psrc1, int *psrc2);
 void VMError(int lineno, const char*msg);
 float GetMemFloat(int addr);
 int GetMemInt(int addr);
+unsigned HashString(const StringType &str);
+unsigned HashSlot(unsigned hash, int seed);
 
 #ifdef __cplusplus
 }
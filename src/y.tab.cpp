@@ -0,0 +1,2067 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "src/gram.y"
+
+
+/* gram.y - Grammar analyzer
+ *
+ * Copyright (c) 2019 Eric Wan <aloha_cn@hotmail.com>
+ *
+ * This file is part of MYL.
+ *
+ * MYL is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The actions are in codegen.cpp, shared with the parser in rdparse.cpp */
+
+#include <stdio.h>
+
+#include "myl.h"
+#include "myl_internal.h"
+#include "element.h"
+#include "vmachine.h"
+#include "codegen.h"
+
+static int yyparse(MYLParser *parser);
+static int yylex(MYLParser *parser);
+static void yyerror(MYLParser *parser, const char *s);
+
+
+#line 109 "y.tab.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    CNTINT = 258,                  /* CNTINT  */
+    FLT = 259,                     /* FLT  */
+    STR = 260,                     /* STR  */
+    IDENT = 261,                   /* IDENT  */
+    KEYIF = 262,                   /* KEYIF  */
+    KEYELSE = 263,                 /* KEYELSE  */
+    KEYFOR = 264,                  /* KEYFOR  */
+    KEYWHILE = 265,                /* KEYWHILE  */
+    KEYDO = 266,                   /* KEYDO  */
+    KEYCONT = 267,                 /* KEYCONT  */
+    KEYBREAK = 268,                /* KEYBREAK  */
+    KEYSWITCH = 269,               /* KEYSWITCH  */
+    KEYCASE = 270,                 /* KEYCASE  */
+    KEYDEFAULT = 271,              /* KEYDEFAULT  */
+    KEYGOTO = 272,                 /* KEYGOTO  */
+    KEYRETURN = 273,               /* KEYRETURN  */
+    KEYTYPE = 274,                 /* KEYTYPE  */
+    SEMICOLON = 275,               /* SEMICOLON  */
+    LBRACKET = 276,                /* LBRACKET  */
+    RBRACKET = 277,                /* RBRACKET  */
+    LPARA = 278,                   /* LPARA  */
+    RPARA = 279,                   /* RPARA  */
+    SELECT = 280,                  /* SELECT  */
+    COLON = 281,                   /* COLON  */
+    BOOLOR = 282,                  /* BOOLOR  */
+    BOOLAND = 283,                 /* BOOLAND  */
+    INCOPS = 284,                  /* INCOPS  */
+    DECOPS = 285,                  /* DECOPS  */
+    SETOPS = 286,                  /* SETOPS  */
+    COMMA = 287,                   /* COMMA  */
+    BOOLOPS = 288,                 /* BOOLOPS  */
+    BITOPS = 289,                  /* BITOPS  */
+    SHIFTOPS = 290,                /* SHIFTOPS  */
+    ADDOPS = 291,                  /* ADDOPS  */
+    MULOPS = 292,                  /* MULOPS  */
+    BOOLNOT = 293,                 /* BOOLNOT  */
+    BITNOT = 294                   /* BITNOT  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define CNTINT 258
+#define FLT 259
+#define STR 260
+#define IDENT 261
+#define KEYIF 262
+#define KEYELSE 263
+#define KEYFOR 264
+#define KEYWHILE 265
+#define KEYDO 266
+#define KEYCONT 267
+#define KEYBREAK 268
+#define KEYSWITCH 269
+#define KEYCASE 270
+#define KEYDEFAULT 271
+#define KEYGOTO 272
+#define KEYRETURN 273
+#define KEYTYPE 274
+#define SEMICOLON 275
+#define LBRACKET 276
+#define RBRACKET 277
+#define LPARA 278
+#define RPARA 279
+#define SELECT 280
+#define COLON 281
+#define BOOLOR 282
+#define BOOLAND 283
+#define INCOPS 284
+#define DECOPS 285
+#define SETOPS 286
+#define COMMA 287
+#define BOOLOPS 288
+#define BITOPS 289
+#define SHIFTOPS 290
+#define ADDOPS 291
+#define MULOPS 292
+#define BOOLNOT 293
+#define BITNOT 294
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 41 "src/gram.y"
+
+	int nval;
+	Varval vval;
+	Paraval pval;
+	Expval eval;
+	Intval ival;
+	Element lexval;
+	
+
+#line 247 "y.tab.cpp"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (MYLParser *parser);
+
+
+
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CNTINT = 3,                     /* CNTINT  */
+  YYSYMBOL_FLT = 4,                        /* FLT  */
+  YYSYMBOL_STR = 5,                        /* STR  */
+  YYSYMBOL_IDENT = 6,                      /* IDENT  */
+  YYSYMBOL_KEYIF = 7,                      /* KEYIF  */
+  YYSYMBOL_KEYELSE = 8,                    /* KEYELSE  */
+  YYSYMBOL_KEYFOR = 9,                     /* KEYFOR  */
+  YYSYMBOL_KEYWHILE = 10,                  /* KEYWHILE  */
+  YYSYMBOL_KEYDO = 11,                     /* KEYDO  */
+  YYSYMBOL_KEYCONT = 12,                   /* KEYCONT  */
+  YYSYMBOL_KEYBREAK = 13,                  /* KEYBREAK  */
+  YYSYMBOL_KEYSWITCH = 14,                 /* KEYSWITCH  */
+  YYSYMBOL_KEYCASE = 15,                   /* KEYCASE  */
+  YYSYMBOL_KEYDEFAULT = 16,                /* KEYDEFAULT  */
+  YYSYMBOL_KEYGOTO = 17,                   /* KEYGOTO  */
+  YYSYMBOL_KEYRETURN = 18,                 /* KEYRETURN  */
+  YYSYMBOL_KEYTYPE = 19,                   /* KEYTYPE  */
+  YYSYMBOL_SEMICOLON = 20,                 /* SEMICOLON  */
+  YYSYMBOL_LBRACKET = 21,                  /* LBRACKET  */
+  YYSYMBOL_RBRACKET = 22,                  /* RBRACKET  */
+  YYSYMBOL_LPARA = 23,                     /* LPARA  */
+  YYSYMBOL_RPARA = 24,                     /* RPARA  */
+  YYSYMBOL_SELECT = 25,                    /* SELECT  */
+  YYSYMBOL_COLON = 26,                     /* COLON  */
+  YYSYMBOL_BOOLOR = 27,                    /* BOOLOR  */
+  YYSYMBOL_BOOLAND = 28,                   /* BOOLAND  */
+  YYSYMBOL_INCOPS = 29,                    /* INCOPS  */
+  YYSYMBOL_DECOPS = 30,                    /* DECOPS  */
+  YYSYMBOL_SETOPS = 31,                    /* SETOPS  */
+  YYSYMBOL_COMMA = 32,                     /* COMMA  */
+  YYSYMBOL_BOOLOPS = 33,                   /* BOOLOPS  */
+  YYSYMBOL_BITOPS = 34,                    /* BITOPS  */
+  YYSYMBOL_SHIFTOPS = 35,                  /* SHIFTOPS  */
+  YYSYMBOL_ADDOPS = 36,                    /* ADDOPS  */
+  YYSYMBOL_MULOPS = 37,                    /* MULOPS  */
+  YYSYMBOL_BOOLNOT = 38,                   /* BOOLNOT  */
+  YYSYMBOL_BITNOT = 39,                    /* BITNOT  */
+  YYSYMBOL_YYACCEPT = 40,                  /* $accept  */
+  YYSYMBOL_langstart = 41,                 /* langstart  */
+  YYSYMBOL_MYL = 42,                       /* MYL  */
+  YYSYMBOL_statement = 43,                 /* statement  */
+  YYSYMBOL_funcpre = 44,                   /* funcpre  */
+  YYSYMBOL_formals = 45,                   /* formals  */
+  YYSYMBOL_formallist = 46,                /* formallist  */
+  YYSYMBOL_typepre = 47,                   /* typepre  */
+  YYSYMBOL_label = 48,                     /* label  */
+  YYSYMBOL_switchpre = 49,                 /* switchpre  */
+  YYSYMBOL_dopre = 50,                     /* dopre  */
+  YYSYMBOL_forinitpre = 51,                /* forinitpre  */
+  YYSYMBOL_forconpre = 52,                 /* forconpre  */
+  YYSYMBOL_foractpre = 53,                 /* foractpre  */
+  YYSYMBOL_whilepre = 54,                  /* whilepre  */
+  YYSYMBOL_ifpre = 55,                     /* ifpre  */
+  YYSYMBOL_elsepre = 56,                   /* elsepre  */
+  YYSYMBOL_expression = 57,                /* expression  */
+  YYSYMBOL_selectpre = 58,                 /* selectpre  */
+  YYSYMBOL_colonpre = 59,                  /* colonpre  */
+  YYSYMBOL_lresult = 60,                   /* lresult  */
+  YYSYMBOL_boolexp = 61,                   /* boolexp  */
+  YYSYMBOL_boolorpre = 62,                 /* boolorpre  */
+  YYSYMBOL_boolandpre = 63,                /* boolandpre  */
+  YYSYMBOL_compexp = 64,                   /* compexp  */
+  YYSYMBOL_bitexp = 65,                    /* bitexp  */
+  YYSYMBOL_shiftexp = 66,                  /* shiftexp  */
+  YYSYMBOL_addexp = 67,                    /* addexp  */
+  YYSYMBOL_mulexp = 68,                    /* mulexp  */
+  YYSYMBOL_boolpre = 69,                   /* boolpre  */
+  YYSYMBOL_bitpre = 70,                    /* bitpre  */
+  YYSYMBOL_shiftpre = 71,                  /* shiftpre  */
+  YYSYMBOL_addpre = 72,                    /* addpre  */
+  YYSYMBOL_mulpre = 73,                    /* mulpre  */
+  YYSYMBOL_factor = 74,                    /* factor  */
+  YYSYMBOL_function = 75,                  /* function  */
+  YYSYMBOL_parameter = 76,                 /* parameter  */
+  YYSYMBOL_paralist = 77                   /* paralist  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  80
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   219
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  40
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  38
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  85
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  159
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   294
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,    96,    96,    99,   101,   103,   105,   107,   109,   111,
+     113,   115,   117,   119,   121,   123,   125,   128,   130,   132,
+     134,   136,   139,   142,   143,   145,   147,   150,   153,   156,
+     158,   160,   162,   164,   167,   170,   173,   176,   179,   182,
+     185,   188,   191,   193,   195,   197,   200,   203,   206,   208,
+     210,   212,   215,   218,   220,   222,   224,   226,   228,   230,
+     232,   234,   236,   237,   239,   241,   244,   247,   250,   253,
+     256,   259,   261,   263,   265,   267,   269,   271,   273,   275,
+     276,   279,   282,   283,   285,   287
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "CNTINT", "FLT", "STR",
+  "IDENT", "KEYIF", "KEYELSE", "KEYFOR", "KEYWHILE", "KEYDO", "KEYCONT",
+  "KEYBREAK", "KEYSWITCH", "KEYCASE", "KEYDEFAULT", "KEYGOTO", "KEYRETURN",
+  "KEYTYPE", "SEMICOLON", "LBRACKET", "RBRACKET", "LPARA", "RPARA",
+  "SELECT", "COLON", "BOOLOR", "BOOLAND", "INCOPS", "DECOPS", "SETOPS",
+  "COMMA", "BOOLOPS", "BITOPS", "SHIFTOPS", "ADDOPS", "MULOPS", "BOOLNOT",
+  "BITNOT", "$accept", "langstart", "MYL", "statement", "funcpre",
+  "formals", "formallist", "typepre", "label", "switchpre", "dopre",
+  "forinitpre", "forconpre", "foractpre", "whilepre", "ifpre", "elsepre",
+  "expression", "selectpre", "colonpre", "lresult", "boolexp", "boolorpre",
+  "boolandpre", "compexp", "bitexp", "shiftexp", "addexp", "mulexp",
+  "boolpre", "bitpre", "shiftpre", "addpre", "mulpre", "factor",
+  "function", "parameter", "paralist", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-26)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-48)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+     140,   -26,   -26,   -26,    -2,   -21,    27,    33,   -26,    61,
+      63,    77,     9,    75,    96,   161,   -26,   -26,    48,   161,
+      97,    97,   189,   189,   189,   104,   140,   -26,   108,   122,
+     140,   140,   140,   161,   140,   140,   140,   -17,   161,     8,
+      21,   161,   161,    98,   100,    95,    99,   101,   161,   161,
+     161,   161,   189,   -26,   -26,   161,   -26,   161,   161,   161,
+     -26,   -26,   161,   111,   114,   136,   -26,   128,     3,     0,
+     -26,   103,    51,   -26,   -26,   -26,    43,   -26,   -26,   -26,
+     -26,   -26,   162,   147,   141,    -1,   -26,   -26,   164,   161,
+      10,   -26,   167,   -26,   -26,   -26,    54,   161,   -26,   -26,
+     161,   -26,   -26,    98,    98,   -26,   -26,   -26,   -26,   -26,
+     100,    95,    99,   101,   -26,   152,   148,   149,    64,    16,
+      66,    68,   -26,   -26,   -26,   -26,   -26,   -26,   -26,   -26,
+     140,   163,   -26,   -26,   -26,   157,   140,    70,   -26,   -26,
+     -26,   152,   152,   -26,   161,   -26,   -26,   -26,   -26,   -26,
+     177,   161,   -26,   -26,   152,   -26,    72,   176,   -26
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,    71,    72,    73,    78,     0,     0,     0,    35,     0,
+       0,     0,     0,     0,     0,     0,    28,    15,     0,     0,
+       0,     0,     0,     0,     0,     0,     2,     4,    24,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      44,     0,     0,    50,    54,    56,    58,    60,     0,     0,
+       0,     0,     0,    62,    79,    83,    29,     0,     0,     0,
+      11,    12,     0,     0,     0,     0,    33,     0,    78,     0,
+      14,     0,     0,    47,    74,    75,     0,    63,    64,    65,
+       1,     3,     0,     0,    23,     0,    18,    17,     0,     0,
+       0,     7,     5,     6,    10,    45,     0,     0,    76,    77,
+       0,    51,    52,    48,    49,    66,    67,    68,    69,    70,
+      53,    55,    57,    59,    61,    85,     0,    82,     0,     0,
+       0,     0,    30,    31,    32,    19,    21,    13,    80,    26,
+       0,     0,    16,    22,    27,     0,     0,     0,    37,    41,
+      46,    43,    42,    81,     0,    40,    36,    39,    34,    20,
+       0,     0,     8,    38,    84,    25,     0,     0,     9
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+     -26,   -26,   180,   -25,   -26,   -26,   -26,   -26,   -26,   -26,
+     -26,   -26,   -26,   -26,   -26,   -26,   -26,   -15,   -26,   -26,
+     165,   -26,   -26,   -26,    57,   153,   154,   155,   151,   -26,
+     -26,   -26,   -26,   -26,    -7,   -26,   -26,   -26
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
+{
+       0,    25,    26,    27,    28,    83,    84,    29,    30,    31,
+      32,    33,    89,   136,    34,    35,    36,    37,    38,    97,
+      39,    40,    41,    42,    43,    44,    45,    46,    47,    48,
+      49,    50,    51,    52,    53,    54,   116,   117
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      69,    81,    57,    94,    72,    86,    87,    88,    95,    91,
+      92,    93,    63,    64,    65,    77,    78,    79,    90,   132,
+     126,    55,   133,    96,    56,    95,    55,   -47,   -47,   -47,
+     138,   134,   -47,   -47,   -47,    95,   146,    98,    99,   100,
+     115,    95,   118,   119,   120,   114,    81,   121,   101,   102,
+      58,     1,     2,     3,     4,     5,    59,     6,     7,     8,
+       9,    10,    11,    12,    13,    14,    15,    16,    17,    18,
+      70,    19,    98,    99,   137,   128,    95,    20,    21,    95,
+     140,    60,   141,    61,    22,   142,    23,    24,   145,    95,
+     147,    95,   148,    95,   153,    95,   157,    95,   103,   104,
+      62,    66,    67,    73,    80,   149,     1,     2,     3,     4,
+       5,   152,     6,     7,     8,     9,    10,    11,    12,    13,
+      14,    15,    16,    17,    18,   127,    19,    82,    85,   154,
+     107,   105,    20,    21,   106,   108,   156,   122,   109,    22,
+     123,    23,    24,     1,     2,     3,     4,     5,   125,     6,
+       7,     8,     9,    10,    11,    12,    13,    14,    15,    16,
+      17,    18,   124,    19,     1,     2,     3,    68,   129,    20,
+      21,   130,   143,   131,   135,   139,    22,    95,    23,    24,
+     151,   144,   150,   155,    19,    74,    75,    76,    76,    76,
+      20,    21,     1,     2,     3,    68,   158,    22,    71,    23,
+      24,   110,   113,   111,     0,   112,    76,    76,     0,     0,
+       0,     0,    19,    76,    76,    76,    76,    76,    20,    21
+};
+
+static const yytype_int16 yycheck[] =
+{
+      15,    26,    23,    20,    19,    30,    31,    32,    25,    34,
+      35,    36,     3,     4,     5,    22,    23,    24,    33,    20,
+      20,    23,    23,    38,    26,    25,    23,    29,    30,    31,
+      20,    32,    29,    30,    31,    25,    20,    29,    30,    31,
+      55,    25,    57,    58,    59,    52,    71,    62,    27,    28,
+      23,     3,     4,     5,     6,     7,    23,     9,    10,    11,
+      12,    13,    14,    15,    16,    17,    18,    19,    20,    21,
+      22,    23,    29,    30,    89,    24,    25,    29,    30,    25,
+      26,    20,    97,    20,    36,   100,    38,    39,    24,    25,
+      24,    25,    24,    25,    24,    25,    24,    25,    41,    42,
+      23,    26,     6,     6,     0,   130,     3,     4,     5,     6,
+       7,   136,     9,    10,    11,    12,    13,    14,    15,    16,
+      17,    18,    19,    20,    21,    22,    23,    19,     6,   144,
+      35,    33,    29,    30,    34,    36,   151,    26,    37,    36,
+      26,    38,    39,     3,     4,     5,     6,     7,    20,     9,
+      10,    11,    12,    13,    14,    15,    16,    17,    18,    19,
+      20,    21,    26,    23,     3,     4,     5,     6,     6,    29,
+      30,    24,    24,    32,    10,     8,    36,    25,    38,    39,
+      23,    32,    19,     6,    23,    20,    21,    22,    23,    24,
+      29,    30,     3,     4,     5,     6,    20,    36,    18,    38,
+      39,    48,    51,    49,    -1,    50,    41,    42,    -1,    -1,
+      -1,    -1,    23,    48,    49,    50,    51,    52,    29,    30
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     3,     4,     5,     6,     7,     9,    10,    11,    12,
+      13,    14,    15,    16,    17,    18,    19,    20,    21,    23,
+      29,    30,    36,    38,    39,    41,    42,    43,    44,    47,
+      48,    49,    50,    51,    54,    55,    56,    57,    58,    60,
+      61,    62,    63,    64,    65,    66,    67,    68,    69,    70,
+      71,    72,    73,    74,    75,    23,    26,    23,    23,    23,
+      20,    20,    23,     3,     4,     5,    26,     6,     6,    57,
+      22,    42,    57,     6,    60,    60,    60,    74,    74,    74,
+       0,    43,    19,    45,    46,     6,    43,    43,    43,    52,
+      57,    43,    43,    43,    20,    25,    57,    59,    29,    30,
+      31,    27,    28,    64,    64,    33,    34,    35,    36,    37,
+      65,    66,    67,    68,    74,    57,    76,    77,    57,    57,
+      57,    57,    26,    26,    26,    20,    20,    22,    24,     6,
+      24,    32,    20,    23,    32,    10,    53,    57,    20,     8,
+      26,    57,    57,    24,    32,    24,    20,    24,    24,    43,
+      19,    23,    43,    24,    57,     6,    57,    24,    20
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    40,    41,    42,    42,    43,    43,    43,    43,    43,
+      43,    43,    43,    43,    43,    43,    43,    43,    43,    43,
+      43,    43,    44,    45,    45,    46,    46,    47,    47,    48,
+      48,    48,    48,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    57,    57,    58,    59,    60,    61,    61,
+      61,    62,    63,    64,    64,    65,    65,    66,    66,    67,
+      67,    68,    68,    68,    68,    68,    69,    70,    71,    72,
+      73,    74,    74,    74,    74,    74,    74,    74,    74,    74,
+      74,    75,    76,    76,    77,    77
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     2,     2,     2,     4,     7,
+       2,     2,     2,     3,     2,     1,     3,     2,     2,     3,
+       4,     3,     3,     1,     0,     4,     2,     3,     1,     2,
+       3,     3,     3,     2,     4,     1,     4,     2,     2,     4,
+       4,     3,     3,     3,     1,     2,     2,     1,     2,     2,
+       1,     2,     2,     2,     1,     2,     1,     2,     1,     2,
+       1,     2,     1,     2,     2,     2,     2,     2,     2,     2,
+       2,     1,     1,     1,     2,     2,     2,     2,     1,     1,
+       3,     4,     1,     0,     3,     1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (parser, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, parser); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, MYLParser *parser)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (parser);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, MYLParser *parser)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep, parser);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, MYLParser *parser)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], parser);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, parser); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, MYLParser *parser)
+{
+  YY_USE (yyvaluep);
+  YY_USE (parser);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (MYLParser *parser)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (parser);
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* langstart: MYL  */
+#line 97 "src/gram.y"
+                                {EndUnit(parser, &(yyvsp[0].ival));}
+#line 1423 "y.tab.cpp"
+    break;
+
+  case 3: /* MYL: MYL statement  */
+#line 100 "src/gram.y"
+                                {JoinStatements(&(yyval.ival), &(yyvsp[-1].ival), &(yyvsp[0].ival));}
+#line 1429 "y.tab.cpp"
+    break;
+
+  case 5: /* statement: ifpre statement  */
+#line 104 "src/gram.y"
+                                {EndIf(&(yyval.ival), &(yyvsp[-1].ival), &(yyvsp[0].ival));}
+#line 1435 "y.tab.cpp"
+    break;
+
+  case 6: /* statement: elsepre statement  */
+#line 106 "src/gram.y"
+                                {EndIf(&(yyval.ival), &(yyvsp[-1].ival), &(yyvsp[0].ival));}
+#line 1441 "y.tab.cpp"
+    break;
+
+  case 7: /* statement: whilepre statement  */
+#line 108 "src/gram.y"
+                                {EndWhile(&(yyval.ival), &(yyvsp[-1].ival), &(yyvsp[0].ival));}
+#line 1447 "y.tab.cpp"
+    break;
+
+  case 8: /* statement: forinitpre forconpre foractpre statement  */
+#line 110 "src/gram.y"
+                                {EndFor(parser, &(yyval.ival), &(yyvsp[-3].ival), &(yyvsp[-2].eval), &(yyvsp[-1].ival), &(yyvsp[0].ival));}
+#line 1453 "y.tab.cpp"
+    break;
+
+  case 9: /* statement: dopre statement KEYWHILE LPARA expression RPARA SEMICOLON  */
+#line 112 "src/gram.y"
+                                {EndDoWhile(parser, &(yyval.ival), &(yyvsp[-5].ival), &(yyvsp[-2].eval));}
+#line 1459 "y.tab.cpp"
+    break;
+
+  case 10: /* statement: expression SEMICOLON  */
+#line 114 "src/gram.y"
+                                {ExprStatement(&(yyval.ival), &(yyvsp[-1].eval));}
+#line 1465 "y.tab.cpp"
+    break;
+
+  case 11: /* statement: KEYCONT SEMICOLON  */
+#line 116 "src/gram.y"
+                                {ContinueStatement(parser, &(yyval.ival));}
+#line 1471 "y.tab.cpp"
+    break;
+
+  case 12: /* statement: KEYBREAK SEMICOLON  */
+#line 118 "src/gram.y"
+                                {BreakStatement(parser, &(yyval.ival));}
+#line 1477 "y.tab.cpp"
+    break;
+
+  case 13: /* statement: LBRACKET MYL RBRACKET  */
+#line 120 "src/gram.y"
+                                {(yyval.ival)=(yyvsp[-1].ival);}
+#line 1483 "y.tab.cpp"
+    break;
+
+  case 14: /* statement: LBRACKET RBRACKET  */
+#line 122 "src/gram.y"
+                                {EmptyStatement(&(yyval.ival));}
+#line 1489 "y.tab.cpp"
+    break;
+
+  case 15: /* statement: SEMICOLON  */
+#line 124 "src/gram.y"
+                                {EmptyStatement(&(yyval.ival));}
+#line 1495 "y.tab.cpp"
+    break;
+
+  case 16: /* statement: typepre IDENT SEMICOLON  */
+#line 126 "src/gram.y"
+                                {EmptyStatement(&(yyval.ival));
+				DeclareVar(parser, (yyvsp[-1].lexval).id, (yyvsp[-2].eval).type);}
+#line 1502 "y.tab.cpp"
+    break;
+
+  case 17: /* statement: switchpre statement  */
+#line 129 "src/gram.y"
+                                {EndSwitch(parser, &(yyval.ival), &(yyvsp[-1].eval), &(yyvsp[0].ival));}
+#line 1508 "y.tab.cpp"
+    break;
+
+  case 18: /* statement: label statement  */
+#line 131 "src/gram.y"
+                                {(yyval.ival)=(yyvsp[0].ival);}
+#line 1514 "y.tab.cpp"
+    break;
+
+  case 19: /* statement: KEYGOTO IDENT SEMICOLON  */
+#line 133 "src/gram.y"
+                                {GotoStatement(parser, &(yyval.ival), (yyvsp[-1].lexval).id);}
+#line 1520 "y.tab.cpp"
+    break;
+
+  case 20: /* statement: funcpre formals RPARA statement  */
+#line 135 "src/gram.y"
+                                {EndFunction(parser, &(yyval.ival), &(yyvsp[-3].ival), &(yyvsp[0].ival));}
+#line 1526 "y.tab.cpp"
+    break;
+
+  case 21: /* statement: KEYRETURN expression SEMICOLON  */
+#line 137 "src/gram.y"
+                                {ReturnStatement(parser, &(yyval.ival), &(yyvsp[-1].eval));}
+#line 1532 "y.tab.cpp"
+    break;
+
+  case 22: /* funcpre: typepre IDENT LPARA  */
+#line 140 "src/gram.y"
+                                {BeginFunction(parser, &(yyval.ival), &(yyvsp[-2].eval), (yyvsp[-1].lexval).id);}
+#line 1538 "y.tab.cpp"
+    break;
+
+  case 25: /* formallist: formallist COMMA KEYTYPE IDENT  */
+#line 146 "src/gram.y"
+                                {DeclareParam(parser, (yyvsp[-1].lexval).id-FIRSTTYPE+1, (yyvsp[0].lexval).id);}
+#line 1544 "y.tab.cpp"
+    break;
+
+  case 26: /* formallist: KEYTYPE IDENT  */
+#line 148 "src/gram.y"
+                                {DeclareParam(parser, (yyvsp[-1].lexval).id-FIRSTTYPE+1, (yyvsp[0].lexval).id);}
+#line 1550 "y.tab.cpp"
+    break;
+
+  case 27: /* typepre: typepre IDENT COMMA  */
+#line 151 "src/gram.y"
+                                {(yyval.eval).type=(yyvsp[-2].eval).type;
+				DeclareVar(parser, (yyvsp[-1].lexval).id, (yyvsp[-2].eval).type);}
+#line 1557 "y.tab.cpp"
+    break;
+
+  case 28: /* typepre: KEYTYPE  */
+#line 154 "src/gram.y"
+                                {(yyval.eval).type=(yyvsp[0].lexval).id-FIRSTTYPE+1;}
+#line 1563 "y.tab.cpp"
+    break;
+
+  case 29: /* label: IDENT COLON  */
+#line 157 "src/gram.y"
+                                {DefineLabel(parser, (yyvsp[-1].lexval).id);}
+#line 1569 "y.tab.cpp"
+    break;
+
+  case 30: /* label: KEYCASE CNTINT COLON  */
+#line 159 "src/gram.y"
+                                {DefineCase(parser, T_INTEGER, (yyvsp[-1].lexval).id);}
+#line 1575 "y.tab.cpp"
+    break;
+
+  case 31: /* label: KEYCASE FLT COLON  */
+#line 161 "src/gram.y"
+                                {DefineCase(parser, T_FLOAT, (yyvsp[-1].lexval).id);}
+#line 1581 "y.tab.cpp"
+    break;
+
+  case 32: /* label: KEYCASE STR COLON  */
+#line 163 "src/gram.y"
+                                {DefineCase(parser, T_STRING, (yyvsp[-1].lexval).id);}
+#line 1587 "y.tab.cpp"
+    break;
+
+  case 33: /* label: KEYDEFAULT COLON  */
+#line 165 "src/gram.y"
+                                {DefineDefault(parser);}
+#line 1593 "y.tab.cpp"
+    break;
+
+  case 34: /* switchpre: KEYSWITCH LPARA expression RPARA  */
+#line 168 "src/gram.y"
+                                {BeginSwitch(parser, &(yyval.eval), &(yyvsp[-1].eval));}
+#line 1599 "y.tab.cpp"
+    break;
+
+  case 35: /* dopre: KEYDO  */
+#line 171 "src/gram.y"
+                                {BeginDo(parser);}
+#line 1605 "y.tab.cpp"
+    break;
+
+  case 36: /* forinitpre: KEYFOR LPARA expression SEMICOLON  */
+#line 174 "src/gram.y"
+                                {ForInit(&(yyval.ival), &(yyvsp[-1].eval));}
+#line 1611 "y.tab.cpp"
+    break;
+
+  case 37: /* forconpre: expression SEMICOLON  */
+#line 177 "src/gram.y"
+                                {ForCondition(parser, &(yyval.eval), &(yyvsp[-1].eval));}
+#line 1617 "y.tab.cpp"
+    break;
+
+  case 38: /* foractpre: expression RPARA  */
+#line 180 "src/gram.y"
+                                {ForAction(parser, &(yyval.ival), &(yyvsp[-1].eval));}
+#line 1623 "y.tab.cpp"
+    break;
+
+  case 39: /* whilepre: KEYWHILE LPARA expression RPARA  */
+#line 183 "src/gram.y"
+                                {BeginWhile(parser, &(yyval.ival), &(yyvsp[-1].eval));}
+#line 1629 "y.tab.cpp"
+    break;
+
+  case 40: /* ifpre: KEYIF LPARA expression RPARA  */
+#line 186 "src/gram.y"
+                                {BeginIf(parser, &(yyval.ival), &(yyvsp[-1].eval));}
+#line 1635 "y.tab.cpp"
+    break;
+
+  case 41: /* elsepre: ifpre statement KEYELSE  */
+#line 189 "src/gram.y"
+                                {BeginElse(&(yyval.ival), &(yyvsp[-2].ival), &(yyvsp[-1].ival));}
+#line 1641 "y.tab.cpp"
+    break;
+
+  case 42: /* expression: lresult SETOPS expression  */
+#line 192 "src/gram.y"
+                                {Assign(parser, &(yyval.eval), &(yyvsp[-2].vval), (yyvsp[-1].lexval).id, &(yyvsp[0].eval));}
+#line 1647 "y.tab.cpp"
+    break;
+
+  case 43: /* expression: selectpre colonpre expression  */
+#line 194 "src/gram.y"
+                                {EndSelect(parser, &(yyval.eval), &(yyvsp[-2].eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1653 "y.tab.cpp"
+    break;
+
+  case 45: /* selectpre: expression SELECT  */
+#line 198 "src/gram.y"
+                                {BeginSelect(parser, &(yyval.eval), &(yyvsp[-1].eval));}
+#line 1659 "y.tab.cpp"
+    break;
+
+  case 46: /* colonpre: expression COLON  */
+#line 201 "src/gram.y"
+                                {SelectColon(&(yyval.eval), &(yyvsp[-1].eval));}
+#line 1665 "y.tab.cpp"
+    break;
+
+  case 47: /* lresult: IDENT  */
+#line 204 "src/gram.y"
+                                {LValue(parser, &(yyval.vval), (yyvsp[0].lexval).id);}
+#line 1671 "y.tab.cpp"
+    break;
+
+  case 48: /* boolexp: boolorpre compexp  */
+#line 207 "src/gram.y"
+                                {EndBoolOr(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1677 "y.tab.cpp"
+    break;
+
+  case 49: /* boolexp: boolandpre compexp  */
+#line 209 "src/gram.y"
+                                {EndBoolAnd(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1683 "y.tab.cpp"
+    break;
+
+  case 51: /* boolorpre: boolexp BOOLOR  */
+#line 213 "src/gram.y"
+                                {BoolOperand(parser, &(yyval.eval), &(yyvsp[-1].eval));}
+#line 1689 "y.tab.cpp"
+    break;
+
+  case 52: /* boolandpre: boolexp BOOLAND  */
+#line 216 "src/gram.y"
+                                {BoolOperand(parser, &(yyval.eval), &(yyvsp[-1].eval));}
+#line 1695 "y.tab.cpp"
+    break;
+
+  case 53: /* compexp: boolpre bitexp  */
+#line 219 "src/gram.y"
+                                {EndCompare(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1701 "y.tab.cpp"
+    break;
+
+  case 55: /* bitexp: bitpre shiftexp  */
+#line 223 "src/gram.y"
+                                {EndIntOp(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1707 "y.tab.cpp"
+    break;
+
+  case 57: /* shiftexp: shiftpre addexp  */
+#line 227 "src/gram.y"
+                                {EndIntOp(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1713 "y.tab.cpp"
+    break;
+
+  case 59: /* addexp: addpre mulexp  */
+#line 231 "src/gram.y"
+                                {EndArith(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1719 "y.tab.cpp"
+    break;
+
+  case 61: /* mulexp: mulpre factor  */
+#line 235 "src/gram.y"
+                                {EndArith(parser, &(yyval.eval), &(yyvsp[-1].eval), &(yyvsp[0].eval));}
+#line 1725 "y.tab.cpp"
+    break;
+
+  case 63: /* mulexp: ADDOPS factor  */
+#line 238 "src/gram.y"
+                                {Negate(parser, &(yyval.eval), (yyvsp[-1].lexval).id, &(yyvsp[0].eval));}
+#line 1731 "y.tab.cpp"
+    break;
+
+  case 64: /* mulexp: BOOLNOT factor  */
+#line 240 "src/gram.y"
+                                {LogicalNot(parser, &(yyval.eval), &(yyvsp[0].eval));}
+#line 1737 "y.tab.cpp"
+    break;
+
+  case 65: /* mulexp: BITNOT factor  */
+#line 242 "src/gram.y"
+                                {BitwiseNot(parser, &(yyval.eval), (yyvsp[-1].lexval).id, &(yyvsp[0].eval));}
+#line 1743 "y.tab.cpp"
+    break;
+
+  case 66: /* boolpre: compexp BOOLOPS  */
+#line 245 "src/gram.y"
+                                {Operand(&(yyval.eval), &(yyvsp[-1].eval), (yyvsp[0].lexval).id);}
+#line 1749 "y.tab.cpp"
+    break;
+
+  case 67: /* bitpre: bitexp BITOPS  */
+#line 248 "src/gram.y"
+                                {IntOperand(parser, &(yyval.eval), &(yyvsp[-1].eval), (yyvsp[0].lexval).id);}
+#line 1755 "y.tab.cpp"
+    break;
+
+  case 68: /* shiftpre: shiftexp SHIFTOPS  */
+#line 251 "src/gram.y"
+                                {IntOperand(parser, &(yyval.eval), &(yyvsp[-1].eval), (yyvsp[0].lexval).id);}
+#line 1761 "y.tab.cpp"
+    break;
+
+  case 69: /* addpre: addexp ADDOPS  */
+#line 254 "src/gram.y"
+                                {Operand(&(yyval.eval), &(yyvsp[-1].eval), (yyvsp[0].lexval).id);}
+#line 1767 "y.tab.cpp"
+    break;
+
+  case 70: /* mulpre: mulexp MULOPS  */
+#line 257 "src/gram.y"
+                                {Operand(&(yyval.eval), &(yyvsp[-1].eval), (yyvsp[0].lexval).id);}
+#line 1773 "y.tab.cpp"
+    break;
+
+  case 71: /* factor: CNTINT  */
+#line 260 "src/gram.y"
+                                {IntConstant(parser, &(yyval.eval), (yyvsp[0].lexval).id);}
+#line 1779 "y.tab.cpp"
+    break;
+
+  case 72: /* factor: FLT  */
+#line 262 "src/gram.y"
+                                {FloatConstant(parser, &(yyval.eval), (yyvsp[0].lexval).id);}
+#line 1785 "y.tab.cpp"
+    break;
+
+  case 73: /* factor: STR  */
+#line 264 "src/gram.y"
+                                {StringConstant(parser, &(yyval.eval), (yyvsp[0].lexval).id);}
+#line 1791 "y.tab.cpp"
+    break;
+
+  case 74: /* factor: INCOPS lresult  */
+#line 266 "src/gram.y"
+                                {PreIncDec(parser, &(yyval.eval), (yyvsp[-1].lexval).id, &(yyvsp[0].vval));}
+#line 1797 "y.tab.cpp"
+    break;
+
+  case 75: /* factor: DECOPS lresult  */
+#line 268 "src/gram.y"
+                                {PreIncDec(parser, &(yyval.eval), (yyvsp[-1].lexval).id, &(yyvsp[0].vval));}
+#line 1803 "y.tab.cpp"
+    break;
+
+  case 76: /* factor: lresult INCOPS  */
+#line 270 "src/gram.y"
+                                {PostIncDec(parser, &(yyval.eval), &(yyvsp[-1].vval), (yyvsp[0].lexval).id);}
+#line 1809 "y.tab.cpp"
+    break;
+
+  case 77: /* factor: lresult DECOPS  */
+#line 272 "src/gram.y"
+                                {PostIncDec(parser, &(yyval.eval), &(yyvsp[-1].vval), (yyvsp[0].lexval).id);}
+#line 1815 "y.tab.cpp"
+    break;
+
+  case 78: /* factor: IDENT  */
+#line 274 "src/gram.y"
+                                {VarFactor(parser, &(yyval.eval), (yyvsp[0].lexval).id);}
+#line 1821 "y.tab.cpp"
+    break;
+
+  case 80: /* factor: LPARA expression RPARA  */
+#line 277 "src/gram.y"
+                                {(yyval.eval)=(yyvsp[-1].eval);}
+#line 1827 "y.tab.cpp"
+    break;
+
+  case 81: /* function: IDENT LPARA parameter RPARA  */
+#line 280 "src/gram.y"
+                                {CallFunction(parser, &(yyval.eval), (yyvsp[-3].lexval).id, &(yyvsp[-1].pval));}
+#line 1833 "y.tab.cpp"
+    break;
+
+  case 83: /* parameter: %empty  */
+#line 283 "src/gram.y"
+                                {NoParameter(&(yyval.pval));}
+#line 1839 "y.tab.cpp"
+    break;
+
+  case 84: /* paralist: paralist COMMA expression  */
+#line 286 "src/gram.y"
+                                {PushParameter(&(yyval.pval), &(yyvsp[-2].pval), &(yyvsp[0].eval));}
+#line 1845 "y.tab.cpp"
+    break;
+
+  case 85: /* paralist: expression  */
+#line 288 "src/gram.y"
+                                {PushParameter(&(yyval.pval), NULL, &(yyvsp[0].eval));}
+#line 1851 "y.tab.cpp"
+    break;
+
+
+#line 1855 "y.tab.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (parser, YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, parser);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, parser);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (parser, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, parser);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, parser);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 290 "src/gram.y"
+
+
+int YaccParse(MYLParser *parser)
+{
+	return yyparse(parser);
+}
+
+static int yylex(MYLParser *parser)
+{
+	int token = NextToken(parser, &yylval.lexval);
+
+	/* The %token list above is in the order of the TK_ tokens */
+	return token==TK_EOF ? 0 : token-TK_CNTINT+CNTINT;
+}
+
+static void yyerror(MYLParser *parser, const char *s)
+{
+	CompileError(parser, s);
+}
+